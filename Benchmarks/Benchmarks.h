@@ -0,0 +1,21 @@
+#ifndef _BENCHMARKS_H_
+#define _BENCHMARKS_H_
+
+// Each benchmark mode reads its own arguments (argv[0] is the mode 
+// name) and prints one JSON object per line to stdout, so runs can 
+// be diffed/tracked by scripts. Returns the process exit code.
+
+// acceleration structures: build time, memory (bytes/primitive), 
+// closest hit & occlusion rays/sec and cache misses
+int runAccelBenchmark(int argc, char* argv[]);
+
+// whole renderer: wall time, primary/secondary/shadow rays per sec 
+// and thread scaling for each acceleration structure & thread count
+int runRenderBenchmark(int argc, char* argv[]);
+
+// reads two files of render benchmark output (e.g. a plain and a 
+// PGO build) and prints the speedup of each common run plus the 
+// geometric mean
+int runCompareBenchmark(int argc, char* argv[]);
+
+#endif
\ No newline at end of file
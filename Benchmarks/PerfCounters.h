@@ -0,0 +1,81 @@
+#ifndef _PERF_COUNTERS_H_
+#define _PERF_COUNTERS_H_
+
+// Hardware cache miss counters for the benchmarks (Linux perf 
+// events). "L2 misses" are last level cache references, i.e. 
+// requests that missed the private caches, "L3 misses" are last 
+// level cache misses. Elsewhere, or when the kernel doesn't allow 
+// it (perf_event_paranoid), the counts read as -1.
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <string.h>
+#endif
+
+class PerfCounters {
+private:
+	int fd[2];
+
+#ifdef __linux__
+	static int openCounter(unsigned long long config) {
+		perf_event_attr attr;
+		memset(&attr, 0, sizeof(attr));
+		attr.type = PERF_TYPE_HARDWARE;
+		attr.size = sizeof(attr);
+		attr.config = config;
+		attr.disabled = 1;
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		return (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+	}
+#endif
+
+public:
+	long long l2Misses;
+	long long l3Misses;
+
+	PerfCounters() : l2Misses(-1), l3Misses(-1) {
+		fd[0] = fd[1] = -1;
+#ifdef __linux__
+		fd[0] = openCounter(PERF_COUNT_HW_CACHE_REFERENCES);
+		fd[1] = openCounter(PERF_COUNT_HW_CACHE_MISSES);
+#endif
+	}
+
+	~PerfCounters() {
+#ifdef __linux__
+		for (int i = 0; i < 2; ++i) {
+			if (fd[i] >= 0) close(fd[i]);
+		}
+#endif
+	}
+
+	void start() {
+#ifdef __linux__
+		for (int i = 0; i < 2; ++i) {
+			if (fd[i] < 0) continue;
+			ioctl(fd[i], PERF_EVENT_IOC_RESET, 0);
+			ioctl(fd[i], PERF_EVENT_IOC_ENABLE, 0);
+		}
+#endif
+	}
+
+	void stop() {
+#ifdef __linux__
+		long long values[2] = { -1, -1 };
+		for (int i = 0; i < 2; ++i) {
+			if (fd[i] < 0) continue;
+			ioctl(fd[i], PERF_EVENT_IOC_DISABLE, 0);
+			if (read(fd[i], &values[i], sizeof(long long)) != sizeof(long long)) {
+				values[i] = -1;
+			}
+		}
+		l2Misses = values[0];
+		l3Misses = values[1];
+#endif
+	}
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,125 @@
+#include "SceneGenerator.h"
+#include "../Shapes_and_globals/Scene.h"
+#include <random>
+
+GeneratedScene::GeneratedScene(int numObjects, unsigned int seed,
+	sceneLayout layout) :
+	floorPlane(glm::vec3(.0f, 1.0f, .0f), glm::vec3(.0f, -1.0f, .0f),
+		floor_white, DIFFUSE),
+	areaLight(glm::vec3(.1f, 1.9f, -2.0f), whiteLight, AREA_LIGHT,
+		glm::vec3(.1f, 1.9f, -2.0f), glm::vec3(-.5f, .0f, .0f), 
+		glm::vec3(.0f, .0f, -.5f)) {
+
+	name = std::string("generated_") + layoutName(layout) + "_" + 
+		std::to_string(numObjects);
+	std::mt19937 rng(seed);
+	std::uniform_real_distribution<float> unit(.0f, 1.0f);
+
+	// keep the density roughly constant: the volume in front of 
+	// the camera grows with the object count
+	float extent = 2.0f * cbrtf((float)numObjects);
+	// the room & arc layouts only grow sideways and back
+	float spread = 2.0f * sqrtf((float)numObjects / 8.0f) + 1.0f;
+	int numSpheres = numObjects / 2;
+	int numBoxes = numObjects / 4;
+	int numRects = numObjects - numSpheres - numBoxes;
+	spheres.reserve(numSpheres);
+	boxes.reserve(numBoxes);
+	rects.reserve(numRects);
+
+	materialType materials[] = { DIFFUSE_AND_GLOSSY, REFLECTION,
+		REFLECTION_AND_REFRACTION, DIFFUSE };
+	for (int i = 0; i < numObjects; ++i) {
+		glm::vec3 pos;
+		float size;
+		Color col;
+		materialType mat = materials[i % 4];
+		float ior = 1.5f;
+		float boxIor = 1.2f;
+		switch (layout) {
+		case ROOM_LAYOUT: {
+			pos = glm::vec3(
+				(unit(rng) - .5f) * spread,
+				-1.0f + unit(rng) * 2.6f,
+				-1.5f - unit(rng) * spread);
+			size = .03f + .1f * unit(rng);
+			col = Color(unit(rng), unit(rng), unit(rng), .0f);
+			break;
+		}
+		case ARC_LAYOUT: {
+			// uniform over a 120 degree sector of the floor
+			float angle = (unit(rng) - .5f) * 2.0944f;
+			float dist = 1.5f + sqrtf(unit(rng)) * spread;
+			size = .1f + .2f * unit(rng);
+			pos = glm::vec3(sinf(angle) * dist, -1.0f + size, 
+				-cosf(angle) * dist);
+			// scene 4's alternating mirror & glass spheres
+			mat = (i % 2 == 0) ? REFLECTION : REFLECTION_AND_REFRACTION;
+			col = (i % 2 == 0) ? pastel_blue : white;
+			ior = boxIor = (i % 2 == 0) ? 3.6f : 1.025f;
+			break;
+		}
+		case SCATTER_LAYOUT:
+		default: {
+			pos = glm::vec3(
+				(unit(rng) - .5f) * extent, 
+				-1.0f + unit(rng) * extent * .5f, 
+				-1.5f - unit(rng) * extent);
+			size = .05f + .2f * unit(rng);
+			col = Color(unit(rng), unit(rng), unit(rng), .0f);
+			break;
+		}
+		}
+
+		if (i % 4 < 2 && spheres.size() < numSpheres) {
+			spheres.push_back(Sphere(pos, size, col, ior, mat));
+		}
+		else if (boxes.size() < numBoxes) {
+			boxes.push_back(Box(pos, size * 2.0f, col, boxIor, mat));
+		}
+		else {
+			glm::vec3 edgeA(size * 2.0f, .0f, .0f);
+			glm::vec3 edgeB(.0f, size * 2.0f * (unit(rng) - .5f), -size * 2.0f);
+			rects.push_back(Rect(pos, edgeA, edgeB, col, 
+				layout == ARC_LAYOUT ? REFLECTION : DIFFUSE));
+		}
+	}
+
+	if (layout == ROOM_LAYOUT) {
+		// scene 1's walls, pushed out to fit the objects
+		float halfWidth = spread * .5f + .5f;
+		walls.push_back(Plane(glm::vec3(.0f, -1.0f, .0f),
+			glm::vec3(.0f, 2.1f, .0f), grey, DIFFUSE));
+		walls.push_back(Plane(glm::vec3(1.0f, .0f, .0f),
+			glm::vec3(-halfWidth, .0f, .0f), red, DIFFUSE));
+		walls.push_back(Plane(glm::vec3(-1.0f, .0f, .0f),
+			glm::vec3(halfWidth, .0f, .0f), blue, DIFFUSE));
+		walls.push_back(Plane(glm::vec3(.0f, .0f, 1.0f),
+			glm::vec3(.0f, .0f, -2.0f - spread), grey, DIFFUSE));
+		walls.push_back(Plane(glm::vec3(.0f, .0f, -1.0f),
+			glm::vec3(.0f, .0f, .5f), grey, DIFFUSE));
+	}
+
+	for (int i = 0; i < spheres.size(); ++i) objects.push_back(&spheres[i]);
+	for (int i = 0; i < boxes.size(); ++i) objects.push_back(&boxes[i]);
+	for (int i = 0; i < rects.size(); ++i) objects.push_back(&rects[i]);
+	objects.push_back(&floorPlane);
+	for (int i = 0; i < walls.size(); ++i) objects.push_back(&walls[i]);
+	lights.push_back(&areaLight);
+}
+
+const char* GeneratedScene::layoutName(sceneLayout layout) {
+	switch (layout) {
+	case SCATTER_LAYOUT: return "scatter";
+	case ROOM_LAYOUT: return "room";
+	case ARC_LAYOUT: return "arc";
+	default: return "unknown";
+	}
+}
+
+sceneLayout GeneratedScene::layoutFromName(const std::string& name) {
+	for (int i = 0; i < NUM_LAYOUTS; ++i) {
+		if (name == layoutName((sceneLayout)i)) return (sceneLayout)i;
+	}
+	return NUM_LAYOUTS;
+}
\ No newline at end of file
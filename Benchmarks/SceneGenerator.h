@@ -0,0 +1,55 @@
+#ifndef _SCENE_GENERATOR_H_
+#define _SCENE_GENERATOR_H_
+
+#include <vector>
+#include <string>
+#include "../Shapes_and_globals/Sphere.h"
+#include "../Shapes_and_globals/Box.h"
+#include "../Shapes_and_globals/Rect.h"
+#include "../Shapes_and_globals/Plane.h"
+#include "../Lights_Color/Light.h"
+
+// how the generated objects are laid out, modelled on selectScene()
+// SCATTER_LAYOUT -- mixed materials spread through a volume in front 
+//                   of the camera (scenes 1 & 2)
+// ROOM_LAYOUT -- packed inside a walled room (scene 1's six planes)
+// ARC_LAYOUT -- mirror & glass objects resting on the floor in an arc 
+//               fanning away from the camera (scene 4), lots of 
+//               secondary rays
+enum sceneLayout { SCATTER_LAYOUT, ROOM_LAYOUT, ARC_LAYOUT, NUM_LAYOUTS };
+
+// Procedurally scaled scene for the benchmarks: numObjects spheres, 
+// boxes and rects (roughly 2:1:1) placed in front of the default 
+// camera above a checkered floor, lit by one area light like the 
+// built-in scenes. The same seed always gives the same scene.
+class GeneratedScene {
+private:
+	std::vector<Sphere> spheres;
+	std::vector<Box> boxes;
+	std::vector<Rect> rects;
+	Plane floorPlane;
+	std::vector<Plane> walls;
+	Light areaLight;
+
+public:
+	GeneratedScene(int numObjects, unsigned int seed, 
+		sceneLayout layout = SCATTER_LAYOUT);
+
+	// "scatter", "room", "arc"
+	static const char* layoutName(sceneLayout layout);
+	// NUM_LAYOUTS if the name isn't known
+	static sceneLayout layoutFromName(const std::string& name);
+
+	// owns the objects, so it can't be copied around
+	GeneratedScene(const GeneratedScene&) = delete;
+	GeneratedScene& operator=(const GeneratedScene&) = delete;
+
+	// name used in the benchmark output, e.g. "generated_scatter_10000"
+	std::string name;
+
+	// bounded objects followed by the floor plane (and walls)
+	std::vector<Object*> objects;
+	std::vector<LightSources*> lights;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,221 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+#include "Benchmarks.h"
+#include "PerfCounters.h"
+#include "SceneGenerator.h"
+#include "../Options.h"
+#include "../Render/Render.h"
+#include "../Grid_Acceleration_Structure/BVH.h"
+#include "../Grid_Acceleration_Structure/Grid.h"
+#include "../Grid_Acceleration_Structure/KdTree.h"
+
+namespace {
+
+struct BenchRay {
+	glm::vec3 orig;
+	glm::vec3 dir;
+};
+
+// one acceleration structure configuration to measure
+struct AccelBackend {
+	const char* name;
+	AccelerationStructure* (*build)(std::vector<Object*>& objects);
+	size_t (*memoryUsage)(const AccelerationStructure* accel);
+};
+
+AccelerationStructure* buildBVH(std::vector<Object*>& objects) {
+	return new BVH(objects, BVH_FLOAT_NODES);
+}
+
+AccelerationStructure* buildQuantizedBVH(std::vector<Object*>& objects) {
+	return new BVH(objects, BVH_QUANTIZED_NODES);
+}
+
+size_t bvhMemory(const AccelerationStructure* accel) {
+	return static_cast<const BVH*>(accel)->getMemoryUsage();
+}
+
+AccelerationStructure* buildKdTree(std::vector<Object*>& objects) {
+	return new KdTree(objects, KDTREE_STACK_TRAVERSAL);
+}
+
+AccelerationStructure* buildRopeKdTree(std::vector<Object*>& objects) {
+	return new KdTree(objects, KDTREE_ROPE_TRAVERSAL);
+}
+
+size_t kdTreeMemory(const AccelerationStructure* accel) {
+	return static_cast<const KdTree*>(accel)->getMemoryUsage();
+}
+
+AccelerationStructure* buildGrid(std::vector<Object*>& objects) {
+	return new Grid(objects);
+}
+
+size_t gridMemory(const AccelerationStructure* accel) {
+	return static_cast<const Grid*>(accel)->getMemoryUsage();
+}
+
+const AccelBackend backends[] = {
+	{ "bvh", buildBVH, bvhMemory },
+	{ "bvh_quantized", buildQuantizedBVH, bvhMemory },
+	{ "kdtree", buildKdTree, kdTreeMemory },
+	{ "kdtree_ropes", buildRopeKdTree, kdTreeMemory },
+	{ "grid", buildGrid, gridMemory },
+};
+
+// jittered primary rays over the whole frame, same as startRender
+std::vector<BenchRay> makeCameraRays(const Options& options, 
+	int count, std::mt19937& rng) {
+
+	std::uniform_real_distribution<float> unit(.0f, 1.0f);
+	Camera cam(options.cameraPos, options.cameraForward, 
+		options.cameraReferUp);
+	std::vector<BenchRay> rays(count);
+	for (int i = 0; i < count; ++i) {
+		float x = unit(rng) * options.width;
+		float y = unit(rng) * options.height;
+		float alpha = ((2 * x / (float)options.width) - 1.0f)
+			* options.aspectRatio * tan(options.fov / 2);
+		float beta = (1 - (2 * y / (float)options.height))
+			* tan(options.fov / 2);
+		rays[i].orig = cam.getCamPos();
+		rays[i].dir = normalize(glm::vec3(alpha, beta, .0f) + 
+			cam.getCamLookAt());
+	}
+	return rays;
+}
+
+// incoherent rays: random directions from the camera position, 
+// stand-in for secondary & shadow rays
+std::vector<BenchRay> makeRandomRays(const Options& options, 
+	int count, std::mt19937& rng) {
+
+	std::normal_distribution<float> gauss(.0f, 1.0f);
+	std::vector<BenchRay> rays(count);
+	for (int i = 0; i < count; ++i) {
+		glm::vec3 dir(gauss(rng), gauss(rng), gauss(rng));
+		rays[i].orig = options.cameraPos;
+		rays[i].dir = normalize(dir);
+	}
+	return rays;
+}
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+	return std::chrono::duration<double>(
+		std::chrono::steady_clock::now() - start).count();
+}
+
+void traceRays(const AccelerationStructure* accel, 
+	const std::vector<BenchRay>& rays, bool occlusion,
+	const std::string& sceneName, int numObjects, 
+	const AccelBackend& backend, double buildSeconds,
+	const char* rayKind) {
+
+	PerfCounters counters;
+	long long hits = 0;
+	int index;
+	glm::vec2 uv;
+	Object* hitObj;
+	counters.start();
+	std::chrono::steady_clock::time_point start = 
+		std::chrono::steady_clock::now();
+	for (int i = 0; i < rays.size(); ++i) {
+		if (occlusion) {
+			hits += accel->occluded(rays[i].orig, rays[i].dir, 10.0f);
+		}
+		else {
+			float tNear = FLT_MAX;
+			hits += accel->findIntersection(rays[i].orig, rays[i].dir,
+				tNear, index, uv, &hitObj);
+		}
+	}
+	double seconds = secondsSince(start);
+	counters.stop();
+
+	size_t bytes = backend.memoryUsage(accel);
+	printf("{\"benchmark\":\"accel\",\"scene\":\"%s\",\"objects\":%d,"
+		"\"accel\":\"%s\",\"rays\":\"%s\",\"query\":\"%s\","
+		"\"buildMs\":%.3f,\"bytes\":%zu,\"bytesPerPrimitive\":%.2f,"
+		"\"numRays\":%zu,\"hits\":%lld,\"raysPerSec\":%.0f,"
+		"\"l2Misses\":%lld,\"l3Misses\":%lld}\n",
+		sceneName.c_str(), numObjects, backend.name, rayKind,
+		occlusion ? "occluded" : "closest",
+		buildSeconds * 1000.0, bytes, 
+		numObjects > 0 ? (double)bytes / numObjects : .0,
+		rays.size(), hits, rays.size() / seconds,
+		counters.l2Misses, counters.l3Misses);
+	fflush(stdout);
+}
+
+void benchmarkScene(const std::string& sceneName, 
+	std::vector<Object*>& objects, const Options& options, int numRays) {
+
+	std::mt19937 rng(1234);
+	std::vector<BenchRay> cameraRays = makeCameraRays(options, numRays, rng);
+	std::vector<BenchRay> randomRays = makeRandomRays(options, numRays, rng);
+
+	for (const AccelBackend& backend : backends) {
+		std::chrono::steady_clock::time_point start = 
+			std::chrono::steady_clock::now();
+		AccelerationStructure* accel = backend.build(objects);
+		double buildSeconds = secondsSince(start);
+
+		traceRays(accel, cameraRays, false, sceneName, (int)objects.size(),
+			backend, buildSeconds, "camera");
+		traceRays(accel, randomRays, false, sceneName, (int)objects.size(),
+			backend, buildSeconds, "random");
+		traceRays(accel, randomRays, true, sceneName, (int)objects.size(),
+			backend, buildSeconds, "random");
+		delete accel;
+	}
+}
+
+}
+
+// usage: accel [--rays N] [--objects N]... [--no-builtin]
+int runAccelBenchmark(int argc, char* argv[]) {
+	int numRays = 1000000;
+	bool builtinScenes = true;
+	std::vector<int> generatedSizes;
+	for (int i = 1; i < argc; ++i) {
+		if (!strcmp(argv[i], "--rays") && i + 1 < argc) {
+			numRays = atoi(argv[++i]);
+		}
+		else if (!strcmp(argv[i], "--objects") && i + 1 < argc) {
+			generatedSizes.push_back(atoi(argv[++i]));
+		}
+		else if (!strcmp(argv[i], "--no-builtin")) {
+			builtinScenes = false;
+		}
+		else {
+			fprintf(stderr, "accel: unknown argument %s\n", argv[i]);
+			return 1;
+		}
+	}
+	if (generatedSizes.empty()) {
+		generatedSizes.push_back(1000);
+		generatedSizes.push_back(100000);
+	}
+
+	Options options;
+	if (builtinScenes) {
+		Render renderer;
+		for (int scene = 1; scene <= 5; ++scene) {
+			std::vector<Object*> objects;
+			std::vector<LightSources*> lights;
+			renderer.selectScene(objects, lights, scene);
+			benchmarkScene("scene" + std::to_string(scene), 
+				objects, options, numRays);
+		}
+	}
+	for (int i = 0; i < generatedSizes.size(); ++i) {
+		GeneratedScene scene(generatedSizes[i], 42);
+		benchmarkScene(scene.name, scene.objects, options, numRays);
+	}
+	return 0;
+}
\ No newline at end of file
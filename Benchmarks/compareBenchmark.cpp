@@ -0,0 +1,116 @@
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <string>
+#include "Benchmarks.h"
+
+namespace {
+
+struct RenderRun {
+	std::string scene, accel, threads;
+	double wallMs;
+	double raysPerSec;
+};
+
+// value of "key": in one of our own JSON lines (no nesting before 
+// the key, no escaped quotes), "" when missing
+std::string jsonField(const std::string& line, const char* key) {
+	std::string pattern = std::string("\"") + key + "\":";
+	size_t start = line.find(pattern);
+	if (start == std::string::npos) return "";
+	start += pattern.size();
+	if (line[start] == '"') {
+		size_t end = line.find('"', start + 1);
+		return line.substr(start + 1, end - start - 1);
+	}
+	size_t end = line.find_first_of(",}", start);
+	return line.substr(start, end - start);
+}
+
+// render benchmark runs keyed by scene/accel/threads, repeated runs 
+// keep the fastest
+bool readRenderRuns(const char* fileName, 
+	std::map<std::string, RenderRun>& runs) {
+
+	std::ifstream file(fileName);
+	if (!file) return false;
+	std::string line;
+	while (std::getline(file, line)) {
+		if (jsonField(line, "benchmark") != "render") continue;
+		RenderRun run = { jsonField(line, "scene"), 
+			jsonField(line, "accel"), jsonField(line, "threads"),
+			atof(jsonField(line, "wallMs").c_str()),
+			atof(jsonField(line, "raysPerSec").c_str()) };
+		std::string key = run.scene + "/" + run.accel + "/" + run.threads;
+		std::map<std::string, RenderRun>::iterator found = runs.find(key);
+		if (found == runs.end() || run.wallMs < found->second.wallMs) {
+			runs[key] = run;
+		}
+	}
+	return true;
+}
+
+}
+
+// usage: compare <baseline.jsonl> <candidate.jsonl> [--label NAME]
+int runCompareBenchmark(int argc, char* argv[]) {
+	if (argc < 3) {
+		fprintf(stderr, "usage: compare <baseline.jsonl> "
+			"<candidate.jsonl> [--label NAME]\n");
+		return 1;
+	}
+	std::string label = "candidate";
+	for (int i = 3; i < argc; ++i) {
+		if (!strcmp(argv[i], "--label") && i + 1 < argc) {
+			label = argv[++i];
+		}
+		else {
+			fprintf(stderr, "compare: unknown argument %s\n", argv[i]);
+			return 1;
+		}
+	}
+
+	std::map<std::string, RenderRun> baseline, candidate;
+	if (!readRenderRuns(argv[1], baseline)) {
+		fprintf(stderr, "compare: can't read %s\n", argv[1]);
+		return 1;
+	}
+	if (!readRenderRuns(argv[2], candidate)) {
+		fprintf(stderr, "compare: can't read %s\n", argv[2]);
+		return 1;
+	}
+
+	// speedups are ratios, so they're averaged geometrically
+	double logGainSum = .0;
+	int matched = 0;
+	for (std::map<std::string, RenderRun>::iterator it = baseline.begin();
+		it != baseline.end(); ++it) {
+		std::map<std::string, RenderRun>::iterator other = 
+			candidate.find(it->first);
+		if (other == candidate.end() || other->second.wallMs <= .0) {
+			continue;
+		}
+		double gain = it->second.wallMs / other->second.wallMs;
+		logGainSum += log(gain);
+		++matched;
+		printf("{\"benchmark\":\"compare\",\"label\":\"%s\","
+			"\"scene\":\"%s\",\"accel\":\"%s\",\"threads\":%s,"
+			"\"baselineMs\":%.3f,\"candidateMs\":%.3f,"
+			"\"baselineRaysPerSec\":%.0f,\"candidateRaysPerSec\":%.0f,"
+			"\"gain\":%.3f}\n", label.c_str(), it->second.scene.c_str(), 
+			it->second.accel.c_str(), it->second.threads.c_str(),
+			it->second.wallMs, other->second.wallMs, 
+			it->second.raysPerSec, other->second.raysPerSec, gain);
+	}
+	if (matched == 0) {
+		fprintf(stderr, "compare: no runs in common\n");
+		return 1;
+	}
+	printf("{\"benchmark\":\"compare\",\"label\":\"%s\",\"runs\":%d,"
+		"\"geomeanGain\":%.3f}\n", label.c_str(), matched, 
+		exp(logGainSum / matched));
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,23 @@
+#include <iostream>
+#include <string>
+#include "Benchmarks.h"
+
+// usage: Benchmarks <mode> [mode arguments]
+int main(int argc, char* argv[]) {
+	if (argc < 2) {
+		std::cerr << "usage: " << argv[0] << " accel|render|compare [options]" << std::endl;
+		return 1;
+	}
+	std::string mode = argv[1];
+	if (mode == "accel") {
+		return runAccelBenchmark(argc - 1, argv + 1);
+	}
+	if (mode == "render") {
+		return runRenderBenchmark(argc - 1, argv + 1);
+	}
+	if (mode == "compare") {
+		return runCompareBenchmark(argc - 1, argv + 1);
+	}
+	std::cerr << "unknown benchmark mode: " << mode << std::endl;
+	return 1;
+}
\ No newline at end of file
@@ -0,0 +1,205 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Benchmarks.h"
+#include "SceneGenerator.h"
+#include "../Options.h"
+#include "../Render/Render.h"
+
+namespace {
+
+struct RenderBackend {
+	const char* name;
+	accelType type;
+};
+
+// "none" tests every object per ray, only sensible for small scenes 
+// so it has to be asked for
+const RenderBackend renderBackends[] = {
+	{ "none", NO_ACCEL },
+	{ "bvh", BVH_ACCEL },
+	{ "kdtree", KDTREE_ACCEL },
+	{ "grid", GRID_ACCEL },
+};
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+	return std::chrono::duration<double>(
+		std::chrono::steady_clock::now() - start).count();
+}
+
+void renderScene(const std::string& sceneName, 
+	std::vector<Object*>& objects, std::vector<LightSources*>& lights,
+	const Options& baseOptions, 
+	const std::vector<const RenderBackend*>& backends, 
+	const std::vector<int>& threadCounts) {
+
+	Camera cam(baseOptions.cameraPos, baseOptions.cameraForward, 
+		baseOptions.cameraReferUp);
+	std::vector<Color> colorBuffer(baseOptions.width * baseOptions.height);
+
+	for (int b = 0; b < backends.size(); ++b) {
+		Render renderer;
+		std::chrono::steady_clock::time_point start = 
+			std::chrono::steady_clock::now();
+		renderer.buildAccelStructure(objects, backends[b]->type);
+		double buildSeconds = secondsSince(start);
+
+		// scaling is measured against the first (smallest) thread count
+		double baseSeconds = .0;
+		int baseThreads = 0;
+		for (int t = 0; t < threadCounts.size(); ++t) {
+			Options options = baseOptions;
+			options.accelStructure = backends[b]->type;
+			options.numThreads = threadCounts[t];
+
+			start = std::chrono::steady_clock::now();
+			renderer.renderImage(lights, objects, colorBuffer.data(), 
+				cam, options);
+			double seconds = secondsSince(start);
+			if (t == 0) {
+				baseSeconds = seconds;
+				baseThreads = threadCounts[t];
+			}
+			double speedup = baseSeconds / seconds;
+			double efficiency = (baseSeconds * baseThreads) / 
+				(seconds * threadCounts[t]);
+
+			const RenderStats& stats = renderer.stats;
+			long long secondary = stats.reflectionRays + stats.refractionRays;
+			printf("{\"benchmark\":\"render\",\"scene\":\"%s\","
+				"\"objects\":%zu,\"accel\":\"%s\",\"threads\":%d,"
+				"\"width\":%d,\"height\":%d,\"samplesPerPixel\":%d,"
+				"\"buildMs\":%.3f,\"wallMs\":%.3f,"
+				"\"primaryRays\":%lld,\"secondaryRays\":%lld,"
+				"\"shadowRays\":%lld,\"raysPerSec\":%.0f,"
+				"\"primaryRaysPerSec\":%.0f,\"secondaryRaysPerSec\":%.0f,"
+				"\"shadowRaysPerSec\":%.0f,\"speedup\":%.3f,"
+				"\"scalingEfficiency\":%.3f,\"stats\":%s}\n",
+				sceneName.c_str(), objects.size(), backends[b]->name,
+				threadCounts[t], options.width, options.height,
+				(int)(options.sampleNum * options.sampleNum),
+				buildSeconds * 1000.0, seconds * 1000.0,
+				stats.cameraRays, secondary, stats.shadowRays,
+				stats.totalRays() / seconds, stats.cameraRays / seconds,
+				secondary / seconds, stats.shadowRays / seconds,
+				speedup, efficiency, stats.toJSON().c_str());
+			fflush(stdout);
+		}
+	}
+}
+
+}
+
+// usage: render [--objects N]... [--layout scatter|room|arc]... 
+//   [--accel none|bvh|kdtree|grid]... [--threads N]... 
+//   [--width W] [--height H] [--samples N] [--builtin]
+int runRenderBenchmark(int argc, char* argv[]) {
+	std::vector<int> generatedSizes;
+	std::vector<sceneLayout> layouts;
+	std::vector<const RenderBackend*> backends;
+	std::vector<int> threadCounts;
+	bool builtinScenes = false;
+	Options options;
+	// small frame so the larger scenes finish in reasonable time
+	options.width = 320;
+	options.height = 180;
+	options.sampleNum = 2;
+	// progress lines would get mixed into the JSON output
+	options.progressInterval = .0f;
+
+	for (int i = 1; i < argc; ++i) {
+		if (!strcmp(argv[i], "--objects") && i + 1 < argc) {
+			generatedSizes.push_back(atoi(argv[++i]));
+		}
+		else if (!strcmp(argv[i], "--layout") && i + 1 < argc) {
+			sceneLayout layout = GeneratedScene::layoutFromName(argv[++i]);
+			if (layout == NUM_LAYOUTS) {
+				fprintf(stderr, "render: unknown layout %s\n", argv[i]);
+				return 1;
+			}
+			layouts.push_back(layout);
+		}
+		else if (!strcmp(argv[i], "--accel") && i + 1 < argc) {
+			const RenderBackend* found = nullptr;
+			++i;
+			for (const RenderBackend& backend : renderBackends) {
+				if (!strcmp(argv[i], backend.name)) found = &backend;
+			}
+			if (found == nullptr) {
+				fprintf(stderr, "render: unknown accel %s\n", argv[i]);
+				return 1;
+			}
+			backends.push_back(found);
+		}
+		else if (!strcmp(argv[i], "--threads") && i + 1 < argc) {
+			threadCounts.push_back(max(1, atoi(argv[++i])));
+		}
+		else if (!strcmp(argv[i], "--width") && i + 1 < argc) {
+			options.width = atoi(argv[++i]);
+		}
+		else if (!strcmp(argv[i], "--height") && i + 1 < argc) {
+			options.height = atoi(argv[++i]);
+		}
+		else if (!strcmp(argv[i], "--samples") && i + 1 < argc) {
+			// camera rays per pixel is samples^2, as in Options
+			options.sampleNum = atoi(argv[++i]);
+		}
+		else if (!strcmp(argv[i], "--builtin")) {
+			builtinScenes = true;
+		}
+		else {
+			fprintf(stderr, "render: unknown argument %s\n", argv[i]);
+			return 1;
+		}
+	}
+	options.aspectRatio = (float)options.width / (float)options.height;
+
+	if (generatedSizes.empty() && !builtinScenes) {
+		generatedSizes.push_back(10);
+		generatedSizes.push_back(1000);
+		generatedSizes.push_back(100000);
+	}
+	if (layouts.empty()) {
+		for (int i = 0; i < NUM_LAYOUTS; ++i) {
+			layouts.push_back((sceneLayout)i);
+		}
+	}
+	if (backends.empty()) {
+		for (const RenderBackend& backend : renderBackends) {
+			if (backend.type != NO_ACCEL) backends.push_back(&backend);
+		}
+	}
+	if (threadCounts.empty()) {
+		// 1, 2, 4, ... up to every hardware thread
+		int hardwareThreads = max(1, (int)std::thread::hardware_concurrency());
+		for (int n = 1; n < hardwareThreads; n *= 2) {
+			threadCounts.push_back(n);
+		}
+		threadCounts.push_back(hardwareThreads);
+	}
+	std::sort(threadCounts.begin(), threadCounts.end());
+
+	if (builtinScenes) {
+		Render sceneSelect;
+		for (int scene = 1; scene <= 5; ++scene) {
+			std::vector<Object*> objects;
+			std::vector<LightSources*> lights;
+			sceneSelect.selectScene(objects, lights, scene);
+			renderScene("scene" + std::to_string(scene), objects, lights,
+				options, backends, threadCounts);
+		}
+	}
+	for (int l = 0; l < layouts.size(); ++l) {
+		for (int i = 0; i < generatedSizes.size(); ++i) {
+			GeneratedScene scene(generatedSizes[i], 42, layouts[l]);
+			renderScene(scene.name, scene.objects, scene.lights,
+				options, backends, threadCounts);
+		}
+	}
+	return 0;
+}
\ No newline at end of file
@@ -1,3 +1,5 @@
+#define _USE_MATH_DEFINES
+#include <math.h>
 #include "Camera.h"
 
 Camera::Camera() {
@@ -6,6 +8,8 @@ Camera::Camera() {
 	this->up = glm::vec3(.0f, 1.0f, .0f);
 	// cross prod. use RHR
 	this->right = normalize(cross(lookAt, this->up)); 
+	this->screenX = glm::vec3(1.0f, .0f, .0f);
+	this->screenY = glm::vec3(.0f, 1.0f, .0f);
 }
 
 Camera::Camera(glm::vec3 position, glm::vec3 target, glm::vec3 referUp) {
@@ -13,6 +17,38 @@ Camera::Camera(glm::vec3 position, glm::vec3 target, glm::vec3 referUp) {
 	this->lookAt = normalize(target - this->pos);
 	this->right = normalize(cross(lookAt, referUp));
 	this->up = normalize(cross(this->right, lookAt));
+	this->screenX = glm::vec3(1.0f, .0f, .0f);
+	this->screenY = glm::vec3(.0f, 1.0f, .0f);
+}
+
+Camera::Camera(glm::vec3 position, glm::vec3 target, glm::vec3 referUp,
+	glm::vec3 screenX, glm::vec3 screenY) : Camera(position, target, referUp) {
+	this->screenX = screenX;
+	this->screenY = screenY;
+}
+
+// v turned by angle radians about the y axis
+static glm::vec3 rotateY(glm::vec3 v, float angle) {
+	float c = cos(angle);
+	float s = sin(angle);
+	return glm::vec3(v.x * c + v.z * s, v.y, -v.x * s + v.z * c);
+}
+
+std::vector<Camera> Camera::turntable(glm::vec3 position, glm::vec3 target,
+	glm::vec3 referUp, glm::vec3 center, int views) {
+
+	std::vector<Camera> cameras;
+	cameras.push_back(Camera(position, target, referUp));
+	for (int i = 1; i < views; ++i) {
+		float angle = 2.0f * (float)M_PI * i / views;
+		cameras.push_back(Camera(
+			center + rotateY(position - center, angle),
+			center + rotateY(target - center, angle),
+			rotateY(referUp, angle),
+			rotateY(glm::vec3(1.0f, .0f, .0f), angle),
+			glm::vec3(.0f, 1.0f, .0f)));
+	}
+	return cameras;
 }
 
 glm::vec3 Camera::getCamPos() {
@@ -30,3 +66,12 @@ glm::vec3 Camera::getCamUp() {
 glm::vec3 Camera::getCamRight() {
 	return this->right;
 }
+
+
+glm::vec3 Camera::getScreenX() {
+	return this->screenX;
+}
+
+glm::vec3 Camera::getScreenY() {
+	return this->screenY;
+}
\ No newline at end of file
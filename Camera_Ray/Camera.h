@@ -1,6 +1,7 @@
 #ifndef _CAMERA_H
 #define _CAMERA_H
 
+#include <vector>
 #include "Ray.h"
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
@@ -15,10 +16,25 @@ public:
 	glm::vec3 getCamUp();
 	glm::vec3 getCamRight();
 
+	// axes of the image plane. Rays go through 
+	// alpha * screenX + beta * screenY + lookAt, the renderer has 
+	// always kept them on world x & y (the view only tilts through 
+	// lookAt), turntable views turn them with the camera
+	glm::vec3 getScreenX();
+	glm::vec3 getScreenY();
+
 	Camera();
 	Camera(glm::vec3 pos, glm::vec3 target, glm::vec3 referUp);
+	Camera(glm::vec3 pos, glm::vec3 target, glm::vec3 referUp,
+		glm::vec3 screenX, glm::vec3 screenY);
+
+	// "views" cameras evenly spaced around the vertical axis through 
+	// center, the first one is Camera(pos, target, referUp)
+	static std::vector<Camera> turntable(glm::vec3 pos, glm::vec3 target,
+		glm::vec3 referUp, glm::vec3 center, int views);
 private:
 	glm::vec3 pos, lookAt, up, right;
+	glm::vec3 screenX, screenY;
 
 
 };
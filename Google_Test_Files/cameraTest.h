@@ -3,7 +3,6 @@
 #include "gtest/gtest.h"
 #include "glm/glm.hpp"
 #include "../Camera_Ray/Camera.h"
-#include "../Camera_Ray/Camera.cpp"
 
 class cameraTest : public testing::Test {
 private: 
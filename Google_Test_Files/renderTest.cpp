@@ -0,0 +1,888 @@
+#include "pch.h"
+#include "renderTest.h"
+#include "../write_image_lib/lodepng.h"
+
+// Every scene with every acceleration structure (and both BVH node 
+// layouts) on 4 threads has to come out like the reference, which is 
+// rendered brute force
+TEST_P(goldenImageTest, matchesReference) {
+	int scene = std::get<0>(GetParam());
+	goldenBackend backend = std::get<1>(GetParam());
+	std::vector<unsigned char> image = renderScene(scene, backend, 4);
+
+	if (updateGolden()) {
+		if (backend.accel == NO_ACCEL) {
+			ASSERT_EQ(lodepng::encode(goldenPath(scene), image, 
+				GOLDEN_WIDTH, GOLDEN_HEIGHT), 0u) << goldenPath(scene);
+		}
+		return;
+	}
+
+	std::vector<unsigned char> reference;
+	unsigned width, height;
+	ASSERT_EQ(lodepng::decode(reference, width, height, 
+		goldenPath(scene)), 0u) << "can't read " << goldenPath(scene);
+	ASSERT_EQ(width, (unsigned)GOLDEN_WIDTH);
+	ASSERT_EQ(height, (unsigned)GOLDEN_HEIGHT);
+
+	imageDiff diff = compareImages(image, reference);
+	EXPECT_LE(diff.rmse, GOLDEN_MAX_RMSE);
+	EXPECT_LE(diff.badPixels, GOLDEN_MAX_BAD_PIXELS);
+}
+
+INSTANTIATE_TEST_CASE_P(builtinScenes, goldenImageTest,
+	testing::Combine(testing::Range(1, GOLDEN_SCENES + 1),
+		testing::Values(goldenBackend{ NO_ACCEL, BVH_FLOAT_NODES },
+			goldenBackend{ BVH_ACCEL, BVH_FLOAT_NODES },
+			goldenBackend{ BVH_ACCEL, BVH_QUANTIZED_NODES },
+			goldenBackend{ KDTREE_ACCEL, BVH_FLOAT_NODES },
+			goldenBackend{ GRID_ACCEL, BVH_FLOAT_NODES })));
+
+// pixels are sampled with their own random streams, so the thread 
+// count mustn't change a single bit
+TEST_F(renderTest, threadCountDoesntChangeImage) {
+	for (int scene = 1; scene <= GOLDEN_SCENES; ++scene) {
+		EXPECT_EQ(renderScene(scene, BVH_ACCEL, 1), 
+			renderScene(scene, BVH_ACCEL, 3)) << "scene " << scene;
+	}
+}
+
+// renders options' frame into colorBuffer, cancelling after 
+// cancelAfter tiles (< 0: never), and denoises it like startRender() 
+// if it finished. Returns the tiles it rendered, the AOVs in aovs
+static int renderTiles(const Options& options, 
+	std::vector<Color>& colorBuffer, int cancelAfter, 
+	AOVBuffers* aovs = nullptr) {
+
+	Camera cam(options.cameraPos, options.cameraForward, 
+		options.cameraReferUp);
+	std::vector<Object*> objects;
+	std::vector<LightSources*> lights;
+	Render renderer;
+	renderer.selectScene(objects, lights, options.selectScene);
+	renderer.buildAccelStructure(objects, options.accelStructure);
+	std::atomic<int> tiles(0);
+	renderer.onTileDone = [&](int, int, int, int) {
+		if (++tiles == cancelAfter) renderer.cancel();
+	};
+	colorBuffer.assign(options.width * options.height, 
+		options.backgroundColor);
+	renderer.renderImage(lights, objects, colorBuffer.data(), cam, options);
+	if (options.denoise && !renderer.isCancelled()) {
+		Denoiser(options).apply(colorBuffer.data(), renderer.aovs);
+	}
+	if (aovs) *aovs = renderer.aovs;
+	return tiles;
+}
+
+// a render killed partway (cancelled here) and started again has to 
+// skip the checkpointed tiles and still come out bit for bit the same
+TEST_F(renderTest, resumesFromCheckpoint) {
+	Options options = goldenOptions(3, BVH_ACCEL, 3);
+	int numTiles = ((GOLDEN_WIDTH + RENDER_TILE_SIZE - 1) / RENDER_TILE_SIZE) *
+		((GOLDEN_HEIGHT + RENDER_TILE_SIZE - 1) / RENDER_TILE_SIZE);
+	std::vector<Color> uninterrupted;
+	ASSERT_EQ(renderTiles(options, uninterrupted, -1), numTiles);
+
+	options.checkpointFile = "renderTest_checkpoint.bin";
+	// saves after every tile
+	options.checkpointInterval = 1e-6f;
+	remove(options.checkpointFile.c_str());
+	std::vector<Color> killed, resumed;
+	int firstRun = renderTiles(options, killed, numTiles / 3);
+	int secondRun = renderTiles(options, resumed, -1);
+	remove(options.checkpointFile.c_str());
+
+	EXPECT_LT(firstRun, numTiles);
+	EXPECT_EQ(firstRun + secondRun, numTiles);
+	for (int i = 0; i < uninterrupted.size(); ++i) {
+		ASSERT_EQ(uninterrupted[i].getColorR(), resumed[i].getColorR()) << i;
+		ASSERT_EQ(uninterrupted[i].getColorG(), resumed[i].getColorG()) << i;
+		ASSERT_EQ(uninterrupted[i].getColorB(), resumed[i].getColorB()) << i;
+	}
+}
+
+// the restored tiles' AOVs come back with their colors, so the 
+// AOVs and the denoised frame match an uninterrupted render's too
+TEST_F(renderTest, resumesAOVsAndDenoiseFromCheckpoint) {
+	Options options = goldenOptions(3, BVH_ACCEL, 3);
+	options.aovs = AOV_ALL;
+	options.denoise = true;
+	int numTiles = ((GOLDEN_WIDTH + RENDER_TILE_SIZE - 1) / RENDER_TILE_SIZE) *
+		((GOLDEN_HEIGHT + RENDER_TILE_SIZE - 1) / RENDER_TILE_SIZE);
+	std::vector<Color> uninterrupted;
+	AOVBuffers reference;
+	ASSERT_EQ(renderTiles(options, uninterrupted, -1, &reference), numTiles);
+
+	options.checkpointFile = "renderTest_checkpoint.bin";
+	options.checkpointInterval = 1e-6f;
+	remove(options.checkpointFile.c_str());
+	std::vector<Color> killed, resumed;
+	AOVBuffers aovs;
+	int firstRun = renderTiles(options, killed, numTiles / 3);
+	int secondRun = renderTiles(options, resumed, -1, &aovs);
+	remove(options.checkpointFile.c_str());
+
+	EXPECT_LT(firstRun, numTiles);
+	EXPECT_EQ(firstRun + secondRun, numTiles);
+	ASSERT_TRUE(aovs.has(AOV_ALL));
+	for (int c = 0; c < 3; ++c) {
+		EXPECT_EQ(reference.albedo[c], aovs.albedo[c]);
+		EXPECT_EQ(reference.normal[c], aovs.normal[c]);
+	}
+	EXPECT_EQ(reference.depth, aovs.depth);
+	EXPECT_EQ(reference.specular, aovs.specular);
+	EXPECT_EQ(reference.objectId, aovs.objectId);
+	EXPECT_EQ(reference.materialId, aovs.materialId);
+	EXPECT_EQ(reference.samples, aovs.samples);
+	for (int i = 0; i < uninterrupted.size(); ++i) {
+		ASSERT_EQ(uninterrupted[i].getColorR(), resumed[i].getColorR()) << i;
+		ASSERT_EQ(uninterrupted[i].getColorG(), resumed[i].getColorG()) << i;
+		ASSERT_EQ(uninterrupted[i].getColorB(), resumed[i].getColorB()) << i;
+	}
+}
+
+// a windows save killed between removing the old checkpoint & 
+// renaming the new one leaves only the .tmp, which still resumes
+TEST_F(renderTest, resumesFromLeftoverTmpCheckpoint) {
+	Options options = goldenOptions(3, BVH_ACCEL, 3);
+	int numTiles = ((GOLDEN_WIDTH + RENDER_TILE_SIZE - 1) / RENDER_TILE_SIZE) *
+		((GOLDEN_HEIGHT + RENDER_TILE_SIZE - 1) / RENDER_TILE_SIZE);
+	std::vector<Color> uninterrupted;
+	ASSERT_EQ(renderTiles(options, uninterrupted, -1), numTiles);
+
+	options.checkpointFile = "renderTest_checkpoint.bin";
+	options.checkpointInterval = 1e-6f;
+	std::string tmpName = options.checkpointFile + ".tmp";
+	remove(options.checkpointFile.c_str());
+	std::vector<Color> killed, resumed;
+	int firstRun = renderTiles(options, killed, numTiles / 3);
+	ASSERT_EQ(rename(options.checkpointFile.c_str(), tmpName.c_str()), 0);
+	int secondRun = renderTiles(options, resumed, -1);
+	remove(options.checkpointFile.c_str());
+	remove(tmpName.c_str());
+
+	EXPECT_EQ(firstRun + secondRun, numTiles);
+	for (int i = 0; i < uninterrupted.size(); ++i) {
+		ASSERT_EQ(uninterrupted[i].getColorR(), resumed[i].getColorR()) << i;
+		ASSERT_EQ(uninterrupted[i].getColorG(), resumed[i].getColorG()) << i;
+		ASSERT_EQ(uninterrupted[i].getColorB(), resumed[i].getColorB()) << i;
+	}
+}
+
+// renders options' frame progressively, returns the passes it took
+static int renderProgressive(const Options& options, 
+	std::vector<unsigned char>& image) {
+
+	Camera cam(options.cameraPos, options.cameraForward, 
+		options.cameraReferUp);
+	std::vector<Object*> objects;
+	std::vector<LightSources*> lights;
+	Render renderer;
+	renderer.selectScene(objects, lights, options.selectScene);
+	renderer.buildAccelStructure(objects, options.accelStructure);
+	std::vector<Color> colorBuffer(options.width * options.height, 
+		options.backgroundColor);
+	int passes = renderer.renderProgressive(lights, objects, 
+		colorBuffer.data(), cam, options);
+	image = renderer.toImageData(colorBuffer.data(), 
+		options.width, options.height);
+	return passes;
+}
+
+// progressive passes sample each pixel from its own stream too, and 
+// converge on the same image as the tiled render
+TEST_F(renderTest, progressiveConvergesOnReference) {
+	for (int scene = 1; scene <= GOLDEN_SCENES; ++scene) {
+		Options options = goldenOptions(scene, BVH_ACCEL, 3);
+		options.progressiveSamples = 16;
+		std::vector<unsigned char> image, singleThread;
+		ASSERT_EQ(renderProgressive(options, image), 16);
+		options.numThreads = 1;
+		renderProgressive(options, singleThread);
+		EXPECT_EQ(image, singleThread) << "scene " << scene;
+
+		std::vector<unsigned char> reference;
+		unsigned width, height;
+		ASSERT_EQ(lodepng::decode(reference, width, height, 
+			goldenPath(scene)), 0u) << "can't read " << goldenPath(scene);
+		// the sample patterns differ, so soft shadow edges are noisy 
+		// both ways, but on average the images have to agree
+		double bias = .0;
+		for (size_t i = 0; i < image.size(); i += 4) {
+			for (int c = 0; c < 3; ++c) {
+				bias += (int)image[i + c] - (int)reference[i + c];
+			}
+		}
+		bias /= image.size() / 4 * 3;
+		EXPECT_LE(fabs(bias), GOLDEN_MAX_BIAS) << "scene " << scene;
+	}
+}
+
+// a loose noise target stops it long before the sample limit
+TEST_F(renderTest, progressiveStopsAtNoiseTarget) {
+	Options options = goldenOptions(1, BVH_ACCEL, 3);
+	options.progressiveSamples = 1000;
+	options.progressiveNoiseTarget = .05f;
+	std::vector<unsigned char> image;
+	int passes = renderProgressive(options, image);
+	EXPECT_GE(passes, 2);
+	EXPECT_LT(passes, 1000);
+}
+
+// a batch of turntable views shares the thread pool, but every view 
+// has to come out exactly like rendering its camera on its own
+TEST_F(renderTest, viewBatchMatchesSingleRenders) {
+	Options options = goldenOptions(2, BVH_ACCEL, 3);
+	std::vector<Object*> objects;
+	std::vector<LightSources*> lights;
+	Render renderer;
+	renderer.selectScene(objects, lights, options.selectScene);
+	renderer.buildAccelStructure(objects, options.accelStructure);
+
+	std::vector<Camera> cameras = Camera::turntable(options.cameraPos,
+		options.cameraForward, options.cameraReferUp, 
+		options.turntableCenter, 3);
+	ASSERT_EQ(cameras.size(), 3u);
+	std::vector<std::vector<Color> > buffers(cameras.size(), 
+		std::vector<Color>(options.width * options.height, 
+			options.backgroundColor));
+	std::vector<RenderView> views(cameras.size());
+	for (int i = 0; i < views.size(); ++i) {
+		views[i].cam = cameras[i];
+		views[i].colorBuffer = buffers[i].data();
+	}
+	renderer.renderViews(lights, objects, views, options);
+
+	for (int i = 0; i < views.size(); ++i) {
+		std::vector<Color> single(options.width * options.height, 
+			options.backgroundColor);
+		renderer.renderImage(lights, objects, single.data(), 
+			cameras[i], options);
+		EXPECT_EQ(renderer.toImageData(single.data(), 
+			options.width, options.height), 
+			renderer.toImageData(buffers[i].data(), 
+				options.width, options.height)) << "view " << i;
+	}
+	// the views really do look at the scene from elsewhere
+	EXPECT_NE(renderer.toImageData(buffers[0].data(), 
+		options.width, options.height), 
+		renderer.toImageData(buffers[1].data(), 
+			options.width, options.height));
+}
+
+// a refitted BVH has to find the same hits as one built 
+// over the moved scene
+TEST_F(renderTest, refitMatchesRebuild) {
+	Options options = goldenOptions(4, BVH_ACCEL, 3);
+	Camera cam(options.cameraPos, options.cameraForward, 
+		options.cameraReferUp);
+	std::vector<Object*> objects;
+	std::vector<LightSources*> lights;
+	Render refitted, rebuilt;
+	refitted.selectScene(objects, lights, options.selectScene);
+	refitted.buildAccelStructure(objects, options.accelStructure);
+	Animation animation = Animation::builtIn(options.selectScene, 
+		objects, lights);
+	ASSERT_FALSE(animation.empty());
+
+	std::vector<Color> a(options.width * options.height, 
+		options.backgroundColor);
+	std::vector<Color> b = a;
+	EXPECT_TRUE(animation.apply(.6f));
+	bool refit = refitted.updateAccelStructure(objects, 
+		options.accelStructure);
+	refitted.renderImage(lights, objects, a.data(), cam, options);
+	rebuilt.buildAccelStructure(objects, options.accelStructure);
+	rebuilt.renderImage(lights, objects, b.data(), cam, options);
+	// the spheres are globals, the other tests want them back
+	animation.restore();
+
+	// the quantized layout has no float boxes left to refit
+	EXPECT_EQ(refit, BVH_DEFAULT_LAYOUT == BVH_FLOAT_NODES);
+	EXPECT_EQ(refitted.toImageData(a.data(), options.width, options.height),
+		rebuilt.toImageData(b.data(), options.width, options.height));
+}
+
+// an instance reports which prototype object it hit, through nested 
+// instances too, and shades that object without tracing it again
+TEST_F(renderTest, instanceShadesPrototypeHit) {
+	Color grey(.5f, .5f, .5f, .0f);
+	Sphere sphere(glm::vec3(-1.0f, .0f, .0f), .5f, grey, 1.0f, DIFFUSE);
+	Box box(glm::vec3(1.0f, .0f, .0f), 1.0f, grey, 1.0f, DIFFUSE);
+	std::vector<Object*> parts = { &sphere, &box };
+	BVH prototype(parts);
+	Instance inner(&prototype, glm::translate(glm::mat4(1.0f), 
+		glm::vec3(.0f, .0f, -5.0f)), grey, 1.0f, DIFFUSE);
+	std::vector<Object*> group = { &inner };
+	BVH groupPrototype(group);
+	Instance outer(&groupPrototype, glm::translate(glm::mat4(1.0f), 
+		glm::vec3(.0f, 2.0f, .0f)), grey, 1.0f, DIFFUSE);
+
+	// the index the instance reported, -1 for a miss
+	auto shade = [](Instance& instance, glm::vec3 orig, glm::vec3 dir, 
+		glm::vec3& N) {
+		float t = FLT_MAX;
+		int index = -1;
+		glm::vec2 uv(.0f), st;
+		if (!instance.findIntersection(orig, dir, t, index, uv)) return -1;
+		instance.getSurfaceProperties(orig + dir * t, orig, dir, index, 
+			uv, N, st);
+		return index;
+	};
+	glm::vec3 N;
+	glm::vec3 dir(.0f, .0f, -1.0f);
+	// the box's front face, then the sphere head on
+	int index = shade(inner, glm::vec3(1.0f, .2f, .0f), dir, N);
+	ASSERT_GE(index, 0);
+	EXPECT_EQ(prototype.objectAt(index), &box);
+	EXPECT_NEAR(N.z, 1.0f, 1e-3f);
+	index = shade(inner, glm::vec3(-1.0f, .0f, .0f), dir, N);
+	ASSERT_GE(index, 0);
+	EXPECT_EQ(prototype.objectAt(index), &sphere);
+	EXPECT_NEAR(N.z, 1.0f, 1e-3f);
+	// through both levels: the slot in the group, the box's above it
+	index = shade(outer, glm::vec3(1.2f, 2.0f, .0f), dir, N);
+	ASSERT_GE(index, 0);
+	int groupSlots = groupPrototype.objectCount();
+	EXPECT_EQ(groupPrototype.objectAt(index % groupSlots), &inner);
+	EXPECT_EQ(prototype.objectAt(index / groupSlots), &box);
+	EXPECT_NEAR(N.z, 1.0f, 1e-3f);
+	// between the parts
+	EXPECT_EQ(shade(inner, glm::vec3(.0f, .0f, .0f), dir, N), -1);
+}
+
+TEST_F(renderTest, animationDescription) {
+	std::vector<Object*> objects;
+	std::vector<LightSources*> lights;
+	Render renderer;
+	renderer.selectScene(objects, lights, 4);
+	glm::vec3 rest;
+	ASSERT_TRUE(objects[0]->getPosition(rest));
+
+	std::istringstream description(
+		"# sphere 0 goes up and comes back\n"
+		"object 0 0 0 0 -1\n"
+		"object 0 2 0 2 -1   # keys needn't be in order\n"
+		"object 0 1 0 1 -1\n"
+		"camera 0  0 0 0  0 0 -1\n");
+	Animation animation;
+	std::string error;
+	ASSERT_TRUE(animation.parse(description, objects, lights, error)) << error;
+	EXPECT_FLOAT_EQ(animation.getDuration(), 2.0f);
+	EXPECT_TRUE(animation.hasCamera());
+
+	glm::vec3 pos;
+	EXPECT_TRUE(animation.apply(1.5f));
+	objects[0]->getPosition(pos);
+	EXPECT_FLOAT_EQ(pos.y, 1.5f);
+	// nothing moves after the last key
+	EXPECT_TRUE(animation.apply(3.0f));
+	EXPECT_FALSE(animation.apply(4.0f));
+	EXPECT_TRUE(animation.restore());
+	objects[0]->getPosition(pos);
+	EXPECT_EQ(pos, rest);
+
+	std::istringstream badIndex("object 99 0 0 0 0\n");
+	EXPECT_FALSE(animation.parse(badIndex, objects, lights, error));
+	EXPECT_NE(error.find("line 1"), std::string::npos) << error;
+	// the plane
+	std::istringstream unmovable("\nobject " + 
+		std::to_string(objects.size() - 1) + " 0 0 0 0\n");
+	EXPECT_FALSE(animation.parse(unmovable, objects, lights, error));
+	EXPECT_NE(error.find("line 2"), std::string::npos) << error;
+	std::istringstream unknown("spin 0 0 0 0\n");
+	EXPECT_FALSE(animation.parse(unknown, objects, lights, error));
+}
+
+TEST_F(renderTest, animationWritesEveryFrame) {
+	Options options = goldenOptions(1, BVH_ACCEL, 2);
+	options.width = options.height = 32;
+	options.aspectRatio = 1.0f;
+	options.animationFrames = 3;
+	options.animationFPS = 2.0f;
+	Camera cam(options.cameraPos, options.cameraForward, 
+		options.cameraReferUp);
+	std::vector<Object*> objects;
+	std::vector<LightSources*> lights;
+	Render renderer;
+	renderer.selectScene(objects, lights, options.selectScene);
+	Animation animation = Animation::builtIn(options.selectScene, 
+		objects, lights);
+	int frames = renderer.renderAnimation(lights, objects, animation, 
+		cam, options, "renderTest_animation.png");
+	animation.restore();
+
+	EXPECT_EQ(frames, 3);
+	for (int f = 0; f < 3; ++f) {
+		std::string name = Animation::frameFileName(
+			"renderTest_animation.png", f);
+		FILE* file = fopen(name.c_str(), "rb");
+		EXPECT_NE(file, nullptr) << name;
+		if (file != nullptr) fclose(file);
+		remove(name.c_str());
+	}
+	EXPECT_EQ(Animation::frameFileName("out/a.b/frame", 12), 
+		"out/a.b/frame_0012");
+}
+
+// a small camera move reuses most of the last frame, and comes out 
+// close to rendering the moved camera from scratch
+TEST_F(renderTest, reprojectionReusesLastFrame) {
+	Options options = goldenOptions(3, BVH_ACCEL, 3);
+	// kept pixels have their shadow samples from another pixel's 
+	// random stream, that noise would swamp the comparison
+	options.softShadows = false;
+	std::vector<Object*> objects;
+	std::vector<LightSources*> lights;
+	Render renderer;
+	renderer.selectScene(objects, lights, options.selectScene);
+	renderer.buildAccelStructure(objects, options.accelStructure);
+	int pixels = options.width * options.height;
+	Camera cam(options.cameraPos, options.cameraForward, 
+		options.cameraReferUp);
+	ReprojectionCache cache;
+
+	std::vector<Color> first(pixels), fresh(pixels);
+	EXPECT_EQ(renderer.renderReprojected(lights, objects, first.data(), 
+		cam, options, cache), 0);
+	renderer.renderImage(lights, objects, fresh.data(), cam, options);
+	std::vector<unsigned char> firstImage = 
+		renderer.toImageData(first.data(), options.width, options.height);
+	EXPECT_EQ(firstImage, 
+		renderer.toImageData(fresh.data(), options.width, options.height));
+
+	// nothing moved: every diffuse pixel is kept
+	std::vector<Color> same(pixels);
+	int reusable = renderer.renderReprojected(lights, objects, same.data(), 
+		cam, options, cache);
+	EXPECT_GT(reusable, pixels / 4);
+	EXPECT_EQ(renderer.stats.reprojectedPixels, RENDER_STATS ? reusable : 0);
+	EXPECT_EQ(firstImage, 
+		renderer.toImageData(same.data(), options.width, options.height));
+
+	Camera moved(options.cameraPos + glm::vec3(.03f, .01f, .0f), 
+		options.cameraForward, options.cameraReferUp);
+	std::vector<Color> reprojected(pixels);
+	int reused = renderer.renderReprojected(lights, objects, 
+		reprojected.data(), moved, options, cache);
+	renderer.renderImage(lights, objects, fresh.data(), moved, options);
+	imageDiff diff = compareImages(
+		renderer.toImageData(reprojected.data(), options.width, options.height),
+		renderer.toImageData(fresh.data(), options.width, options.height));
+	EXPECT_GT(reused, reusable / 2);
+	EXPECT_LT(diff.rmse, REPROJECTION_MAX_RMSE);
+	EXPECT_LT(diff.badPixels, GOLDEN_MAX_BAD_PIXELS);
+
+	// different settings can't use the cache
+	options.reprojectionMaxAge = 0;
+	EXPECT_EQ(renderer.renderReprojected(lights, objects, same.data(), 
+		moved, options, cache), 0);
+	options.sampleNum = 1;
+	EXPECT_FALSE(cache.usableFor(options));
+}
+
+TEST_F(renderTest, editedTilesMatchFullRender) {
+	Options options = goldenOptions(4, BVH_ACCEL, 3);
+	options.recordFootprint = true;
+	std::vector<Object*> objects;
+	std::vector<LightSources*> lights;
+	Render renderer;
+	renderer.selectScene(objects, lights, options.selectScene);
+	renderer.buildAccelStructure(objects, options.accelStructure);
+	int pixels = options.width * options.height;
+	int numTiles = ((GOLDEN_WIDTH + RENDER_TILE_SIZE - 1) / RENDER_TILE_SIZE) *
+		((GOLDEN_HEIGHT + RENDER_TILE_SIZE - 1) / RENDER_TILE_SIZE);
+	Camera cam(options.cameraPos, options.cameraForward, 
+		options.cameraReferUp);
+	std::vector<Color> edited(pixels), fresh(pixels);
+	renderer.renderImage(lights, objects, edited.data(), cam, options);
+	EXPECT_EQ(renderer.renderEdited(lights, objects, edited.data(), cam, 
+		options, std::vector<Object*>()), 0);
+
+	// a far sphere turns red, a glass one near the camera into a mirror
+	Object* far = objects[objects.size() - 3];
+	Object* glass = objects[1];
+	Color farColor = far->getColor();
+	materialType glassMaterial = glass->material;
+	far->setColor(1.0f, .0f, .0f);
+	glass->material = REFLECTION;
+	for (int i = 0; i < 2; ++i) {
+		std::vector<Object*> edit(1, i == 0 ? far : glass);
+		int tiles = renderer.renderEdited(lights, objects, edited.data(), 
+			cam, options, edit);
+		EXPECT_GT(tiles, 0);
+		EXPECT_LT(tiles, numTiles / (i == 0 ? 4 : 1));
+	}
+	Render full;
+	full.buildAccelStructure(objects, options.accelStructure);
+	full.renderImage(lights, objects, fresh.data(), cam, options);
+	far->setColor(farColor.getColorR(), farColor.getColorG(), 
+		farColor.getColorB());
+	glass->material = glassMaterial;
+	EXPECT_EQ(renderer.toImageData(edited.data(), options.width, options.height),
+		renderer.toImageData(fresh.data(), options.width, options.height));
+
+	// a different frame has no footprint to go by
+	options.width /= 2;
+	options.aspectRatio = (float)options.width / (float)options.height;
+	EXPECT_EQ(renderer.renderEdited(lights, objects, fresh.data(), cam, 
+		options, std::vector<Object*>(1, far)), 
+		((options.width + RENDER_TILE_SIZE - 1) / RENDER_TILE_SIZE) *
+		((GOLDEN_HEIGHT + RENDER_TILE_SIZE - 1) / RENDER_TILE_SIZE));
+}
+
+TEST_F(renderTest, denoisedCloserToMoreSamples) {
+	// the area light's soft shadows are where the noise is
+	Options options = goldenOptions(3, BVH_ACCEL, 3);
+	auto render = [&](const Options& renderOptions, Render& renderer) {
+		std::vector<Object*> objects;
+		std::vector<LightSources*> lights;
+		renderer.selectScene(objects, lights, renderOptions.selectScene);
+		Camera cam(renderOptions.cameraPos, renderOptions.cameraForward, 
+			renderOptions.cameraReferUp);
+		std::vector<Color> colorBuffer(options.width * options.height, 
+			options.backgroundColor);
+		renderer.startRender(lights, objects, colorBuffer.data(), cam, 
+			renderOptions);
+		return renderer.toImageData(colorBuffer.data(), 
+			options.width, options.height);
+	};
+	Render denoiser, other;
+	options.sampleNum = 12;
+	std::vector<unsigned char> reference = render(options, other);
+	options.sampleNum = 4;
+	std::vector<unsigned char> noisy = render(options, other);
+	options.denoise = true;
+	std::vector<unsigned char> denoised = render(options, denoiser);
+	options.numThreads = 1;
+	EXPECT_EQ(denoised, render(options, other));
+
+	// compared where a pixel & its neighbours see the same diffuse 
+	// surface color: that's the sampling noise, no filter turns 16 
+	// samples' coverage of the far checkers into 144's
+	const AOVBuffers& features = denoiser.aovs;
+	int width = options.width;
+	auto flat = [&](int x, int y) {
+		for (int dy = -1; dy <= 1; ++dy) {
+			for (int dx = -1; dx <= 1; ++dx) {
+				int i = (y + dy) * width + x + dx;
+				if (features.specular[i] > .0f) return false;
+				for (int c = 0; c < 3; ++c) {
+					if (features.albedo[c][i] != 
+						features.albedo[c][y * width + x]) return false;
+				}
+			}
+		}
+		return true;
+	};
+	double noisySquared = .0, denoisedSquared = .0;
+	int flatPixels = 0;
+	for (int y = 1; y < options.height - 1; ++y) {
+		for (int x = 1; x < width - 1; ++x) {
+			if (!flat(x, y)) continue;
+			flatPixels++;
+			for (int c = 0; c < 3; ++c) {
+				int i = (y * width + x) * 4 + c;
+				double n = (double)noisy[i] - reference[i];
+				double d = (double)denoised[i] - reference[i];
+				noisySquared += n * n;
+				denoisedSquared += d * d;
+			}
+		}
+	}
+	ASSERT_GT(flatPixels, options.width * options.height / 4);
+	double noisyRmse = sqrt(noisySquared / (flatPixels * 3));
+	double denoisedRmse = sqrt(denoisedSquared / (flatPixels * 3));
+	EXPECT_LT(denoisedRmse, noisyRmse * DENOISE_MAX_ERROR_RATIO) << 
+		"within surfaces 16 spp rmse " << noisyRmse << 
+		", denoised " << denoisedRmse;
+	EXPECT_LT(compareImages(denoised, reference).rmse, 
+		compareImages(noisy, reference).rmse);
+
+	// what's seen in mirrors & glass is left alone
+	int specular = 0;
+	for (int i = 0; i < width * options.height; ++i) {
+		if (features.specular[i] == .0f) continue;
+		specular++;
+		for (int c = 0; c < 3; ++c) {
+			EXPECT_EQ(noisy[i * 4 + c], denoised[i * 4 + c]) << "pixel " << i;
+		}
+	}
+	EXPECT_GT(specular, 0);
+}
+
+TEST_F(renderTest, aovsFromFirstHit) {
+	Options options = goldenOptions(3, BVH_ACCEL, 3);
+	std::vector<Object*> objects;
+	std::vector<LightSources*> lights;
+	Render renderer;
+	renderer.selectScene(objects, lights, options.selectScene);
+	renderer.buildAccelStructure(objects, options.accelStructure);
+	Camera cam(options.cameraPos, options.cameraForward, 
+		options.cameraReferUp);
+	int pixels = options.width * options.height;
+	std::vector<Color> plain(pixels), recorded(pixels);
+	renderer.renderImage(lights, objects, plain.data(), cam, options);
+	EXPECT_EQ(renderer.aovs.enabled, (unsigned)AOV_NONE);
+	EXPECT_TRUE(renderer.aovs.depth.empty());
+
+	options.aovs = AOV_ALL;
+	renderer.renderImage(lights, objects, recorded.data(), cam, options);
+	// recording doesn't change the image
+	EXPECT_EQ(renderer.toImageData(plain.data(), options.width, options.height),
+		renderer.toImageData(recorded.data(), options.width, options.height));
+	const AOVBuffers& aovs = renderer.aovs;
+	ASSERT_TRUE(aovs.has(AOV_ALL));
+
+	// the sky in the top left corner
+	EXPECT_EQ(aovs.objectId[0], -1);
+	EXPECT_EQ(aovs.materialId[0], -1);
+	EXPECT_EQ(aovs.depth[0], .0f);
+	EXPECT_FLOAT_EQ(aovs.albedo[2][0], 
+		(float)options.backgroundColor.getColorB());
+	// the glass sphere in the middle, seen head on
+	int center = options.height / 2 * options.width + options.width / 2;
+	EXPECT_EQ(aovs.objectId[center], 0);
+	EXPECT_EQ(objects[aovs.objectId[center]], &scene3_sphere1);
+	EXPECT_EQ(aovs.materialId[center], (int)REFLECTION_AND_REFRACTION);
+	EXPECT_EQ(aovs.specular[center], 1.0f);
+	EXPECT_NEAR(aovs.depth[center], 1.5f, .05f);
+	EXPECT_NEAR(aovs.normal[2][center], 1.0f, .01f);
+	// the floor along the bottom row
+	int floor = (options.height - 1) * options.width + options.width / 2;
+	EXPECT_EQ(objects[aovs.objectId[floor]], &scene3_plane1);
+	EXPECT_NEAR(aovs.normal[1][floor], 1.0f, 1e-4f);
+	for (int i = 0; i < pixels; ++i) {
+		EXPECT_EQ(aovs.samples[i], 
+			(int)(options.sampleNum * options.sampleNum));
+	}
+
+	std::string depthName = AOVBuffers::fileName("renderTest_aov.png", 
+		AOV_DEPTH);
+	EXPECT_EQ(depthName, "renderTest_aov_depth.pfm");
+	ASSERT_TRUE(aovs.write(depthName, AOV_DEPTH));
+	std::ifstream pfm(depthName, std::ios::binary);
+	std::string magic;
+	int width, height;
+	float scale;
+	pfm >> magic >> width >> height >> scale;
+	pfm.get();
+	EXPECT_EQ(magic, "Pf");
+	EXPECT_EQ(width, options.width);
+	EXPECT_EQ(height, options.height);
+	EXPECT_LT(scale, .0f);
+	// the bottom row comes first
+	float first;
+	pfm.read((char*)&first, sizeof(float));
+	EXPECT_EQ(first, aovs.depth[(options.height - 1) * options.width]);
+	pfm.close();
+	remove(depthName.c_str());
+	EXPECT_FALSE(aovs.write(depthName, 1 << 10));
+}
+
+// progressive passes record the AOVs too, and startRender() denoises 
+// the averaged frame
+TEST_F(renderTest, progressiveRecordsAOVsAndDenoises) {
+	Options options = goldenOptions(3, BVH_ACCEL, 3);
+	options.progressive = true;
+	options.progressiveSamples = 9;
+	options.aovs = AOV_ALL;
+	auto render = [&](const Options& renderOptions, Render& renderer) {
+		std::vector<Object*> objects;
+		std::vector<LightSources*> lights;
+		renderer.selectScene(objects, lights, renderOptions.selectScene);
+		Camera cam(renderOptions.cameraPos, renderOptions.cameraForward, 
+			renderOptions.cameraReferUp);
+		std::vector<Color> colorBuffer(options.width * options.height, 
+			options.backgroundColor);
+		renderer.startRender(lights, objects, colorBuffer.data(), cam, 
+			renderOptions);
+		return renderer.toImageData(colorBuffer.data(), 
+			options.width, options.height);
+	};
+	Render plain, denoiser;
+	std::vector<unsigned char> noisy = render(options, plain);
+	const AOVBuffers& aovs = plain.aovs;
+	ASSERT_TRUE(aovs.has(AOV_ALL));
+	int pixels = options.width * options.height;
+	for (int i = 0; i < pixels; ++i) {
+		EXPECT_EQ(aovs.samples[i], options.progressiveSamples);
+	}
+	// the glass sphere in the middle, seen head on
+	int center = options.height / 2 * options.width + options.width / 2;
+	EXPECT_EQ(aovs.objectId[center], 0);
+	EXPECT_EQ(aovs.specular[center], 1.0f);
+	EXPECT_NEAR(aovs.depth[center], 1.5f, .05f);
+
+	options.denoise = true;
+	std::vector<unsigned char> denoised = render(options, denoiser);
+	EXPECT_NE(denoised, noisy);
+	for (int i = 0; i < pixels; ++i) {
+		if (denoiser.aovs.specular[i] == .0f) continue;
+		for (int c = 0; c < 3; ++c) {
+			EXPECT_EQ(noisy[i * 4 + c], denoised[i * 4 + c]) << "pixel " << i;
+		}
+	}
+	options.numThreads = 1;
+	EXPECT_EQ(denoised, render(options, plain));
+}
+
+TEST_F(renderTest, lightTreeSamplesManyLights) {
+	// scene 3 lit by a ceiling of side * side small panels instead 
+	// of its one area light
+	Options options = goldenOptions(3, BVH_ACCEL, 3);
+	options.sampleNum = 4;
+	std::vector<Object*> objects;
+	std::vector<LightSources*> sceneLights;
+	Render renderer;
+	renderer.selectScene(objects, sceneLights, options.selectScene);
+	renderer.buildAccelStructure(objects, options.accelStructure);
+	Camera cam(options.cameraPos, options.cameraForward, 
+		options.cameraReferUp);
+	auto panels = [](int side, std::vector<Light>& storage) {
+		std::vector<LightSources*> lights;
+		storage.clear();
+		storage.reserve(side * side);
+		float power = 4.0f / (side * side);
+		for (int i = 0; i < side; ++i) {
+			for (int j = 0; j < side; ++j) {
+				glm::vec3 corner(-2.0f + 4.0f * i / side, 1.9f, 
+					-1.0f - 4.0f * j / side);
+				storage.push_back(Light(corner, 
+					Color(power, power, power, .0f), AREA_LIGHT, corner, 
+					glm::vec3(.1f, .0f, .0f), glm::vec3(.0f, .0f, -.1f)));
+				lights.push_back(&storage.back());
+			}
+		}
+		return lights;
+	};
+	auto render = [&](std::vector<LightSources*>& lights, 
+		const Options& renderOptions, long long& shadowRays) {
+		std::vector<Color> colorBuffer(options.width * options.height, 
+			options.backgroundColor);
+		renderer.renderImage(lights, objects, colorBuffer.data(), cam, 
+			renderOptions);
+		shadowRays = renderer.stats.shadowRays;
+		return renderer.toImageData(colorBuffer.data(), 
+			options.width, options.height);
+	};
+
+	std::vector<Light> storage;
+	std::vector<LightSources*> lights = panels(8, storage);
+	long long allRays, treeRays, rays;
+	std::vector<unsigned char> all = render(lights, options, allRays);
+	// every hit traces a shadow ray per light
+	long long hits = allRays / lights.size();
+	Options treeOptions = options;
+	treeOptions.lightSamples = 4;
+	std::vector<unsigned char> sampled = render(lights, treeOptions, 
+		treeRays);
+	// the ray counts are all 0 without RENDER_STATS
+#if RENDER_STATS
+	EXPECT_LE(treeRays, hits * treeOptions.lightSamples);
+	EXPECT_LT(treeRays * 10, allRays);
+#endif
+	treeOptions.numThreads = 1;
+	EXPECT_EQ(sampled, render(lights, treeOptions, rays));
+
+	// unbiased: noisier, but the same on average
+	EXPECT_LT(compareImages(sampled, all).rmse, LIGHT_TREE_MAX_RMSE);
+	double bias = .0;
+	for (size_t i = 0; i < all.size(); i += 4) {
+		for (int c = 0; c < 3; ++c) {
+			bias += (double)sampled[i + c] - all[i + c];
+		}
+	}
+	bias /= all.size() / 4 * 3;
+	EXPECT_LE(fabs(bias), GOLDEN_MAX_BIAS);
+
+	// no more lights than samples shades every one of them
+	Options fewOptions = options;
+	fewOptions.lightSamples = (int)lights.size();
+	EXPECT_EQ(all, render(lights, fewOptions, rays));
+	EXPECT_EQ(allRays, rays);
+
+#if RENDER_STATS
+	// four times the lights, the same shadow rays per hit
+	lights = panels(16, storage);
+	render(lights, treeOptions, rays);
+	EXPECT_LE(rays, hits * treeOptions.lightSamples);
+	EXPECT_GT(rays * 10, treeRays * 9);
+#endif
+}
+
+// A light picked with probability pmf is weighted 1 / pmf, so over 
+// all picks each one has to add up to weight 1 for the sampled 
+// shading to average out to shading every light. That includes the 
+// lights behind the surface, whose specular term can still light it
+TEST_F(renderTest, lightTreeReachesBackFacingLights) {
+	// point lights in a ring around a point on an upward facing 
+	// surface, every other one below it
+	const int numLights = 32;
+	std::vector<Light> storage;
+	storage.reserve(numLights);
+	std::vector<LightSources*> lights;
+	for (int i = 0; i < numLights; ++i) {
+		float angle = 2.0f * (float)M_PI * i / numLights;
+		glm::vec3 pos(2.0f * cos(angle), (i % 2 ? 1.0f : -1.0f) * 
+			(.5f + (float)i / numLights), 2.0f * sin(angle));
+		float power = .5f + .25f * (i % 5);
+		storage.push_back(Light(pos, Color(power, power, power, .0f), 
+			POINT_LIGHT, pos, glm::vec3(.0f), glm::vec3(.0f)));
+		lights.push_back(&storage.back());
+	}
+	LightTree tree;
+	tree.build(lights, 4);
+	ASSERT_FALSE(tree.empty());
+
+	// the picks of evenly spread u, i.e. their expectation
+	glm::vec3 P(.0f), N(.0f, 1.0f, .0f);
+	const int picks = 1 << 16;
+	std::vector<double> weight(numLights, .0);
+	for (int k = 0; k < picks; ++k) {
+		float pmf;
+		LightSources* light = tree.sample(P, N, (k + .5f) / picks, pmf);
+		ASSERT_NE(light, nullptr);
+		int i = (int)(std::find(lights.begin(), lights.end(), light) - 
+			lights.begin());
+		weight[i] += 1.0 / pmf / picks;
+	}
+	for (int i = 0; i < numLights; ++i) {
+		EXPECT_NEAR(weight[i], 1.0, .02) << "light " << i;
+	}
+}
+
+// Single thread BVH throughput floors, about a quarter of what an 
+// optimized build does on a desktop cpu, to catch big regressions 
+// rather than noise. RAYTRACER_PERF_SCALE scales them for slower 
+// machines (0 turns the check off). Only checked in optimized builds.
+static const double minRaysPerSec[GOLDEN_SCENES] = {
+	800000.0, 1200000.0, 1000000.0, 800000.0, 700000.0
+};
+
+TEST_F(renderTest, raysPerSecondFloor) {
+#if !RENDER_STATS || !defined(NDEBUG)
+	RENDER_TEST_SKIP("rays/s floors need an optimized build with RENDER_STATS");
+#else
+	double scale = 1.0;
+	const char* scaleEnv = getenv("RAYTRACER_PERF_SCALE");
+	if (scaleEnv != nullptr) scale = atof(scaleEnv);
+	if (scale <= .0) {
+		RENDER_TEST_SKIP("rays/s floors turned off by RAYTRACER_PERF_SCALE");
+	}
+
+	for (int scene = 1; scene <= GOLDEN_SCENES; ++scene) {
+		// best of 3, a frame only takes a few ms
+		double best = .0;
+		for (int run = 0; run < 3; ++run) {
+			RenderStats stats;
+			double seconds;
+			renderScene(scene, BVH_ACCEL, 1, &stats, &seconds);
+			best = std::max(best, stats.totalRays() / seconds);
+		}
+		EXPECT_GE(best, minRaysPerSec[scene - 1] * scale) 
+			<< "scene " << scene << ": " << best << " rays/s";
+	}
+#endif
+}
\ No newline at end of file
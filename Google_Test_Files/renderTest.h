@@ -0,0 +1,184 @@
+#pragma once
+
+#include <stdlib.h>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+#include "gtest/gtest.h"
+#include "../Render/Render.h"
+
+// reference renders, relative to the working directory (the project 
+// dir when run from visual studio)
+#ifndef GOLDEN_IMAGE_DIR
+#define GOLDEN_IMAGE_DIR "golden_images/"
+#endif
+
+// what the references were rendered with, changing any of these 
+// means regenerating them: run with RAYTRACER_UPDATE_GOLDEN=1
+#define GOLDEN_WIDTH 120
+#define GOLDEN_HEIGHT 80
+#define GOLDEN_SAMPLES 2
+#define GOLDEN_SCENES 5
+
+// how far a render may drift from its reference (8 bit values): 
+// overall rms error, and the share of pixels allowed to be off by 
+// more than GOLDEN_PIXEL_DIFF in some channel (an edge or a soft 
+// shadow sample flipping)
+#define GOLDEN_MAX_RMSE 2.0
+#define GOLDEN_PIXEL_DIFF 32
+#define GOLDEN_MAX_BAD_PIXELS 0.005
+// mean signed difference allowed for renders sampled differently 
+// (progressive), where single pixels may be off by a lot
+#define GOLDEN_MAX_BIAS 0.5
+// rms error allowed for a reprojected frame against rendering it 
+// from scratch: anti-aliased silhouettes get carried over with the 
+// old camera's coverage
+#define REPROJECTION_MAX_RMSE 4.0
+// 16 samples a pixel denoised against 144, how much of the 16 
+// sample image's error within surfaces may be left
+#define DENOISE_MAX_ERROR_RATIO 0.6
+// rms error allowed for a many light scene shading 4 lights per hit 
+// picked from the light tree against shading all of them
+#define LIGHT_TREE_MAX_RMSE 3.0
+
+// what a golden image is rendered through: the structure type, and 
+// for a BVH its node layout
+struct goldenBackend {
+	accelType accel;
+	bvhNodeLayout layout;
+};
+
+// names the backend in gtest's output, e.g. "bvh quantized"
+inline void PrintTo(const goldenBackend& backend, std::ostream* os) {
+	static const char* names[] = { "none", "bvh", "kdtree", "grid" };
+	*os << names[backend.accel];
+	if (backend.accel == BVH_ACCEL && 
+		backend.layout == BVH_QUANTIZED_NODES) {
+		*os << " quantized";
+	}
+}
+
+// skips the rest of the test, reported as skipped where the gtest 
+// version knows about that (the visual studio package's doesn't)
+#ifdef GTEST_SKIP
+#define RENDER_TEST_SKIP(message) GTEST_SKIP() << message
+#else
+#define RENDER_TEST_SKIP(message) return
+#endif
+
+struct imageDiff {
+	double rmse;
+	// share of pixels off by more than GOLDEN_PIXEL_DIFF
+	double badPixels;
+};
+
+class renderTest : public testing::Test {
+private:
+
+public:
+
+	// the settings the references are rendered with
+	static Options goldenOptions(int scene, accelType accel, int threads) {
+		Options options;
+		options.width = GOLDEN_WIDTH;
+		options.height = GOLDEN_HEIGHT;
+		options.aspectRatio = (float)options.width / (float)options.height;
+		options.sampleNum = GOLDEN_SAMPLES;
+		options.selectScene = scene;
+		options.accelStructure = accel;
+		options.numThreads = threads;
+		options.progressInterval = .0f;
+		return options;
+	}
+
+	// renders built-in scene "scene" at the golden settings and 
+	// returns the RGBA pixels writeImage() would encode. 
+	// stats & seconds -- optional, the render's counters & wall time
+	std::vector<unsigned char> renderScene(int scene, accelType accel,
+		int threads, RenderStats* stats = nullptr, 
+		double* seconds = nullptr) {
+		goldenBackend backend = { accel, BVH_DEFAULT_LAYOUT };
+		return renderScene(scene, backend, threads, stats, seconds);
+	}
+
+	std::vector<unsigned char> renderScene(int scene, 
+		goldenBackend backend, int threads, 
+		RenderStats* stats = nullptr, double* seconds = nullptr) {
+
+		Options options = goldenOptions(scene, backend.accel, threads);
+		Camera cam(options.cameraPos, options.cameraForward, 
+			options.cameraReferUp);
+		std::vector<Object*> objects;
+		std::vector<LightSources*> lights;
+		// buildAccelStructure() only builds the default BVH layout
+		std::unique_ptr<BVH> bvh;
+		Render renderer;
+		renderer.selectScene(objects, lights, scene);
+		if (backend.accel == BVH_ACCEL) {
+			bvh.reset(new BVH(objects, backend.layout));
+			renderer.shareAccelStructure(bvh.get());
+		}
+		else {
+			renderer.buildAccelStructure(objects, backend.accel);
+		}
+
+		std::vector<Color> colorBuffer(options.width * options.height, 
+			options.backgroundColor);
+		std::chrono::steady_clock::time_point start = 
+			std::chrono::steady_clock::now();
+		renderer.renderImage(lights, objects, colorBuffer.data(), 
+			cam, options);
+		if (seconds != nullptr) {
+			*seconds = std::chrono::duration<double>(
+				std::chrono::steady_clock::now() - start).count();
+		}
+		if (stats != nullptr) *stats = renderer.stats;
+		return renderer.toImageData(colorBuffer.data(), 
+			options.width, options.height);
+	}
+
+	static std::string goldenPath(int scene) {
+		return std::string(GOLDEN_IMAGE_DIR) + "scene" + 
+			std::to_string(scene) + ".png";
+	}
+
+	static imageDiff compareImages(const std::vector<unsigned char>& a,
+		const std::vector<unsigned char>& b) {
+
+		imageDiff diff = { .0, .0 };
+		if (a.size() != b.size() || a.empty()) {
+			diff.rmse = diff.badPixels = 1e9;
+			return diff;
+		}
+		double sumSquared = .0;
+		int badPixels = 0;
+		for (size_t i = 0; i < a.size(); i += 4) {
+			bool bad = false;
+			for (int c = 0; c < 3; ++c) {
+				int d = (int)a[i + c] - (int)b[i + c];
+				sumSquared += d * d;
+				bad |= abs(d) > GOLDEN_PIXEL_DIFF;
+			}
+			badPixels += bad;
+		}
+		size_t pixels = a.size() / 4;
+		diff.rmse = sqrt(sumSquared / (pixels * 3));
+		diff.badPixels = (double)badPixels / pixels;
+		return diff;
+	}
+
+	// set to rewrite the references instead of checking them
+	static bool updateGolden() {
+		const char* update = getenv("RAYTRACER_UPDATE_GOLDEN");
+		return update != nullptr && update[0] != '\0' && update[0] != '0';
+	}
+};
+
+// (scene, accel structure)
+class goldenImageTest : public renderTest,
+	public testing::WithParamInterface<std::tuple<int, goldenBackend> > {
+};
\ No newline at end of file
@@ -0,0 +1,32 @@
+#include "pch.h"
+#include <thread>
+#include "../Render_Server/RenderServer.h"
+
+// requests a job can't be allowed to make: frames, sample counts & 
+// thread counts past the caps in RenderServer.h
+TEST(renderRequestTest, rejectsOversizedJobs) {
+	const char* bad[] = {
+		"width=0", "width=16385", "width=4097 height=4097",
+		"samples=0", "samples=65", "samples=100000",
+		"threads=-1", "threads=100000",
+		"fov=180", "format=png", "nonsense=1", "width"
+	};
+	for (const char* args : bad) {
+		RenderRequest request;
+		std::string error;
+		EXPECT_FALSE(request.parse(args, error)) << args;
+		EXPECT_FALSE(error.empty()) << args;
+	}
+}
+
+TEST(renderRequestTest, acceptsJobsWithinCaps) {
+	int cores = (int)std::max(1u, std::thread::hardware_concurrency());
+	RenderRequest request;
+	std::string error;
+	EXPECT_TRUE(request.parse("width=4096 height=4096 samples=64 threads=" + 
+		std::to_string(4 * cores), error)) << error;
+	EXPECT_EQ(request.options.width, 4096);
+	EXPECT_EQ(request.options.sampleNum, 64.0f);
+	EXPECT_EQ(request.options.numThreads, 4 * cores);
+	EXPECT_TRUE(request.parse("threads=0", error)) << error;
+}
\ No newline at end of file
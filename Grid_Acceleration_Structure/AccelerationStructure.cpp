@@ -1,15 +1,102 @@
 #include "AccelerationStructure.h"
+#include "../Render/RenderStats.h"
+#include "../Shapes_and_globals/Instance.h"
 
-AccelerationStructure::AccelerationStructure(std::vector<Object*>& objectList) :
-	objects(/*std::move(*/objectList/*)*/) {
-	// both reference the same vector of objects 
+AccelerationStructure::AccelerationStructure(std::vector<Object*>& objectList) {
+	objects.reserve(objectList.size());
+	for (int i = 0; i < objectList.size(); ++i) {
+		if (objectList[i]->bbox.isUnbounded()) {
+			unbounded.add(objectList[i]);
+		}
+		else {
+			objects.push_back(objectList[i]);
+		}
+	}
 }
 
 AccelerationStructure::~AccelerationStructure()
 {
 }
 
-bool AccelerationStructure::findIntersection()
+void AccelerationStructure::indexObjects() {
+	if (!slotObjects.empty()) return;
+	slotObjects = objects;
+	unbounded.getObjects(slotObjects);
+	slotIsInstance.resize(slotObjects.size());
+	for (int i = 0; i < slotObjects.size(); ++i) {
+		slots[slotObjects[i]] = i;
+		slotIsInstance[i] = dynamic_cast<Instance*>(slotObjects[i]) != nullptr;
+	}
+}
+
+int AccelerationStructure::objectCount() const {
+	return (int)slotObjects.size();
+}
+
+int AccelerationStructure::objectSlot(const Object* object) const {
+	std::unordered_map<const Object*, int>::const_iterator it = 
+		slots.find(object);
+	return it != slots.end() ? it->second : -1;
+}
+
+Object* AccelerationStructure::objectAt(int slot) const {
+	return slotObjects[slot];
+}
+
+bool AccelerationStructure::isInstanceAt(int slot) const {
+	return slotIsInstance[slot] != 0;
+}
+
+bool AccelerationStructure::findIntersection(glm::vec3 orig, 
+	glm::vec3 dir, float& tNear, int& index, glm::vec2& uv, 
+	Object** hitObject) const
 {
+	unbounded.findIntersection(orig, dir, tNear, index, uv, hitObject);
+	TraversalStats stats;
+	stats.primitives((int)objects.size());
+	int indexK;
+	glm::vec2 uvK;
+	for (int k = 0; k < objects.size(); k++) {
+		float tCurrNearest = FLT_MAX;
+		if (objects[k]->findIntersection(orig, dir, tCurrNearest, indexK, uvK)
+			&& tCurrNearest < tNear) {
+			tNear = tCurrNearest;
+			index = indexK;
+			*hitObject = objects[k];
+			uv = uvK;
+		}
+	}
+	return (*hitObject != nullptr);
+}
+
+bool AccelerationStructure::occluded(glm::vec3 orig, glm::vec3 dir, 
+	float tMax) const
+{
+	if (unbounded.occluded(orig, dir, tMax)) return true;
+	TraversalStats stats;
+	int index;
+	glm::vec2 uv;
+	for (int k = 0; k < objects.size(); k++) {
+		float t = FLT_MAX;
+		stats.primitives(1);
+		if (objects[k]->findIntersection(orig, dir, t, index, uv)
+			&& t < tMax) {
+			return true;
+		}
+	}
 	return false;
+}
+
+bool AccelerationStructure::refit()
+{
+	return true;
+}
+
+Bbox AccelerationStructure::getBounds() const
+{
+	Bbox bounds = unbounded.getBounds();
+	for (int k = 0; k < objects.size(); k++) {
+		bounds.extendBy(objects[k]->bbox);
+	}
+	return bounds;
 }
\ No newline at end of file
@@ -2,22 +2,72 @@
 #define _ACCELERATION_STRUCTURE_H_
 
 #include <vector>
+#include <unordered_map>
 #include "../Shapes_and_globals/Object.h"
+#include "UnboundedSet.h"
+
+// the acceleration structures that can be built over a scene
+enum accelType { NO_ACCEL, BVH_ACCEL, KDTREE_ACCEL, GRID_ACCEL };
 
 class AccelerationStructure {
 private: 
-	
+	// see indexObjects()
+	std::vector<Object*> slotObjects;
+	std::vector<char> slotIsInstance;
+	std::unordered_map<const Object*, int> slots;
 
 public: 
 
+	// objects with infinite bounds go into "unbounded", the rest 
+	// into "objects" which the derived structures are built over
 	AccelerationStructure(std::vector<Object*>& objectList);
 
-	~AccelerationStructure();
+	virtual ~AccelerationStructure();
+
+	// Finds the closest object intersected by the ray. The base class
+	// simply tests every object (same as Render::trace). Every
+	// implementation tests the unbounded set first
+	// tNear -- closest distance found so far (FLT_MAX if none), 
+	// only overwritten by closer hits
+	// index, uv -- as reported by the intersected primitive
+	// hitObject -- stores pointer to the closest object encountered
+	virtual bool findIntersection(glm::vec3 orig, glm::vec3 dir,
+		float& tNear, int& index, glm::vec2& uv, 
+		Object** hitObject) const;
+
+	// Occlusion query: returns true as soon as any object is hit 
+	// closer than tMax (doesn't look for the closest one)
+	virtual bool occluded(glm::vec3 orig, glm::vec3 dir, 
+		float tMax) const;
 
-	virtual bool findIntersection();
+	// bounds of all the objects held in the structure
+	// (infinite if it holds unbounded ones)
+	virtual Bbox getBounds() const;
+
+	// Updates the structure after objects moved (their bboxes changed, 
+	// none added or removed). Returns false when it can't, or the 
+	// result would trace too slowly, and has to be rebuilt instead. 
+	// The plain object list has nothing to update
+	virtual bool refit();
+
+	// Numbers every object in the structure, so an Instance of it can 
+	// report the prototype object it hit as a slot and shade that 
+	// object straight away. Instances call it when they're created, 
+	// before any rendering; the numbering is kept after that
+	void indexObjects();
+	int objectCount() const;
+	// the object's slot, -1 if it isn't in the structure
+	int objectSlot(const Object* object) const;
+	Object* objectAt(int slot) const;
+	// true if the object in the slot is an Instance itself
+	bool isInstanceAt(int slot) const;
 
 	// vector of meshes/objects  
 	// passed into accel structure to iterate thru
+	// (the ones with finite bounds)
 	std::vector<Object*> objects;
+
+	// planes etc. tested outside the bounded structure
+	UnboundedSet unbounded;
 };
 #endif
\ No newline at end of file
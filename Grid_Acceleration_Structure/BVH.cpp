@@ -0,0 +1,469 @@
+#include "BVH.h"
+#include "../Render/RenderStats.h"
+#include <algorithm>
+#include <new>
+
+// surface area of the box spanned by lower & upper, infinite 
+// boxes (planes) come out as FLT_MAX so they're never preferred
+static float surfaceArea(const glm::vec3& lower, const glm::vec3& upper) {
+	glm::vec3 d = upper - lower;
+	float area = 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+	return (area >= .0f && area < FLT_MAX) ? area : FLT_MAX;
+}
+
+// the value of quantized step q inside [parentLower, parentLower + 
+// BVH_QUANTIZE_MAX * step], shared by the encoder and the traversal 
+// so the rounding is identical in both
+static inline float dequantize(float parentLower, float step, int q) {
+	return parentLower + step * (float)q;
+}
+
+BVH::BVH(std::vector<Object*>& objs, bvhNodeLayout nodeLayout) : 
+	AccelerationStructure(objs), layout(nodeLayout),
+	quantizedNodes(nullptr), quantizedCount(0), builtCost(.0f) {
+	if (objects.empty()) return;
+	// a binary tree with n leaves has at most 2n - 1 nodes
+	nodes.reserve(2 * objects.size());
+	build(0, (int)objects.size(), 0);
+	builtCost = sahCost();
+
+	if (layout == BVH_QUANTIZED_NODES) {
+		quantizedCount = (int)nodes.size();
+		quantizedNodes = static_cast<QuantizedNode*>(::operator new(
+			sizeof(QuantizedNode) * quantizedCount, 
+			std::align_val_t(BVH_CACHE_LINE)));
+		rootLower = glm::max(nodes[0].lower, glm::vec3(-BVH_QUANTIZE_LIMIT));
+		rootUpper = glm::min(nodes[0].upper, glm::vec3(BVH_QUANTIZE_LIMIT));
+		quantize(0, rootLower, rootUpper);
+		// only the quantized copy is kept
+		std::vector<Node>().swap(nodes);
+	}
+}
+
+BVH::~BVH() {
+	if (quantizedNodes != nullptr) {
+		::operator delete(quantizedNodes, std::align_val_t(BVH_CACHE_LINE));
+	}
+}
+
+int BVH::build(int start, int end, int depth) {
+	int nodeIdx = (int)nodes.size();
+	nodes.push_back(Node());
+
+	// bounds of all objects in this node, and the bounds of their 
+	// centroids which we use to choose a split axis
+	glm::vec3 lower(FLT_MAX), upper(-FLT_MAX);
+	glm::vec3 cLower(FLT_MAX), cUpper(-FLT_MAX);
+	for (int i = start; i < end; ++i) {
+		glm::vec3 objLower = objects[i]->bbox.getLower();
+		glm::vec3 objUpper = objects[i]->bbox.getUpper();
+		glm::vec3 centroid = (objLower + objUpper) * 0.5f;
+		lower = glm::min(lower, objLower);
+		upper = glm::max(upper, objUpper);
+		cLower = glm::min(cLower, centroid);
+		cUpper = glm::max(cUpper, centroid);
+	}
+	nodes[nodeIdx].lower = lower;
+	nodes[nodeIdx].upper = upper;
+
+	int count = end - start;
+	glm::vec3 extent = cUpper - cLower;
+	int axis = 0;
+	if (extent.y > extent.x) axis = 1;
+	if (extent.z > extent[axis]) axis = 2;
+
+	// small enough, or all the centroids coincide: make a leaf
+	// (as long as the count fits the node)
+	bool fitsLeaf = count <= UINT16_MAX;
+	if (count <= BVH_MAX_LEAF_SIZE || (fitsLeaf && 
+		(extent[axis] <= .0f || depth >= BVH_MAX_DEPTH))) {
+		nodes[nodeIdx].offset = start;
+		nodes[nodeIdx].count = (uint16_t)count;
+		nodes[nodeIdx].axis = (uint8_t)axis;
+		return nodeIdx;
+	}
+
+	// Binned SAH: drop the centroids into buckets along the axis and
+	// evaluate the cost of splitting after each bucket
+	int binCount[BVH_NUM_BINS] = { 0 };
+	glm::vec3 binLower[BVH_NUM_BINS], binUpper[BVH_NUM_BINS];
+	for (int b = 0; b < BVH_NUM_BINS; ++b) {
+		binLower[b] = glm::vec3(FLT_MAX);
+		binUpper[b] = glm::vec3(-FLT_MAX);
+	}
+	float binScale = extent[axis] > .0f ? BVH_NUM_BINS / extent[axis] : .0f;
+	for (int i = start; i < end; ++i) {
+		glm::vec3 objLower = objects[i]->bbox.getLower();
+		glm::vec3 objUpper = objects[i]->bbox.getUpper();
+		float c = (objLower[axis] + objUpper[axis]) * 0.5f;
+		int b = std::min(BVH_NUM_BINS - 1, (int)((c - cLower[axis]) * binScale));
+		binCount[b]++;
+		binLower[b] = glm::min(binLower[b], objLower);
+		binUpper[b] = glm::max(binUpper[b], objUpper);
+	}
+
+	float bestCost = FLT_MAX;
+	int bestBin = -1;
+	for (int split = 0; split < BVH_NUM_BINS - 1; ++split) {
+		glm::vec3 l0(FLT_MAX), u0(-FLT_MAX), l1(FLT_MAX), u1(-FLT_MAX);
+		int n0 = 0, n1 = 0;
+		for (int b = 0; b <= split; ++b) {
+			if (binCount[b] == 0) continue;
+			l0 = glm::min(l0, binLower[b]);
+			u0 = glm::max(u0, binUpper[b]);
+			n0 += binCount[b];
+		}
+		for (int b = split + 1; b < BVH_NUM_BINS; ++b) {
+			if (binCount[b] == 0) continue;
+			l1 = glm::min(l1, binLower[b]);
+			u1 = glm::max(u1, binUpper[b]);
+			n1 += binCount[b];
+		}
+		if (n0 == 0 || n1 == 0) continue;
+		float cost = surfaceArea(l0, u0) * n0 + surfaceArea(l1, u1) * n1;
+		if (cost < bestCost) {
+			bestCost = cost;
+			bestBin = split;
+		}
+	}
+
+	int mid;
+	if (bestBin >= 0) {
+		std::vector<Object*>::iterator midIt = std::partition(
+			objects.begin() + start, objects.begin() + end,
+			[&](Object* obj) {
+				float c = (obj->bbox.getLower()[axis] + obj->bbox.getUpper()[axis]) * 0.5f;
+				int b = std::min(BVH_NUM_BINS - 1, (int)((c - cLower[axis]) * binScale));
+				return b <= bestBin;
+			});
+		mid = (int)(midIt - objects.begin());
+	}
+	else {
+		// every split had an infinite cost (e.g. planes everywhere),
+		// fall back to splitting at the median centroid
+		mid = (start + end) / 2;
+		std::nth_element(objects.begin() + start, 
+			objects.begin() + mid, objects.begin() + end,
+			[axis](Object* a, Object* b) {
+				return (a->bbox.getLower()[axis] + a->bbox.getUpper()[axis]) <
+					(b->bbox.getLower()[axis] + b->bbox.getUpper()[axis]);
+			});
+	}
+
+	// first child directly follows this node, second child's index
+	// is stored in offset
+	build(start, mid, depth + 1);
+	int secondChild = build(mid, end, depth + 1);
+	nodes[nodeIdx].offset = secondChild;
+	nodes[nodeIdx].count = 0;
+	nodes[nodeIdx].axis = (uint8_t)axis;
+	return nodeIdx;
+}
+
+void BVH::quantize(int idx, glm::vec3 parentLower, glm::vec3 parentUpper) {
+	const Node& node = nodes[idx];
+	QuantizedNode& qNode = quantizedNodes[idx];
+	qNode.offset = node.offset;
+	qNode.count = node.count;
+	qNode.axis = node.axis;
+
+	glm::vec3 lower = glm::max(node.lower, glm::vec3(-BVH_QUANTIZE_LIMIT));
+	glm::vec3 upper = glm::min(node.upper, glm::vec3(BVH_QUANTIZE_LIMIT));
+	glm::vec3 decodedLower, decodedUpper;
+	for (int i = 0; i < 3; ++i) {
+		float step = (parentUpper[i] - parentLower[i]) / BVH_QUANTIZE_MAX;
+		int qLo = 0, qHi = BVH_QUANTIZE_MAX;
+		if (step > .0f) {
+			qLo = (int)floorf((lower[i] - parentLower[i]) / step);
+			qHi = (int)ceilf((upper[i] - parentLower[i]) / step);
+			qLo = std::max(0, std::min(BVH_QUANTIZE_MAX, qLo));
+			qHi = std::max(0, std::min(BVH_QUANTIZE_MAX, qHi));
+			// rounding in the decode could still shave off a 
+			// sliver, step outwards until the box is conservative
+			while (qLo > 0 && dequantize(parentLower[i], step, qLo) > lower[i]) qLo--;
+			while (qHi < BVH_QUANTIZE_MAX && dequantize(parentLower[i], step, qHi) < upper[i]) qHi++;
+		}
+		qNode.qLower[i] = (bvhQuantized)qLo;
+		qNode.qUpper[i] = (bvhQuantized)qHi;
+		decodedLower[i] = dequantize(parentLower[i], step, qLo);
+		decodedUpper[i] = dequantize(parentLower[i], step, qHi);
+	}
+
+	if (node.count == 0) {
+		quantize(idx + 1, decodedLower, decodedUpper);
+		quantize(node.offset, decodedLower, decodedUpper);
+	}
+}
+
+bool BVH::findIntersection(glm::vec3 orig, glm::vec3 dir,
+	float& tNear, int& index, glm::vec2& uv,
+	Object** hitObject) const {
+
+	// planes first, a hit there clips tNear before the traversal
+	unbounded.findIntersection(orig, dir, tNear, index, uv, hitObject);
+	if (layout == BVH_QUANTIZED_NODES) {
+		return findIntersectionQuantized(orig, dir, tNear, index, uv, hitObject);
+	}
+	if (nodes.empty()) return (*hitObject != nullptr);
+
+	glm::vec3 inverseDir = 1.0f / dir;
+	TraversalStats stats;
+	int stack[BVH_STACK_SIZE];
+	int stackSize = 0;
+	int current = 0;
+	int indexK;
+	glm::vec2 uvK;
+	float tEnter;
+	while (1) {
+		const Node& node = nodes[current];
+		stats.node();
+		// tNear shrinks as we find hits, culling nodes behind them
+		if (Bbox::intersectRange(node.lower, node.upper, 
+			orig, inverseDir, tNear, tEnter)) {
+			if (node.count > 0) {
+				stats.primitives(node.count);
+				for (int i = node.offset; i < node.offset + node.count; ++i) {
+					float tCurrNearest = FLT_MAX;
+					if (objects[i]->findIntersection(orig, dir, tCurrNearest, indexK, uvK)
+						&& tCurrNearest < tNear) {
+						tNear = tCurrNearest;
+						index = indexK;
+						uv = uvK;
+						*hitObject = objects[i];
+					}
+				}
+				if (stackSize == 0) break;
+				current = stack[--stackSize];
+			}
+			else if (inverseDir[node.axis] < .0f) {
+				// ray travels down the split axis: 2nd child is closer
+				stack[stackSize++] = current + 1;
+				current = node.offset;
+			}
+			else {
+				stack[stackSize++] = node.offset;
+				current = current + 1;
+			}
+		}
+		else {
+			if (stackSize == 0) break;
+			current = stack[--stackSize];
+		}
+	}
+	return (*hitObject != nullptr);
+}
+
+bool BVH::occluded(glm::vec3 orig, glm::vec3 dir, float tMax) const {
+	if (unbounded.occluded(orig, dir, tMax)) return true;
+	if (layout == BVH_QUANTIZED_NODES) {
+		return occludedQuantized(orig, dir, tMax);
+	}
+	if (nodes.empty()) return false;
+
+	glm::vec3 inverseDir = 1.0f / dir;
+	TraversalStats stats;
+	int stack[BVH_STACK_SIZE];
+	int stackSize = 0;
+	int current = 0;
+	int index;
+	glm::vec2 uv;
+	float tEnter;
+	while (1) {
+		const Node& node = nodes[current];
+		stats.node();
+		if (Bbox::intersectRange(node.lower, node.upper, 
+			orig, inverseDir, tMax, tEnter)) {
+			if (node.count > 0) {
+				for (int i = node.offset; i < node.offset + node.count; ++i) {
+					float t = FLT_MAX;
+					stats.primitives(1);
+					if (objects[i]->findIntersection(orig, dir, t, index, uv)
+						&& t < tMax) {
+						return true;
+					}
+				}
+				if (stackSize == 0) break;
+				current = stack[--stackSize];
+			}
+			else {
+				stack[stackSize++] = node.offset;
+				current = current + 1;
+			}
+		}
+		else {
+			if (stackSize == 0) break;
+			current = stack[--stackSize];
+		}
+	}
+	return false;
+}
+
+// Quantized traversal: same as above, but each stack entry also 
+// carries the decoded box of the node's parent, which the node's 
+// quantized bounds are relative to
+struct QuantizedStackEntry {
+	int node;
+	glm::vec3 parentLower;
+	glm::vec3 parentUpper;
+};
+
+bool BVH::findIntersectionQuantized(glm::vec3 orig, glm::vec3 dir,
+	float& tNear, int& index, glm::vec2& uv,
+	Object** hitObject) const {
+
+	if (quantizedCount == 0) return (*hitObject != nullptr);
+
+	glm::vec3 inverseDir = 1.0f / dir;
+	TraversalStats stats;
+	QuantizedStackEntry stack[BVH_STACK_SIZE];
+	int stackSize = 0;
+	stack[stackSize++] = { 0, rootLower, rootUpper };
+	int indexK;
+	glm::vec2 uvK;
+	float tEnter;
+	while (stackSize > 0) {
+		QuantizedStackEntry entry = stack[--stackSize];
+		const QuantizedNode& node = quantizedNodes[entry.node];
+		stats.node();
+		glm::vec3 lower, upper;
+		for (int i = 0; i < 3; ++i) {
+			float step = (entry.parentUpper[i] - entry.parentLower[i]) / BVH_QUANTIZE_MAX;
+			lower[i] = dequantize(entry.parentLower[i], step, node.qLower[i]);
+			upper[i] = dequantize(entry.parentLower[i], step, node.qUpper[i]);
+		}
+		if (!Bbox::intersectRange(lower, upper, orig, inverseDir, tNear, tEnter)) {
+			continue;
+		}
+		if (node.count > 0) {
+			stats.primitives(node.count);
+			for (int i = node.offset; i < node.offset + node.count; ++i) {
+				float tCurrNearest = FLT_MAX;
+				if (objects[i]->findIntersection(orig, dir, tCurrNearest, indexK, uvK)
+					&& tCurrNearest < tNear) {
+					tNear = tCurrNearest;
+					index = indexK;
+					uv = uvK;
+					*hitObject = objects[i];
+				}
+			}
+		}
+		else if (inverseDir[node.axis] < .0f) {
+			// 2nd child is closer, push it last so it's popped first
+			stack[stackSize++] = { entry.node + 1, lower, upper };
+			stack[stackSize++] = { node.offset, lower, upper };
+		}
+		else {
+			stack[stackSize++] = { node.offset, lower, upper };
+			stack[stackSize++] = { entry.node + 1, lower, upper };
+		}
+	}
+	return (*hitObject != nullptr);
+}
+
+bool BVH::occludedQuantized(glm::vec3 orig, glm::vec3 dir, 
+	float tMax) const {
+
+	if (quantizedCount == 0) return false;
+
+	glm::vec3 inverseDir = 1.0f / dir;
+	TraversalStats stats;
+	QuantizedStackEntry stack[BVH_STACK_SIZE];
+	int stackSize = 0;
+	stack[stackSize++] = { 0, rootLower, rootUpper };
+	int index;
+	glm::vec2 uv;
+	float tEnter;
+	while (stackSize > 0) {
+		QuantizedStackEntry entry = stack[--stackSize];
+		const QuantizedNode& node = quantizedNodes[entry.node];
+		stats.node();
+		glm::vec3 lower, upper;
+		for (int i = 0; i < 3; ++i) {
+			float step = (entry.parentUpper[i] - entry.parentLower[i]) / BVH_QUANTIZE_MAX;
+			lower[i] = dequantize(entry.parentLower[i], step, node.qLower[i]);
+			upper[i] = dequantize(entry.parentLower[i], step, node.qUpper[i]);
+		}
+		if (!Bbox::intersectRange(lower, upper, orig, inverseDir, tMax, tEnter)) {
+			continue;
+		}
+		if (node.count > 0) {
+			for (int i = node.offset; i < node.offset + node.count; ++i) {
+				float t = FLT_MAX;
+				stats.primitives(1);
+				if (objects[i]->findIntersection(orig, dir, t, index, uv)
+					&& t < tMax) {
+					return true;
+				}
+			}
+		}
+		else {
+			stack[stackSize++] = { node.offset, lower, upper };
+			stack[stackSize++] = { entry.node + 1, lower, upper };
+		}
+	}
+	return false;
+}
+
+Bbox BVH::getBounds() const {
+	Bbox bounds = unbounded.getBounds();
+	if (layout == BVH_QUANTIZED_NODES) {
+		if (quantizedCount == 0) return bounds;
+		bounds.extendBy(rootLower);
+		bounds.extendBy(rootUpper);
+		return bounds;
+	}
+	if (nodes.empty()) return bounds;
+	bounds.extendBy(nodes[0].lower);
+	bounds.extendBy(nodes[0].upper);
+	return bounds;
+}
+
+float BVH::sahCost() const {
+	float rootArea = surfaceArea(nodes[0].lower, nodes[0].upper);
+	if (rootArea <= .0f || rootArea == FLT_MAX) return .0f;
+	// interior nodes cost a box test, leaves a test per object
+	float cost = .0f;
+	for (int i = 0; i < nodes.size(); ++i) {
+		float area = surfaceArea(nodes[i].lower, nodes[i].upper);
+		cost += area * (nodes[i].count > 0 ? nodes[i].count : 1);
+	}
+	return cost / rootArea;
+}
+
+bool BVH::refit() {
+	if (layout == BVH_QUANTIZED_NODES) return quantizedCount == 0;
+	// children always come after their parent, so walking backwards 
+	// sees both children of a node before the node
+	for (int i = (int)nodes.size() - 1; i >= 0; --i) {
+		Node& node = nodes[i];
+		glm::vec3 lower(FLT_MAX), upper(-FLT_MAX);
+		if (node.count > 0) {
+			for (int k = node.offset; k < node.offset + node.count; ++k) {
+				lower = glm::min(lower, objects[k]->bbox.getLower());
+				upper = glm::max(upper, objects[k]->bbox.getUpper());
+			}
+		}
+		else {
+			lower = glm::min(nodes[i + 1].lower, nodes[node.offset].lower);
+			upper = glm::max(nodes[i + 1].upper, nodes[node.offset].upper);
+		}
+		node.lower = lower;
+		node.upper = upper;
+	}
+	return nodes.empty() || sahCost() <= builtCost * BVH_REFIT_MAX_COST;
+}
+
+int BVH::getNodeCount() const {
+	return layout == BVH_QUANTIZED_NODES ? quantizedCount : (int)nodes.size();
+}
+
+bvhNodeLayout BVH::getLayout() const {
+	return layout;
+}
+
+size_t BVH::getMemoryUsage() const {
+	size_t nodeBytes = layout == BVH_QUANTIZED_NODES ?
+		sizeof(QuantizedNode) * quantizedCount :
+		sizeof(Node) * nodes.size();
+	return nodeBytes + sizeof(Object*) * objects.size();
+}
\ No newline at end of file
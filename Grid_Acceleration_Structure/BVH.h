@@ -0,0 +1,131 @@
+#ifndef _BVH_H_
+#define _BVH_H_
+
+#include <stdint.h>
+#include "AccelerationStructure.h"
+#include "Bbox.h"
+
+#define BVH_MAX_LEAF_SIZE 4 // objects per leaf before we try to split
+#define BVH_NUM_BINS 12 // buckets used to evaluate the SAH splits
+#define BVH_MAX_DEPTH 60 // keeps the traversal stack from overflowing
+#define BVH_STACK_SIZE 128
+#define BVH_CACHE_LINE 64 // node arrays start on a cache line
+// a refitted tree whose SAH cost grew past this factor of the 
+// freshly built one's is rebuilt instead
+#define BVH_REFIT_MAX_COST 1.5f
+
+// Compile with BVH_COMPRESSED_NODES (cmake -DRAYTRACER_BVH_COMPRESSED=ON) 
+// to make the renderer use the quantized node layout, 
+// BVH_QUANTIZE_BITS picks 8 or 16 bit bounds
+#ifndef BVH_QUANTIZE_BITS
+#define BVH_QUANTIZE_BITS 8
+#endif
+#if BVH_QUANTIZE_BITS == 16
+typedef uint16_t bvhQuantized;
+#else
+typedef uint8_t bvhQuantized;
+#endif
+#define BVH_QUANTIZE_MAX ((1 << BVH_QUANTIZE_BITS) - 1)
+// huge bounds are clamped to this before quantizing (infinite ones
+// never get here, they go to the UnboundedSet)
+#define BVH_QUANTIZE_LIMIT 1.0e18f
+
+enum bvhNodeLayout { BVH_FLOAT_NODES, BVH_QUANTIZED_NODES };
+
+#ifdef BVH_COMPRESSED_NODES
+#define BVH_DEFAULT_LAYOUT BVH_QUANTIZED_NODES
+#else
+#define BVH_DEFAULT_LAYOUT BVH_FLOAT_NODES
+#endif
+
+// Bounding volume hierarchy over the objects passed in. Since an 
+// Instance is an Object too, a BVH built over instances (each 
+// pointing to a shared BVH of their own geometry) gives a 
+// two-level structure
+class BVH : public AccelerationStructure {
+	// Nodes are flattened depth first: an interior node's first child
+	// is the next node in the array, its second child sits at "offset".
+	// A leaf holds "count" objects starting at objects[offset]
+	struct alignas(32) Node {
+		glm::vec3 lower;
+		glm::vec3 upper;
+		int32_t offset;
+		uint16_t count; // 0 for interior nodes
+		uint8_t axis; // split axis, picks which child to visit first
+	};
+
+	// Same tree, but the box is stored in BVH_QUANTIZE_BITS steps 
+	// of the parent's (decoded) box, rounded outwards so it always 
+	// contains the real one. 16 bytes with 8 bit bounds, 32 with 16,
+	// so a node never straddles a cache line
+	struct alignas(BVH_QUANTIZE_BITS == 16 ? 32 : 16) QuantizedNode {
+		int32_t offset;
+		uint16_t count;
+		bvhQuantized qLower[3];
+		bvhQuantized qUpper[3];
+		uint8_t axis;
+	};
+private:
+	bvhNodeLayout layout;
+	std::vector<Node> nodes;
+
+	// quantized copy of nodes (which is then freed), cache line aligned
+	QuantizedNode* quantizedNodes;
+	int quantizedCount;
+	// quantized nodes are relative to the root box
+	glm::vec3 rootLower, rootUpper;
+	// SAH cost right after the build, what refit() compares against
+	float builtCost;
+
+	// expected cost of tracing a ray through the float nodes, 
+	// relative to the root box
+	float sahCost() const;
+
+	// recursively builds the node for objects[start, end) and 
+	// returns its index in the nodes array
+	int build(int start, int end, int depth);
+
+	// encodes nodes[idx] (and its subtree) relative to the parent 
+	// box, the decoded box is used as the parent of its children
+	void quantize(int idx, glm::vec3 parentLower, glm::vec3 parentUpper);
+
+	// traversals of the bounded part, called after the unbounded 
+	// set has had its go (hitObject/tNear already set by it)
+	bool findIntersectionQuantized(glm::vec3 orig, glm::vec3 dir,
+		float& tNear, int& index, glm::vec2& uv,
+		Object** hitObject) const;
+
+	bool occludedQuantized(glm::vec3 orig, glm::vec3 dir, 
+		float tMax) const;
+
+public:
+	BVH(std::vector<Object*>& objs, 
+		bvhNodeLayout nodeLayout = BVH_DEFAULT_LAYOUT);
+
+	~BVH();
+
+	// owns the aligned node array
+	BVH(const BVH&) = delete;
+	BVH& operator=(const BVH&) = delete;
+
+	bool findIntersection(glm::vec3 orig, glm::vec3 dir,
+		float& tNear, int& index, glm::vec2& uv,
+		Object** hitObject) const;
+
+	bool occluded(glm::vec3 orig, glm::vec3 dir, float tMax) const;
+
+	Bbox getBounds() const;
+
+	// Recomputes the float node boxes bottom up, keeping the tree. 
+	// The quantized layout (its float nodes are gone) and trees whose 
+	// SAH cost grew past BVH_REFIT_MAX_COST want a rebuild
+	bool refit();
+
+	int getNodeCount() const;
+
+	bvhNodeLayout getLayout() const;
+
+	// bytes taken by the nodes and the object pointer array
+	size_t getMemoryUsage() const;
+};
+#endif
\ No newline at end of file
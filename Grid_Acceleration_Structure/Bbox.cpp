@@ -16,7 +16,7 @@ Bbox::Bbox(glm::vec3 minBound, glm::vec3 maxBound) :
 // increases the grid's size accordingly by merging
 // all the scene's object's bounding boxes -- iterates thru 
 // every one of them to do so
-Bbox& Bbox::extendBy(glm::vec3& Pt) {
+Bbox& Bbox::extendBy(const glm::vec3& Pt) {
     // we do infinity checks for x and z axis to filter out
     // finite bounds for infinite planes
 
@@ -118,8 +118,34 @@ bool Bbox::findIntersection(glm::vec3 orig, glm::vec3 dir, float& tNear) {
     return true;
 }
 
+// merges another box in by extending with both of its corners
+Bbox& Bbox::extendBy(const Bbox& box) {
+    extendBy(box.minBounds);
+    extendBy(box.maxBounds);
+    return *this;
+}
+
 glm::vec3 Bbox::getCentroid()
 {
     return (maxBounds + minBounds) * 0.5f;
+}
+
+glm::vec3 Bbox::getLower() const
+{
+    return glm::vec3(minBounds.x, minBounds.y, maxBounds.z);
+}
+
+glm::vec3 Bbox::getUpper() const
+{
+    return glm::vec3(maxBounds.x, maxBounds.y, minBounds.z);
 }           
 
+
+
+bool Bbox::isUnbounded() const {
+	glm::vec3 lower = getLower(), upper = getUpper();
+	for (int i = 0; i < 3; ++i) {
+		if (lower[i] <= -FLT_MAX || upper[i] >= FLT_MAX) return true;
+	}
+	return false;
+}
\ No newline at end of file
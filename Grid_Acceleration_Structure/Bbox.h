@@ -20,7 +20,10 @@ public:
 	
 	// increases the grid's size accordingly by merging
 	// all the scene's object's bounding boxes
-	Bbox& extendBy(glm::vec3& Pt);
+	Bbox& extendBy(const glm::vec3& Pt);
+
+	// merges another bounding box into this one
+	Bbox& extendBy(const Bbox& box);
 
 	// Ray box intersection routine same as in Box class
 	bool findIntersection(glm::vec3 orig, glm::vec3 dir, float& tNear);
@@ -28,6 +31,47 @@ public:
 	// get centroid function?
 	glm::vec3 getCentroid();
 
+	// minBounds/maxBounds store z flipped (the eye faces -z), these
+	// return the plain componentwise smallest & largest corners
+	glm::vec3 getLower() const;
+	glm::vec3 getUpper() const;
+
+	// true if the box stretches to infinity along any axis (planes)
+	bool isUnbounded() const;
+
+	// Slab test used by the traversal routines: unlike findIntersection
+	// it also accepts rays starting inside the box. 
+	// lower/upper -- plain min & max corners (see getLower/getUpper)
+	// inverseDir -- 1 / ray direction
+	// tMax -- hits beyond this distance are ignored
+	// tEnter (output) -- distance the ray enters the box (0 if inside)
+	// tExit (output) -- distance it leaves the box (at most tMax)
+	static bool intersectRange(const glm::vec3& lower, 
+		const glm::vec3& upper, const glm::vec3& orig, 
+		const glm::vec3& inverseDir, float tMax, float& tEnter, 
+		float& tExit) {
+		float t0 = .0f, t1 = tMax;
+		for (int i = 0; i < 3; ++i) {
+			float tNearSlab = (lower[i] - orig[i]) * inverseDir[i];
+			float tFarSlab = (upper[i] - orig[i]) * inverseDir[i];
+			if (tNearSlab > tFarSlab) std::swap(tNearSlab, tFarSlab);
+			t0 = tNearSlab > t0 ? tNearSlab : t0;
+			t1 = tFarSlab < t1 ? tFarSlab : t1;
+			if (t0 > t1) return false;
+		}
+		tEnter = t0;
+		tExit = t1;
+		return true;
+	}
+
+	static bool intersectRange(const glm::vec3& lower, 
+		const glm::vec3& upper, const glm::vec3& orig, 
+		const glm::vec3& inverseDir, float tMax, float& tEnter) {
+		float tExit;
+		return intersectRange(lower, upper, orig, inverseDir, 
+			tMax, tEnter, tExit);
+	}
+
 };
 
 #endif
\ No newline at end of file
@@ -1,243 +1,330 @@
 #include "Grid.h"
+#include "../Render/RenderStats.h"
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// number of set bits, i.e. occupied cells in (part of) a mask word
+static inline int popcount64(uint64_t bits) {
+#ifdef _MSC_VER
+	return (int)__popcnt64(bits);
+#else
+	return __builtin_popcountll(bits);
+#endif
+}
+
+Grid::Grid(std::vector<Object*>& objs) : AccelerationStructure(objs) {
+	if (objects.empty()) return;
 
-Grid::Grid(std::vector<Object*>& objs, std::vector<LightSources*>& lights) :
-	AccelerationStructure(objs) {
 	// determine the bounds of the grid by iterating
 	// thru all scene objects and expanding its bounds accordingly
-	// USE extendBy for each object iterated thru
+	// (planes are already filtered out into the unbounded set)
+	Bbox bounds;
+	objLower.resize(objects.size());
+	objUpper.resize(objects.size());
+	std::vector<int> objIndices(objects.size());
 	for (int i = 0; i < objects.size(); ++i) {
-		// keeps enlarging the grid until it perfectly 
-		// encapsulates every geometry
-		if (typeid(*objects[i]) == typeid(Plane)) continue;
-		gridBbox.extendBy(objects[i]->bbox.minBounds);
-		gridBbox.extendBy(objects[i]->bbox.maxBounds);
-		
-		// print out the values
-		//std::cout << "current Object Bbox: " << std::endl;
-		//std::cout << objects[i]->bbox.minBounds.x << " " << objects[i]->bbox.minBounds.y << " " << objects[i]->bbox.minBounds.z << " " << std::endl;
-		//std::cout << objects[i]->bbox.maxBounds.x << " " << objects[i]->bbox.maxBounds.y << " " << objects[i]->bbox.maxBounds.z << " " << std::endl;
-		//std::cout << "grid Bbox Object: " << std::endl;
-		std::cout << gridBbox.minBounds.x << " " << gridBbox.minBounds.y << " " << gridBbox.minBounds.z << " " << std::endl;
-		std::cout << gridBbox.maxBounds.x << " " << gridBbox.maxBounds.y << " " << gridBbox.maxBounds.z << " " << std::endl;
+		objLower[i] = objects[i]->bbox.getLower();
+		objUpper[i] = objects[i]->bbox.getUpper();
+		bounds.extendBy(objects[i]->bbox);
+		objIndices[i] = i;
 	}
+	// pad the bounds a little so flat scenes (e.g. a single rect)
+	// still have a volume to divide
+	glm::vec3 size = bounds.getUpper() - bounds.getLower();
+	float pad = 1e-4f * std::max(size.x, std::max(size.y, size.z)) + 1e-6f;
+	gridLower = bounds.getLower() - glm::vec3(pad);
+	gridUpper = bounds.getUpper() + glm::vec3(pad);
+
+	buildLevel(gridLower, gridUpper, objIndices, 0);
+
+	// boxes aren't needed once the grid is built
+	std::vector<glm::vec3>().swap(objLower);
+	std::vector<glm::vec3>().swap(objUpper);
+}
+
+Grid::~Grid() {
+}
+
+int Grid::clamp(const int& lo, const int& hi, const int& v) const {
+	return std::max(lo, std::min(hi, v));
+}
 
-	// 1. Determining grid size
-	// 2. Determine the sub-division
-	// dimensions by finding cellDimensions, resolution, size, 
-	glm::vec3 diff = gridBbox.maxBounds - gridBbox.minBounds;
-	glm::vec3 size;
-	//int resolution[3];
-	int lambda = 5;
-	for (int j = 0; j < 3; ++j) {
-		size[j] = fabsf(diff[j]); 
-		resolution[j] = 5;
+int Grid::buildLevel(glm::vec3 lower, glm::vec3 upper,
+	const std::vector<int>& objs, int depth) {
+
+	int levelIdx = (int)levels.size();
+	levels.push_back(Level());
+
+	// 1. Determine the sub-division from the object density:
+	// res = size * cbrt(lambda * N / V) on each axis
+	Level level;
+	glm::vec3 size = upper - lower;
+	float cellsPerUnit = cbrtf(GRID_DENSITY * objs.size() / 
+		(size.x * size.y * size.z));
+	int maxResolution = depth == 0 ? 
+		GRID_MAX_RESOLUTION : GRID_MAX_SUB_RESOLUTION;
+	for (int i = 0; i < NUM_AXES; ++i) {
+		float res = std::min(size[i] * cellsPerUnit, (float)maxResolution);
+		level.resolution[i] = clamp(1, maxResolution, (int)res);
 	}
-	cellDimensions = glm::vec3(size.x / resolution[0], size.y / resolution[1], size.z / resolution[2]);
-	// We won't use the formula for resolution now since we haven't included polygonal meshes yet
-	// since we need N, the # of tris in each cell
-	//resolution[0] =  floor(size.x * pow(lambda * objects.size() * (1.0f / (size.x * size.y * size.z)), 1.0f / 3.0f));
-	//resolution[1] = floor(size.y * pow(lambda * objects.size() * (1.0f / (size.x * size.y * size.z)), 1.0f / 3.0f));
-	//resolution[2] = floor(size.z * pow(lambda * objects.size() * (1.0f / (size.x * size.y * size.z)), 1.0f / 3.0f));
-
-	// create a 1-D cell array with resx * resy * resz elements
-	numCells = resolution[0] * resolution[1] * resolution[2];
-	cells = new Cell*[numCells];
-	
-	// memset them all to nullptr for now
-	memset(cells, 0x0, sizeof(Grid::Cell*) * numCells);
-
-	// populate the cells with triangles/objects 
-	// the ones with no objects in theirs cells remain nullptr
-	
-	// find the cell coords for xmin and xmax (y & z also)
-	// loop thru all the objects and insert each one into the grid
-	// based on their max and min bounding points
-	int totalItems = 0;
-	for (int k = 0; k < objects.size(); ++k) {
-		//totalItems++;
-		// find the x/y/z indices 
-		// subtract minimum of object Bbox with min of grid's Bbox
-		// and divide by cellDimensions x/y/z to get the "normalized" value,
-		// and floor to convert to the corresp cell index where the min/max
-		// point resides in
-		glm::vec3 minDiff = (objects[k]->bbox.minBounds - gridBbox.minBounds);
-		glm::vec3 maxDiff = (objects[k]->bbox.maxBounds - gridBbox.minBounds);
-		
-		// since z is always negative and we want a +ve 
-		// index, we negate for z. 
-		// Obtain cell coordinates for each object
-		int zmin = clamp(0, resolution[2] - 1, floor(-minDiff.z / cellDimensions.z));
-		int zmax = clamp(0, resolution[2] - 1, floor(-maxDiff.z / cellDimensions.z));
-		int ymin = clamp(0, resolution[1] - 1, floor(minDiff.y / cellDimensions.y));
-		int ymax = clamp(0, resolution[1] - 1, floor(maxDiff.y / cellDimensions.y));
-		int xmin = clamp(0, resolution[0] - 1, floor(minDiff.x / cellDimensions.x));
-		int xmax = clamp(0, resolution[0] - 1, floor(maxDiff.x / cellDimensions.x));
-		// loop thru cells to insert object inside them
-		for (int z = zmin; z <= zmax; ++z) {
-			for (int y = ymin; y <= ymax; ++y) {
-				for (int x = xmin; x <= xmax; ++x) {
-					// get the current grid idx -- its 1-dimensional
-					// each z index has traversed x*y elems, same idea for y etc...
-					int curIdx = z * resolution[0] * resolution[1] + y * resolution[0] + x;
-					if (cells[curIdx] == nullptr) { // cells with objects are not null
-						cells[curIdx] = new Cell;
-					}
-					// insert object into Cell object array
-					// cells[curIdx]
-					cells[curIdx]->insertObject(objects[k]);
-					std::cout << curIdx << std::endl;
+	level.lower = lower;
+	level.cellDimensions = size / glm::vec3(level.resolution[0], 
+		level.resolution[1], level.resolution[2]);
+	int numCells = level.resolution[0] * level.resolution[1] * 
+		level.resolution[2];
+
+	// 2. Find the cells each object overlaps: count them first, 
+	// then fill one flat list (cellStart[c] .. cellStart[c + 1])
+	std::vector<int> cellStart(numCells + 1, 0);
+	std::vector<int> objCells[2 * NUM_AXES];
+	for (int i = 0; i < 2 * NUM_AXES; ++i) objCells[i].resize(objs.size());
+	for (int k = 0; k < objs.size(); ++k) {
+		glm::vec3 minDiff = (objLower[objs[k]] - lower) / level.cellDimensions;
+		glm::vec3 maxDiff = (objUpper[objs[k]] - lower) / level.cellDimensions;
+		for (int i = 0; i < NUM_AXES; ++i) {
+			int hi = level.resolution[i] - 1;
+			objCells[i][k] = clamp(0, hi, 
+				(int)std::max(floorf(minDiff[i]), -1.0f));
+			objCells[i + NUM_AXES][k] = clamp(0, hi, 
+				(int)std::min(floorf(maxDiff[i]), (float)hi));
+		}
+		for (int z = objCells[2][k]; z <= objCells[5][k]; ++z) {
+			for (int y = objCells[1][k]; y <= objCells[4][k]; ++y) {
+				for (int x = objCells[0][k]; x <= objCells[3][k]; ++x) {
+					int curIdx = (z * level.resolution[1] + y) * 
+						level.resolution[0] + x;
+					cellStart[curIdx + 1]++;
+				}
+			}
+		}
+	}
+	for (int c = 0; c < numCells; ++c) cellStart[c + 1] += cellStart[c];
+	std::vector<int> cellObjects(cellStart[numCells]);
+	std::vector<int> fill(cellStart.begin(), cellStart.end() - 1);
+	for (int k = 0; k < objs.size(); ++k) {
+		for (int z = objCells[2][k]; z <= objCells[5][k]; ++z) {
+			for (int y = objCells[1][k]; y <= objCells[4][k]; ++y) {
+				for (int x = objCells[0][k]; x <= objCells[3][k]; ++x) {
+					int curIdx = (z * level.resolution[1] + y) * 
+						level.resolution[0] + x;
+					cellObjects[fill[curIdx]++] = objs[k];
 				}
 			}
 		}
+	}
 
+	// 3. Occupancy mask, and the rank of each word within the level
+	int numWords = (numCells + 63) / 64;
+	level.wordOffset = (uint32_t)occupancy.size();
+	occupancy.resize(occupancy.size() + numWords, 0);
+	occupancyRank.resize(occupancyRank.size() + numWords, 0);
+	int numOccupied = 0;
+	for (int c = 0; c < numCells; ++c) {
+		if ((c & 63) == 0) occupancyRank[level.wordOffset + c / 64] = numOccupied;
+		if (cellStart[c + 1] > cellStart[c]) {
+			occupancy[level.wordOffset + c / 64] |= 1ull << (c & 63);
+			numOccupied++;
+		}
 	}
-	//std::vector<Object*> objPtrs;
-	//std::cout << numCells << std::endl;
-	////int totalItems = 0;
-	//for (int m = 0; m < numCells; ++m) {
-	//	if (cells[m] != nullptr) {
-	//		for (int a = 0; a < cells[m]->cellObjects.size(); ++a) {
-	//			std::cout << cells[m]->cellObjects.size() << std::endl;
-	//			totalItems += cells[m]->cellObjects.size();
-	//		}
-	//	}
-	//}
-	std::cout << "total object count is " << totalItems << std::endl;
-}
+	level.cellOffset = (uint32_t)cells.size();
+	cells.resize(cells.size() + numOccupied);
+	levels[levelIdx] = level;
 
-// frees the array of pointers to Cell objects, then finally frees
-// pointer to the array of Cell pointers
-Grid::~Grid() {
-	for (int i = 0; i < resolution[0] * resolution[1] * resolution[2]; ++i) {
-		delete cells[i];
+	// 4. Fill the occupied cells, overfull ones get a sub-grid
+	int occupiedIdx = 0;
+	for (int c = 0; c < numCells; ++c) {
+		int count = cellStart[c + 1] - cellStart[c];
+		if (count == 0) continue;
+		std::vector<int> list(cellObjects.begin() + cellStart[c],
+			cellObjects.begin() + cellStart[c + 1]);
+		Cell cell = { (int32_t)objectIndices.size(), count, -1 };
+
+		if (count > GRID_MAX_CELL_OBJECTS && depth + 1 < GRID_MAX_LEVELS) {
+			glm::vec3 cellLower = lower + glm::vec3(
+				c % level.resolution[0],
+				(c / level.resolution[0]) % level.resolution[1],
+				c / (level.resolution[0] * level.resolution[1])) * 
+				level.cellDimensions;
+			glm::vec3 cellUpper = cellLower + level.cellDimensions;
+			// a sub-grid only helps if some objects don't cover 
+			// the whole cell
+			bool splits = false;
+			for (int k = 0; k < list.size() && !splits; ++k) {
+				glm::vec3 objLo = objLower[list[k]], objHi = objUpper[list[k]];
+				splits = objLo.x > cellLower.x || objLo.y > cellLower.y ||
+					objLo.z > cellLower.z || objHi.x < cellUpper.x ||
+					objHi.y < cellUpper.y || objHi.z < cellUpper.z;
+			}
+			if (splits) {
+				cell.subGrid = buildLevel(cellLower, cellUpper, list, depth + 1);
+			}
+		}
+		if (cell.subGrid < 0) {
+			objectIndices.insert(objectIndices.end(), list.begin(), list.end());
+		}
+		cells[level.cellOffset + occupiedIdx++] = cell;
 	}
-	delete cells;
+	return levelIdx;
 }
 
-int Grid::clamp(const int& lo, const int& hi, const int& v) {
-	return std::max(lo, std::min(hi, v));
+const Grid::Cell* Grid::findCell(const Level& level, int cellIdx) const {
+	uint32_t word = level.wordOffset + (cellIdx >> 6);
+	uint64_t bit = 1ull << (cellIdx & 63);
+	uint64_t bits = occupancy[word];
+	if ((bits & bit) == 0) return nullptr;
+	return &cells[level.cellOffset + occupancyRank[word] + 
+		popcount64(bits & (bit - 1))];
 }
 
-bool Grid::intersect(glm::vec3 orig, glm::vec3 dir, const std::vector<Object*>& objects, float& tNear, int& objIndex, glm::vec2& uv, Object* hitObj) {
-	// prep the deltaT, nextCrossingT, initial x/y/z, 
-	// find the starting cell coordinates using 	
-	// rayOriginGrid 
-
-	// Check if ray intersects Grid's Bounding Box
-	// If ray orig is inside, box intersection routine still returns
-	// true 
-	if (!gridBbox.findIntersection(orig, dir, tNear)) return false;
-
-	// ray intersects the grid bounding box (either from the outside
-	// or inside) 
-	// set up the neccessary index for bounds, exit, and cell, 
-	// and set up parametric distance variables
-	glm::vec3 rayOriginGrid;
-	// the next closest parametric intersect dist
-	glm::vec3 nextCrossingT; 
-	// the parametric dist traversed due to i-th axis
-	glm::vec3 deltaT; 
-	int cell[3], step[3], exit[3];
-	// loop thru all 3 axes to initialize each respective component
+bool Grid::traverse(int levelIdx, const glm::vec3& orig,
+	const glm::vec3& dir, const glm::vec3& inverseDir,
+	float tStart, float tEnd, float& tNear, int& index,
+	glm::vec2& uv, Object** hitObject, bool anyHit) const {
+
+	const Level& level = levels[levelIdx];
+	// set up the starting cell from the point the ray enters at,
+	// the parametric dist to the next cell boundary on each axis and
+	// the dist it takes to cross one cell
+	glm::vec3 rayOriginGrid = orig + dir * tStart - level.lower;
+	glm::vec3 nextCrossingT, deltaT;
+	int cell[NUM_AXES], step[NUM_AXES], exit[NUM_AXES];
 	for (int i = 0; i < NUM_AXES; ++i) {
-		// tNear is the distance from ray origin (outside) to intersct pt
-		// in the i-th dimension to grid
-		rayOriginGrid[i] = (orig[i] + tNear * dir[i]) - gridBbox.minBounds[i];
-		// find starting cell index in the i-th axis
-		cell[i] = clamp(floor(rayOriginGrid[i] / 
-			cellDimensions[i]), 0, resolution[i] - 1);
-
-
-		// check if i-th direction is + or -ve
-		if (dir[i] < .0f) {
-			//if (i == 0 || i == 1) {
-				// the parametric dist traversed due to i-th axis
-				deltaT[i] = -cellDimensions[i] / dir[i];
-				
-				if (i == 0 || i == 1) {
-					nextCrossingT[i] = tNear + ((cell[i] * cellDimensions[i] - rayOriginGrid[i]) / dir[i]);
-					// decide cell idx step direction
-					step[i] = -1;
-					// set exit bounds 
-					exit[i] = -1;
-				}
-				else {
-					nextCrossingT[i] = tNear + (( (cell[i] + 1) * cellDimensions[i] - rayOriginGrid[i]) / dir[i]);
-					// decide cell idx step direction
-					step[i] = 1;
-					// set exit bounds 
-					exit[i] = resolution[i];
-				}
-			//}
-			//else {
-			//	deltaT[i] = -cellDimensions[i] / dir[i];
-			//	nextCrossingT[i] = tNear + (((cell[i] + 1) * cellDimensions[i] - rayOriginGrid[i]) / -dir[i]);
-			//	// decide cell idx step direction
-			//	step[i] = 1;
-			//	// set exit bounds 
-			//	exit[i] = resolution[i];
-			//}
+		float c = floorf(rayOriginGrid[i] / level.cellDimensions[i]);
+		cell[i] = clamp(0, level.resolution[i] - 1, 
+			(int)std::max(std::min(c, (float)level.resolution[i]), -1.0f));
+		float cellLower = level.lower[i] + cell[i] * level.cellDimensions[i];
+		if (dir[i] > .0f) {
+			deltaT[i] = level.cellDimensions[i] * inverseDir[i];
+			nextCrossingT[i] = (cellLower + level.cellDimensions[i] - orig[i]) * 
+				inverseDir[i];
+			step[i] = 1;
+			exit[i] = level.resolution[i];
+		}
+		else if (dir[i] < .0f) {
+			deltaT[i] = -level.cellDimensions[i] * inverseDir[i];
+			nextCrossingT[i] = (cellLower - orig[i]) * inverseDir[i];
+			step[i] = -1;
+			exit[i] = -1;
 		}
 		else {
-			//if (i == 0 || i == 1) {
-				deltaT[i] = cellDimensions[i] / dir[i];
-				nextCrossingT[i] = tNear + (((cell[i] + 1) * cellDimensions[i] - rayOriginGrid[i]) / dir[i]);
-				// decide cell idx step direction
-				step[i] = 1;
-				// set exit bounds 
-				exit[i] = resolution[i];
-			//}
-			//else {
-			//	// the parametric dist traversed due to i-th axis
-			//	deltaT[i] = cellDimensions[i] / dir[i];
-			//	nextCrossingT[i] = tNear + ((cell[i] * cellDimensions[i] - rayOriginGrid[i]) / dir[i]);
-			//	// decide cell idx step direction
-			//	step[i] = -1;
-			//	// set exit bounds 
-			//	exit[i] = -1;
-			//}
+			deltaT[i] = FLT_MAX;
+			nextCrossingT[i] = FLT_MAX;
+			step[i] = 0;
+			exit[i] = -1;
 		}
 	}
 
-	// We want to retrieve a pointer to the object
-
-	// Begin traversing the cells of the Grid and do intersection
-	// test at each cell, return reference to object hit
+	int indexK;
+	glm::vec2 uvK;
+	float tCellEnter = tStart;
+	TraversalStats stats;
 	while (1) {
-		// carry out intersection test at current cell
-		int index = cell[2] * resolution[1] * resolution[0] + 
-			cell[1] * resolution[0] + cell[0];
-		// NOTE: cell != cells -- if cells contains object
-		// intersection check it: returns pointer to object if obj is hit
-		if (cells[index] != nullptr) { 
-			cells[index]->intersect(orig, dir, tNear, hitObj);
-		}
+		// the axis whose boundary the ray crosses first
+		int axis = nextCrossingT[0] < nextCrossingT[1] ?
+			(nextCrossingT[0] < nextCrossingT[2] ? 0 : 2) :
+			(nextCrossingT[1] < nextCrossingT[2] ? 1 : 2);
+		float tCellExit = std::min(nextCrossingT[axis], tEnd);
 
-		// To check if object is hit we need find 
-		// the axis for nextCrossingT (which dimension is closest)
-		
-		// use a map to map index to closest axis
-		int map[8] = { 2, 1, 2, 1, 2, 2, 0, 0 };
-		// Right shift by 2 i.e. 1 << 2 == 4 (decimal)
-		int axis = map[((nextCrossingT[0] < nextCrossingT[1]) << 2) +
-			((nextCrossingT[0] < nextCrossingT[2]) << 1) +
-			(nextCrossingT[1] < nextCrossingT[2])];
-		// now we have the parametric dist to the closest
-		// intersecting axis (x/y/z) 
-		
-		// check if object is hit, and if the intersection 
-		// dist is within cell confines -- we break out of loop
-		// if we did. We now have object's surf. color
-		if (hitObj != nullptr && tNear < nextCrossingT[axis]) {
-			break;
+		int cellIdx = (cell[2] * level.resolution[1] + cell[1]) * 
+			level.resolution[0] + cell[0];
+		const Cell* current = findCell(level, cellIdx);
+		stats.node();
+		if (current != nullptr) {
+			if (current->subGrid >= 0) {
+				if (traverse(current->subGrid, orig, dir, inverseDir,
+					tCellEnter, tCellExit, tNear, index, uv, 
+					hitObject, anyHit)) {
+					return true;
+				}
+			}
+			else {
+				stats.primitives(current->count);
+				for (int i = current->offset; 
+					i < current->offset + current->count; ++i) {
+					Object* obj = objects[objectIndices[i]];
+					float tCurrNearest = FLT_MAX;
+					if (obj->findIntersection(orig, dir, tCurrNearest, indexK, uvK)
+						&& tCurrNearest < tNear) {
+						tNear = tCurrNearest;
+						index = indexK;
+						uv = uvK;
+						*hitObject = obj;
+						if (anyHit) return true;
+					}
+				}
+			}
+			// objects can stick out of the cell, only a hit inside
+			// it is sure to be the closest
+			if (!anyHit && tNear <= tCellExit) return true;
 		}
-		// else no hit, traverse to next cell
-		nextCrossingT[axis] += deltaT[axis];
+
+		if (nextCrossingT[axis] >= tEnd) break;
 		cell[axis] += step[axis];
 		// check if traversal bounds exceeded 
 		if (cell[axis] == exit[axis]) break;
+		tCellEnter = nextCrossingT[axis];
+		nextCrossingT[axis] += deltaT[axis];
 	}
-	// if hitObj references an object, then 
-	// intersection found is true, else nullptr means false
-	return (hitObj != nullptr);
+	return false;
+}
+
+bool Grid::findIntersection(glm::vec3 orig, glm::vec3 dir,
+	float& tNear, int& index, glm::vec2& uv,
+	Object** hitObject) const {
+
+	// planes first, a hit there clips tNear before the traversal
+	unbounded.findIntersection(orig, dir, tNear, index, uv, hitObject);
+	if (levels.empty()) return (*hitObject != nullptr);
+
+	glm::vec3 inverseDir = 1.0f / dir;
+	float tEnter, tExit;
+	if (Bbox::intersectRange(gridLower, gridUpper, orig, inverseDir,
+		tNear, tEnter, tExit)) {
+		traverse(0, orig, dir, inverseDir, tEnter, tExit, 
+			tNear, index, uv, hitObject, false);
+	}
+	return (*hitObject != nullptr);
+}
+
+bool Grid::occluded(glm::vec3 orig, glm::vec3 dir, float tMax) const {
+	if (unbounded.occluded(orig, dir, tMax)) return true;
+	if (levels.empty()) return false;
+
+	glm::vec3 inverseDir = 1.0f / dir;
+	float tEnter, tExit;
+	if (!Bbox::intersectRange(gridLower, gridUpper, orig, inverseDir,
+		tMax, tEnter, tExit)) {
+		return false;
+	}
+	Object* hitObj = nullptr;
+	int index;
+	glm::vec2 uv;
+	return traverse(0, orig, dir, inverseDir, tEnter, tExit, 
+		tMax, index, uv, &hitObj, true);
+}
+
+Bbox Grid::getBounds() const {
+	Bbox bounds = unbounded.getBounds();
+	if (levels.empty()) return bounds;
+	bounds.extendBy(gridLower);
+	bounds.extendBy(gridUpper);
+	return bounds;
+}
+
+bool Grid::refit() {
+	return false;
+}
+
+int Grid::getLevelCount() const {
+	return (int)levels.size();
+}
+
+size_t Grid::getMemoryUsage() const {
+	return sizeof(Level) * levels.size() + 
+		sizeof(uint64_t) * occupancy.size() +
+		sizeof(uint32_t) * occupancyRank.size() +
+		sizeof(Cell) * cells.size() + 
+		sizeof(int32_t) * objectIndices.size() +
+		sizeof(Object*) * objects.size();
 }
\ No newline at end of file
@@ -1,97 +1,95 @@
 #ifndef _GRID_H_
 #define _GRID_H_
 
+#include <stdint.h>
 #include "AccelerationStructure.h"
 #include "Bbox.h"
-#include "../Lights_Color/Color.h"
-#include "../Lights_Color/Light.h"
-#include <iostream>
-#include "../Shapes_and_globals/Plane.h"
 
 #define NUM_AXES 3 // the total number of axes
 
+// cells per unit volume per object, i.e. the lambda in
+// res = size * cbrt(lambda * N / V) -- for each level of the grid
+#define GRID_DENSITY 5.0f
+#define GRID_MAX_RESOLUTION 64 // per axis, top level
+#define GRID_MAX_SUB_RESOLUTION 16 // per axis, sub-grids
+// a cell holding more objects than this gets a sub-grid of its own
+#define GRID_MAX_CELL_OBJECTS 8
+#define GRID_MAX_LEVELS 2 // top level + sub-grids
+
+// Hierarchical uniform grid. The top level is sized by the object 
+// density over the scene bounds, cells that end up overfull are 
+// split again by a sub-grid sized by the density inside them, so 
+// dense clusters don't end up as long lists in a few cells. 
+// Empty cells take 1 bit in an occupancy mask and nothing else: 
+// only occupied cells have a Cell record, found by counting the 
+// set bits before them (a rank kept per 64 cell word)
 class Grid : public AccelerationStructure {
 	struct Cell {
-		Cell() {}
-
-		// triangle descriptor struct
-		// holds description for each triangle (a ptr and a offset)
-		struct TriangleDes {
-			Object* obj;
-			int idx;
-			// Should be a mesh pointer but we haven't included
-			// triangle meshes yet
-			TriangleDes(Object* objPtr, int index) : obj(objPtr), idx(index) {}
-
-		};
-		void insertTriangles(TriangleDes tri) {
-			triangles.push_back(tri);
-		}
-
-		void insertObject(Object* obj) {
-			cellObjects.push_back(obj);
-		}
-		// Cell's Intersect function: iterates thru all triangles
-		// inserted in the cell, and stores a record abt closest one
-		// returns true or false if a triangle in the mesh was intersected
-		//bool intersect(glm::vec3 orig, glm::vec3 dir, Object* hitObj);
-
-		// iterates thru triangles vector and finds the closest ray-triangle inter.
-		// in the cell, stores that triangle/oject
-		bool intersect(glm::vec3 orig, glm::vec3 dir, float& tNear, Object* hitObj) {
-			glm::vec2 uv;
-			int objectIdx = 0;
-			float tCurrNearest = FLT_MAX;
-			for (int i = 0; i < cellObjects.size(); ++i) {
-				// findIntersectionwill save tCurrNearest, and pointer to nearest
-				// object -- (we don't use objectIdx and uv at the moment..)
-				if (cellObjects[i]->findIntersection(orig, dir, tCurrNearest, objectIdx, uv) 
-					&& tCurrNearest < tNear) {
-					 tNear = tCurrNearest;
-					hitObj = cellObjects[i];
-				}
-			}
-			return (hitObj != nullptr);
-		}
-
-		std::vector<TriangleDes> triangles;
-		std::vector<Object*> cellObjects;
-		Color color;
+		int32_t offset; // into objectIndices
+		int32_t count;
+		int32_t subGrid; // index into levels, -1 if none
 	};
-private: 
 
+	// one grid: the top level or a sub-grid of an overfull cell
+	struct Level {
+		glm::vec3 lower;
+		glm::vec3 cellDimensions;
+		int resolution[NUM_AXES];
+		uint32_t wordOffset; // first occupancy word of this level
+		uint32_t cellOffset; // first Cell of this level
+	};
 
-public:
-
-	Grid();
+private:
+	std::vector<Level> levels;
+	std::vector<uint64_t> occupancy;
+	// set bits in the level's words before each word
+	std::vector<uint32_t> occupancyRank;
+	std::vector<Cell> cells;
+	std::vector<int32_t> objectIndices;
+	glm::vec3 gridLower, gridUpper;
+
+	// box of every object, computed once for the build
+	std::vector<glm::vec3> objLower, objUpper;
+
+	// builds a grid of the given objects over [lower, upper] and 
+	// returns its index in levels
+	int buildLevel(glm::vec3 lower, glm::vec3 upper, 
+		const std::vector<int>& objs, int depth);
+
+	// the Cell of cellIdx in the level, nullptr for empty cells
+	const Cell* findCell(const Level& level, int cellIdx) const;
+
+	// 3D-DDA walk through the level's cells over [tStart, tEnd],
+	// going down into sub-grids. Returns true when done: a hit 
+	// closer than the current cell's exit (or any hit for anyHit)
+	bool traverse(int levelIdx, const glm::vec3& orig, 
+		const glm::vec3& dir, const glm::vec3& inverseDir, 
+		float tStart, float tEnd, float& tNear, int& index, 
+		glm::vec2& uv, Object** hitObject, bool anyHit) const;
 
-	// define grid constructor
-	Grid(std::vector<Object*>& objs, std::vector<LightSources*>& lights);
+public:
+	Grid(std::vector<Object*>& objs);
 
-	// frees the array of pointers to Cell objects, then finally frees
-	// pointer to the array of Cell pointers
 	~Grid();
 
 	// clamps the integer value in the range [lo, hi]
-	int clamp(const int& lo, const int& hi, const int& v);
-
-	// x y z dimensions 
-	int resolution[3];
-	glm::vec3 cellDimensions;
-
-	// resolution: X by Y by Z 
-	int numCells;
-	Cell** cells;
-	Bbox gridBbox;
-	
-	// Initiates intersection routine of 
-	// cam ray casted into the scene into the grid 
-	// if the grid is intersected, traverse ray thru the cells 
-	// using 3D-DDA algorithm. Returns pointer to the object 
-	// intersected 
-	bool intersect(glm::vec3 orig, glm::vec3 dir, 
-		const std::vector<Object*>& objects, float& tNear, 
-		int& objIndex, glm::vec2& uv, 
-		Object* hitObj);
+	int clamp(const int& lo, const int& hi, const int& v) const;
+
+	bool findIntersection(glm::vec3 orig, glm::vec3 dir,
+		float& tNear, int& index, glm::vec2& uv,
+		Object** hitObject) const;
+
+	bool occluded(glm::vec3 orig, glm::vec3 dir, float tMax) const;
+
+	Bbox getBounds() const;
+
+	// objects are binned into cells by their boxes, moving 
+	// them means rebinning: always asks for a rebuild
+	bool refit();
+
+	int getLevelCount() const;
+
+	// bytes taken by the masks, cells and object references
+	size_t getMemoryUsage() const;
 };
 #endif
\ No newline at end of file
@@ -0,0 +1,395 @@
+#include "KdTree.h"
+#include "../Render/RenderStats.h"
+#include <algorithm>
+
+KdTree::KdTree(std::vector<Object*>& objs, kdTraversal kdTraversalType) :
+	AccelerationStructure(objs), traversal(kdTraversalType) {
+	if (objects.empty()) return;
+
+	// build routine for the root cell: the box around every object
+	Bbox bounds;
+	objLower.resize(objects.size());
+	objUpper.resize(objects.size());
+	std::vector<int> objIndices(objects.size());
+	for (int i = 0; i < objects.size(); ++i) {
+		objLower[i] = objects[i]->bbox.getLower();
+		objUpper[i] = objects[i]->bbox.getUpper();
+		bounds.extendBy(objects[i]->bbox);
+		objIndices[i] = i;
+	}
+	rootLower = bounds.getLower();
+	rootUpper = bounds.getUpper();
+
+	maxDepth = std::min(KDTREE_MAX_DEPTH, 
+		(int)roundf(8.0f + 1.3f * log2f((float)objects.size())));
+	std::vector<BoundEdge> edges;
+	edges.reserve(2 * objects.size());
+	build(rootLower, rootUpper, objIndices, maxDepth, 0, edges);
+
+	// boxes aren't needed once the tree is built
+	std::vector<glm::vec3>().swap(objLower);
+	std::vector<glm::vec3>().swap(objUpper);
+
+	if (traversal == KDTREE_ROPE_TRAVERSAL) {
+		int ropes[6] = { -1, -1, -1, -1, -1, -1 };
+		buildRopes(0, ropes, rootLower, rootUpper);
+	}
+}
+
+KdTree::~KdTree() {
+}
+
+void KdTree::makeLeaf(const std::vector<int>& objs) {
+	Node leaf;
+	leaf.offset = (int32_t)objectIndices.size();
+	leaf.flags = ((uint32_t)objs.size() << 2) | 3;
+	nodes.push_back(leaf);
+	objectIndices.insert(objectIndices.end(), objs.begin(), objs.end());
+}
+
+void KdTree::build(glm::vec3 lower, glm::vec3 upper,
+	std::vector<int>& objs, int depth, int badRefines,
+	std::vector<BoundEdge>& edges) {
+
+	int n = (int)objs.size();
+	glm::vec3 d = upper - lower;
+	float totalArea = 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+	if (n <= KDTREE_MAX_LEAF_SIZE || depth == 0 || !(totalArea > .0f)) {
+		makeLeaf(objs);
+		return;
+	}
+
+	// Sweep the sorted box edges along an axis: every edge inside the
+	// cell is a candidate plane, with nBelow/nAbove objects on each 
+	// side. Start with the longest axis, try the others if no plane
+	// is found (e.g. every object spans the cell)
+	float bestCost = FLT_MAX;
+	int bestAxis = -1, bestOffset = -1;
+	float leafCost = KDTREE_INTERSECT_COST * n;
+	float invTotalArea = 1.0f / totalArea;
+	int axis = (d.x > d.y && d.x > d.z) ? 0 : (d.y > d.z ? 1 : 2);
+	for (int retries = 0; retries < 3 && bestAxis == -1; ++retries) {
+		edges.resize(2 * n);
+		for (int i = 0; i < n; ++i) {
+			edges[2 * i] = { objLower[objs[i]][axis], objs[i], true };
+			edges[2 * i + 1] = { objUpper[objs[i]][axis], objs[i], false };
+		}
+		std::sort(edges.begin(), edges.end());
+
+		int axis0 = (axis + 1) % 3, axis1 = (axis + 2) % 3;
+		int nBelow = 0, nAbove = n;
+		for (int i = 0; i < 2 * n; ++i) {
+			if (!edges[i].start) --nAbove;
+			float t = edges[i].t;
+			if (t > lower[axis] && t < upper[axis]) {
+				float belowArea = 2.0f * (d[axis0] * d[axis1] + 
+					(t - lower[axis]) * (d[axis0] + d[axis1]));
+				float aboveArea = 2.0f * (d[axis0] * d[axis1] + 
+					(upper[axis] - t) * (d[axis0] + d[axis1]));
+				float bonus = (nAbove == 0 || nBelow == 0) ? 
+					KDTREE_EMPTY_BONUS : .0f;
+				float cost = KDTREE_TRAVERSAL_COST + KDTREE_INTERSECT_COST * 
+					(1.0f - bonus) * (belowArea * invTotalArea * nBelow + 
+					aboveArea * invTotalArea * nAbove);
+				if (cost < bestCost) {
+					bestCost = cost;
+					bestAxis = axis;
+					bestOffset = i;
+				}
+			}
+			if (edges[i].start) ++nBelow;
+		}
+		if (bestAxis == -1) axis = (axis + 1) % 3;
+	}
+
+	// a few splits that cost more than a leaf are allowed since later 
+	// ones can still pay off
+	if (bestCost > leafCost) ++badRefines;
+	if ((bestCost > 4.0f * leafCost && n < 16) || bestAxis == -1 ||
+		badRefines == KDTREE_MAX_BAD_REFINES) {
+		makeLeaf(objs);
+		return;
+	}
+
+	// the edges still hold the sweep of the best axis since we stop
+	// retrying once a plane is found
+	std::vector<int> below, above;
+	for (int i = 0; i < bestOffset; ++i) {
+		if (edges[i].start) below.push_back(edges[i].object);
+	}
+	for (int i = bestOffset + 1; i < 2 * n; ++i) {
+		if (!edges[i].start) above.push_back(edges[i].object);
+	}
+	float split = edges[bestOffset].t;
+	// the objects were copied out, free this level's list before 
+	// going down
+	std::vector<int>().swap(objs);
+
+	int nodeIdx = (int)nodes.size();
+	nodes.push_back(Node());
+	glm::vec3 belowUpper = upper, aboveLower = lower;
+	belowUpper[bestAxis] = split;
+	aboveLower[bestAxis] = split;
+	build(lower, belowUpper, below, depth - 1, badRefines, edges);
+	int aboveIdx = (int)nodes.size();
+	build(aboveLower, upper, above, depth - 1, badRefines, edges);
+	nodes[nodeIdx].split = split;
+	nodes[nodeIdx].flags = ((uint32_t)aboveIdx << 2) | (uint32_t)bestAxis;
+}
+
+void KdTree::optimizeRope(int& rope, int face, const glm::vec3& lower,
+	const glm::vec3& upper) const {
+	int faceAxis = face / 2;
+	bool upperFace = (face & 1) != 0;
+	while (rope >= 0 && !nodes[rope].isLeaf()) {
+		const Node& node = nodes[rope];
+		int axis = node.axis();
+		if (axis == faceAxis) {
+			// only the child on our side of its plane touches the face
+			rope = upperFace ? rope + 1 : node.aboveChild();
+		}
+		else if (node.split <= lower[axis]) {
+			rope = node.aboveChild();
+		}
+		else if (node.split >= upper[axis]) {
+			rope = rope + 1;
+		}
+		else {
+			// both children touch the face
+			break;
+		}
+	}
+}
+
+void KdTree::buildRopes(int idx, int ropes[6], glm::vec3 lower,
+	glm::vec3 upper) {
+	for (int face = 0; face < 6; ++face) {
+		optimizeRope(ropes[face], face, lower, upper);
+	}
+
+	Node& node = nodes[idx];
+	if (node.isLeaf()) {
+		RopeLeaf leaf;
+		leaf.lower = lower;
+		leaf.upper = upper;
+		std::copy(ropes, ropes + 6, leaf.ropes);
+		leaf.offset = node.offset;
+		leaf.count = node.count();
+		// the leaf now points at its rope data
+		node.offset = (int32_t)ropeLeaves.size();
+		ropeLeaves.push_back(leaf);
+		return;
+	}
+
+	int axis = node.axis();
+	int aboveIdx = node.aboveChild();
+	int belowRopes[6], aboveRopes[6];
+	std::copy(ropes, ropes + 6, belowRopes);
+	std::copy(ropes, ropes + 6, aboveRopes);
+	// the two children are each other's neighbour across the plane
+	belowRopes[2 * axis + 1] = aboveIdx;
+	aboveRopes[2 * axis] = idx + 1;
+	glm::vec3 belowUpper = upper, aboveLower = lower;
+	belowUpper[axis] = node.split;
+	aboveLower[axis] = node.split;
+	buildRopes(idx + 1, belowRopes, lower, belowUpper);
+	buildRopes(aboveIdx, aboveRopes, aboveLower, upper);
+}
+
+bool KdTree::intersectLeaf(int offset, int count, const glm::vec3& orig,
+	const glm::vec3& dir, float& tNear, int& index, glm::vec2& uv,
+	Object** hitObject, bool anyHit) const {
+	int indexK;
+	glm::vec2 uvK;
+	for (int i = offset; i < offset + count; ++i) {
+		Object* obj = objects[objectIndices[i]];
+		float tCurrNearest = FLT_MAX;
+		if (obj->findIntersection(orig, dir, tCurrNearest, indexK, uvK)
+			&& tCurrNearest < tNear) {
+			tNear = tCurrNearest;
+			index = indexK;
+			uv = uvK;
+			*hitObject = obj;
+			if (anyHit) return true;
+		}
+	}
+	return false;
+}
+
+bool KdTree::findIntersection(glm::vec3 orig, glm::vec3 dir,
+	float& tNear, int& index, glm::vec2& uv,
+	Object** hitObject) const {
+
+	// planes first, a hit there clips tNear before the traversal
+	unbounded.findIntersection(orig, dir, tNear, index, uv, hitObject);
+	if (nodes.empty()) return (*hitObject != nullptr);
+	if (traversal == KDTREE_ROPE_TRAVERSAL) {
+		return findIntersectionRopes(orig, dir, tNear, index, uv, 
+			hitObject, false);
+	}
+	return findIntersectionStack(orig, dir, tNear, index, uv, 
+		hitObject, false);
+}
+
+bool KdTree::occluded(glm::vec3 orig, glm::vec3 dir, float tMax) const {
+	if (unbounded.occluded(orig, dir, tMax)) return true;
+	if (nodes.empty()) return false;
+
+	Object* hitObj = nullptr;
+	int index;
+	glm::vec2 uv;
+	if (traversal == KDTREE_ROPE_TRAVERSAL) {
+		return findIntersectionRopes(orig, dir, tMax, index, uv, 
+			&hitObj, true);
+	}
+	return findIntersectionStack(orig, dir, tMax, index, uv, 
+		&hitObj, true);
+}
+
+// Front to back walk with a stack of the far children still to 
+// visit, each with the ray's [tMin, tMax] range inside it. Cells 
+// don't overlap, so once a hit is closer than the next cell's 
+// entry we're done
+struct KdStackEntry {
+	int node;
+	float tMin, tMax;
+};
+
+bool KdTree::findIntersectionStack(glm::vec3 orig, glm::vec3 dir,
+	float& tNear, int& index, glm::vec2& uv,
+	Object** hitObject, bool anyHit) const {
+
+	glm::vec3 inverseDir = 1.0f / dir;
+	float tMin, tMax;
+	if (!Bbox::intersectRange(rootLower, rootUpper, orig, inverseDir,
+		tNear, tMin, tMax)) {
+		return (*hitObject != nullptr);
+	}
+
+	TraversalStats stats;
+	KdStackEntry stack[KDTREE_STACK_SIZE];
+	int stackSize = 0;
+	int current = 0;
+	while (tMin <= tNear) {
+		const Node& node = nodes[current];
+		stats.node();
+		if (!node.isLeaf()) {
+			int axis = node.axis();
+			float tPlane = (node.split - orig[axis]) * inverseDir[axis];
+			bool belowFirst = orig[axis] < node.split || 
+				(orig[axis] == node.split && dir[axis] <= .0f);
+			int first = belowFirst ? current + 1 : node.aboveChild();
+			int second = belowFirst ? node.aboveChild() : current + 1;
+			// tPlane is nan when the ray runs inside the plane
+			if (!(tPlane <= tMax) || tPlane <= .0f) {
+				current = first;
+			}
+			else if (tPlane < tMin) {
+				current = second;
+			}
+			else {
+				stack[stackSize++] = { second, tPlane, tMax };
+				current = first;
+				tMax = tPlane;
+			}
+		}
+		else {
+			stats.primitives(node.count());
+			if (intersectLeaf(node.offset, node.count(), orig, dir,
+				tNear, index, uv, hitObject, anyHit)) {
+				return true;
+			}
+			if (stackSize == 0) break;
+			--stackSize;
+			current = stack[stackSize].node;
+			tMin = stack[stackSize].tMin;
+			tMax = stack[stackSize].tMax;
+		}
+	}
+	return (*hitObject != nullptr);
+}
+
+// Stackless walk: find the leaf holding the point the ray enters 
+// at, test its objects, then follow the rope of the face the ray 
+// leaves through and walk down from there to the next leaf
+bool KdTree::findIntersectionRopes(glm::vec3 orig, glm::vec3 dir,
+	float& tNear, int& index, glm::vec2& uv,
+	Object** hitObject, bool anyHit) const {
+
+	glm::vec3 inverseDir = 1.0f / dir;
+	float tEnter, tExit;
+	if (!Bbox::intersectRange(rootLower, rootUpper, orig, inverseDir,
+		tNear, tEnter, tExit)) {
+		return (*hitObject != nullptr);
+	}
+
+	TraversalStats stats;
+	int current = 0;
+	while (current >= 0) {
+		glm::vec3 p = orig + dir * tEnter;
+		stats.node();
+		while (!nodes[current].isLeaf()) {
+			const Node& node = nodes[current];
+			stats.node();
+			int axis = node.axis();
+			// on the plane itself we go the way the ray is heading
+			bool below = p[axis] < node.split ||
+				(p[axis] == node.split && dir[axis] < .0f);
+			current = below ? current + 1 : node.aboveChild();
+		}
+
+		const RopeLeaf& leaf = ropeLeaves[nodes[current].offset];
+		stats.primitives(leaf.count);
+		if (intersectLeaf(leaf.offset, leaf.count, orig, dir,
+			tNear, index, uv, hitObject, anyHit)) {
+			return true;
+		}
+
+		// the face the ray leaves the cell through
+		float tLeave = FLT_MAX;
+		int face = -1;
+		for (int axis = 0; axis < 3; ++axis) {
+			if (dir[axis] == .0f) continue;
+			float t = ((dir[axis] > .0f ? leaf.upper[axis] : 
+				leaf.lower[axis]) - orig[axis]) * inverseDir[axis];
+			if (t < tLeave) {
+				tLeave = t;
+				face = 2 * axis + (dir[axis] > .0f ? 1 : 0);
+			}
+		}
+		// a hit inside this cell can't be beaten by the next ones
+		if (face == -1 || tNear <= tLeave || tLeave >= tExit) break;
+		current = leaf.ropes[face];
+		// never step backwards, rounding can put tLeave a hair 
+		// before tEnter
+		tEnter = std::max(tEnter, tLeave);
+	}
+	return (*hitObject != nullptr);
+}
+
+Bbox KdTree::getBounds() const {
+	Bbox bounds = unbounded.getBounds();
+	if (nodes.empty()) return bounds;
+	bounds.extendBy(rootLower);
+	bounds.extendBy(rootUpper);
+	return bounds;
+}
+
+bool KdTree::refit() {
+	return false;
+}
+
+int KdTree::getNodeCount() const {
+	return (int)nodes.size();
+}
+
+kdTraversal KdTree::getTraversal() const {
+	return traversal;
+}
+
+size_t KdTree::getMemoryUsage() const {
+	return sizeof(Node) * nodes.size() + 
+		sizeof(int32_t) * objectIndices.size() +
+		sizeof(RopeLeaf) * ropeLeaves.size() + 
+		sizeof(Object*) * objects.size();
+}
\ No newline at end of file
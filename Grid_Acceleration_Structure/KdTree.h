@@ -0,0 +1,145 @@
+#ifndef _KDTREE_H_
+#define _KDTREE_H_
+
+#include <stdint.h>
+#include "AccelerationStructure.h"
+#include "Bbox.h"
+
+// SAH costs, relative to one traversal step (values from PBRT)
+#define KDTREE_TRAVERSAL_COST 1.0f
+#define KDTREE_INTERSECT_COST 80.0f
+#define KDTREE_EMPTY_BONUS 0.5f // favours splits that cut off empty space
+#define KDTREE_MAX_LEAF_SIZE 1 // objects per leaf before we try to split
+#define KDTREE_MAX_BAD_REFINES 3 // splits allowed that don't pay off
+#define KDTREE_MAX_DEPTH 48 // the depth is also capped by 8 + 1.3 log2(n)
+#define KDTREE_STACK_SIZE 64
+
+// Compile with KDTREE_ROPES to make the renderer walk the tree
+// using the neighbour links (ropes) instead of a stack
+enum kdTraversal { KDTREE_STACK_TRAVERSAL, KDTREE_ROPE_TRAVERSAL };
+
+#ifdef KDTREE_ROPES
+#define KDTREE_DEFAULT_TRAVERSAL KDTREE_ROPE_TRAVERSAL
+#else
+#define KDTREE_DEFAULT_TRAVERSAL KDTREE_STACK_TRAVERSAL
+#endif
+
+// k-d tree over the objects passed in, each split plane chosen 
+// with the surface area heuristic over the objects' box edges. 
+// Unlike the BVH the cells don't overlap, so a few detailed 
+// objects in a large empty room end up in small tight cells, 
+// but an object can be referenced by several leaves
+class KdTree : public AccelerationStructure {
+	// 8 bytes, nodes are stored depth first: an interior node's
+	// below child is the next node, the above child's index is 
+	// kept in flags
+	struct Node {
+		union {
+			float split; // interior
+			int32_t offset; // leaf: into objectIndices (or ropeLeaves)
+		};
+		// low 2 bits: split axis, 3 for leaves. the rest: the 
+		// above child (interior) or the object count (leaf)
+		uint32_t flags;
+
+		bool isLeaf() const { return (flags & 3) == 3; }
+		int axis() const { return flags & 3; }
+		int aboveChild() const { return flags >> 2; }
+		int count() const { return flags >> 2; }
+	};
+
+	// Per leaf data for the rope traversal: the leaf's cell and the
+	// node on the other side of each of its 6 faces (-1 if the 
+	// face is on the scene bounds). Face 2 * axis is the lower side
+	// along that axis, 2 * axis + 1 the upper side
+	struct RopeLeaf {
+		glm::vec3 lower;
+		glm::vec3 upper;
+		int32_t ropes[6];
+		int32_t offset;
+		int32_t count;
+	};
+
+	// one side of an object's box along the axis being split
+	struct BoundEdge {
+		float t;
+		int object;
+		bool start;
+		bool operator<(const BoundEdge& e) const {
+			// starts go first so flat objects end up on both sides
+			if (t == e.t) return start && !e.start;
+			return t < e.t;
+		}
+	};
+
+private:
+	kdTraversal traversal;
+	std::vector<Node> nodes;
+	std::vector<int32_t> objectIndices;
+	std::vector<RopeLeaf> ropeLeaves;
+	glm::vec3 rootLower, rootUpper;
+	int maxDepth;
+
+	// box of every object, computed once for the build
+	std::vector<glm::vec3> objLower, objUpper;
+
+	// recursively builds the node for the given objects inside the 
+	// cell [lower, upper]. edges is scratch space for the SAH sweep
+	void build(glm::vec3 lower, glm::vec3 upper, 
+		std::vector<int>& objs, int depth, int badRefines, 
+		std::vector<BoundEdge>& edges);
+
+	void makeLeaf(const std::vector<int>& objs);
+
+	// Hands each leaf the ropes of its cell. A rope pointing at an 
+	// interior node is pushed down the tree as long as only one of 
+	// its children touches the face, so traversal starts closer to
+	// the leaf it needs
+	void buildRopes(int idx, int ropes[6], glm::vec3 lower, 
+		glm::vec3 upper);
+
+	void optimizeRope(int& rope, int face, const glm::vec3& lower, 
+		const glm::vec3& upper) const;
+
+	// tests the leaf's objects, tNear & co. are updated on closer
+	// hits. with anyHit it returns true on the first hit < tNear
+	bool intersectLeaf(int offset, int count, const glm::vec3& orig,
+		const glm::vec3& dir, float& tNear, int& index, glm::vec2& uv,
+		Object** hitObject, bool anyHit) const;
+
+	// traversals of the bounded part, called after the unbounded 
+	// set has had its go (hitObject/tNear already set by it)
+	bool findIntersectionRopes(glm::vec3 orig, glm::vec3 dir,
+		float& tNear, int& index, glm::vec2& uv,
+		Object** hitObject, bool anyHit) const;
+
+	bool findIntersectionStack(glm::vec3 orig, glm::vec3 dir,
+		float& tNear, int& index, glm::vec2& uv,
+		Object** hitObject, bool anyHit) const;
+
+public:
+	KdTree(std::vector<Object*>& objs, 
+		kdTraversal kdTraversalType = KDTREE_DEFAULT_TRAVERSAL);
+
+	~KdTree();
+
+	bool findIntersection(glm::vec3 orig, glm::vec3 dir,
+		float& tNear, int& index, glm::vec2& uv,
+		Object** hitObject) const;
+
+	bool occluded(glm::vec3 orig, glm::vec3 dir, float tMax) const;
+
+	Bbox getBounds() const;
+
+	// the split planes are placed around the objects' boxes, 
+	// so moving them always asks for a rebuild
+	bool refit();
+
+	int getNodeCount() const;
+
+	kdTraversal getTraversal() const;
+
+	// bytes taken by the nodes, object references and ropes
+	size_t getMemoryUsage() const;
+};
+#endif
\ No newline at end of file
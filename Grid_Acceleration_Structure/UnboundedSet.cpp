@@ -0,0 +1,109 @@
+#include "UnboundedSet.h"
+#include "../Render/RenderStats.h"
+
+UnboundedSet::UnboundedSet() {
+}
+
+void UnboundedSet::add(Object* obj) {
+	glm::vec3 normal, point;
+	if (obj->getPlane(normal, point)) {
+		normalX.push_back(normal.x);
+		normalY.push_back(normal.y);
+		normalZ.push_back(normal.z);
+		pointX.push_back(point.x);
+		pointY.push_back(point.y);
+		pointZ.push_back(point.z);
+		planes.push_back(obj);
+	}
+	else {
+		others.push_back(obj);
+	}
+}
+
+bool UnboundedSet::findIntersection(glm::vec3 orig, glm::vec3 dir,
+	float& tNear, int& index, glm::vec2& uv,
+	Object** hitObject) const {
+
+	*hitObject = nullptr;
+	TraversalStats stats;
+	stats.primitives(size());
+	float t[UNBOUNDED_PLANE_BATCH];
+	int numPlanes = (int)planes.size();
+	for (int start = 0; start < numPlanes; start += UNBOUNDED_PLANE_BATCH) {
+		int count = std::min(UNBOUNDED_PLANE_BATCH, numPlanes - start);
+		intersectPlanes(&normalX[start], &normalY[start], &normalZ[start],
+			&pointX[start], &pointY[start], &pointZ[start], 
+			count, orig, dir, t);
+		for (int i = 0; i < count; ++i) {
+			// planes don't report an index or uv
+			if (t[i] < tNear) {
+				tNear = t[i];
+				*hitObject = planes[start + i];
+			}
+		}
+	}
+
+	int indexK;
+	glm::vec2 uvK;
+	for (int k = 0; k < others.size(); ++k) {
+		float tCurrNearest = FLT_MAX;
+		if (others[k]->findIntersection(orig, dir, tCurrNearest, indexK, uvK)
+			&& tCurrNearest < tNear) {
+			tNear = tCurrNearest;
+			index = indexK;
+			uv = uvK;
+			*hitObject = others[k];
+		}
+	}
+	return (*hitObject != nullptr);
+}
+
+bool UnboundedSet::occluded(glm::vec3 orig, glm::vec3 dir, float tMax) const {
+	TraversalStats stats;
+	float t[UNBOUNDED_PLANE_BATCH];
+	int numPlanes = (int)planes.size();
+	for (int start = 0; start < numPlanes; start += UNBOUNDED_PLANE_BATCH) {
+		int count = std::min(UNBOUNDED_PLANE_BATCH, numPlanes - start);
+		intersectPlanes(&normalX[start], &normalY[start], &normalZ[start],
+			&pointX[start], &pointY[start], &pointZ[start], 
+			count, orig, dir, t);
+		stats.primitives(count);
+		for (int i = 0; i < count; ++i) {
+			if (t[i] < tMax) return true;
+		}
+	}
+
+	int index;
+	glm::vec2 uv;
+	for (int k = 0; k < others.size(); ++k) {
+		float t = FLT_MAX;
+		stats.primitives(1);
+		if (others[k]->findIntersection(orig, dir, t, index, uv) 
+			&& t < tMax) {
+			return true;
+		}
+	}
+	return false;
+}
+
+Bbox UnboundedSet::getBounds() const {
+	Bbox bounds;
+	if (!empty()) {
+		bounds.extendBy(glm::vec3(-FLT_MAX, -FLT_MAX, FLT_MAX));
+		bounds.extendBy(glm::vec3(FLT_MAX, FLT_MAX, -FLT_MAX));
+	}
+	return bounds;
+}
+
+bool UnboundedSet::empty() const {
+	return planes.empty() && others.empty();
+}
+
+int UnboundedSet::size() const {
+	return (int)(planes.size() + others.size());
+}
+
+void UnboundedSet::getObjects(std::vector<Object*>& list) const {
+	list.insert(list.end(), planes.begin(), planes.end());
+	list.insert(list.end(), others.begin(), others.end());
+}
\ No newline at end of file
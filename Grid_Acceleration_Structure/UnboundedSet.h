@@ -0,0 +1,55 @@
+#ifndef _UNBOUNDED_SET_H_
+#define _UNBOUNDED_SET_H_
+
+#include <vector>
+#include "../Shapes_and_globals/Object.h"
+#include "../Shapes_and_globals/BatchIntersect.h"
+
+// planes are tested this many at a time, see findIntersection()
+#define UNBOUNDED_PLANE_BATCH 8
+
+// Primitives with infinite bounds (planes) kept out of the bounded 
+// acceleration structures. Inside a BVH/grid an infinite box blows 
+// up the scene bounds and ends up overlapping every node/cell, so 
+// we test them here instead: before the bounded traversal, so a 
+// plane hit clips tNear and culls everything behind it. 
+// Planes are stored as a struct of arrays and intersected in 
+// batches by intersectPlanes() (BatchIntersect.h), other unbounded 
+// objects (e.g. an Instance of a prototype holding a plane) go 
+// through their own findIntersection()
+class UnboundedSet {
+private:
+	// plane normal & a point on the plane, one array per component
+	std::vector<float> normalX, normalY, normalZ;
+	std::vector<float> pointX, pointY, pointZ;
+	std::vector<Object*> planes;
+
+	std::vector<Object*> others;
+
+public:
+	UnboundedSet();
+
+	// stores the object in the plane arrays if it is one
+	// (see Object::getPlane), else in the fallback list
+	void add(Object* obj);
+
+	// Same contract as AccelerationStructure::findIntersection: 
+	// tNear is the max distance on the way in and is only 
+	// overwritten by closer hits. hitObject is reset to nullptr, 
+	// so call this before the bounded traversal
+	bool findIntersection(glm::vec3 orig, glm::vec3 dir,
+		float& tNear, int& index, glm::vec2& uv,
+		Object** hitObject) const;
+
+	bool occluded(glm::vec3 orig, glm::vec3 dir, float tMax) const;
+
+	// infinite if there's anything in the set
+	Bbox getBounds() const;
+
+	bool empty() const;
+	int size() const;
+	// appends the planes, then the other objects
+	void getObjects(std::vector<Object*>& list) const;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,332 @@
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include "../Shapes_and_globals/Sphere.h"
+#include "../Shapes_and_globals/Box.h"
+#include "../Shapes_and_globals/Plane.h"
+#include "../Shapes_and_globals/Rect.h"
+#include "../Shapes_and_globals/BatchIntersect.h"
+#include "../Grid_Acceleration_Structure/Bbox.h"
+
+// Every ray is tested against one "leaf" of KERNEL_BATCH primitives 
+// clustered around the point it's aimed at, like the primitive tests 
+// at a BVH leaf / grid cell: a few hits among mostly misses. The 
+// scalar variant calls each object's findIntersection(), the simd 
+// variant runs the struct-of-arrays kernel from BatchIntersect.h 
+// over the whole leaf at once.
+#define KERNEL_BATCH 8
+#define KERNEL_RAYS 1024
+#define KERNEL_TESTS (KERNEL_RAYS * KERNEL_BATCH)
+
+namespace {
+
+// coherent -- camera rays from one origin sweeping a grid of leaves
+// random -- random origins, each aimed somewhere into its leaf
+// grazing -- random origins, aimed at the silhouette of the leaf's 
+//            first primitive (planes/rects: nearly edge-on)
+enum rayDistribution { COHERENT_RAYS, RANDOM_RAYS, GRAZING_RAYS, 
+	NUM_DISTRIBUTIONS };
+
+const char* distributionNames[] = { "coherent", "random", "grazing" };
+
+struct SoA3 {
+	std::vector<float> x, y, z;
+	void push_back(const glm::vec3& v) {
+		x.push_back(v.x);
+		y.push_back(v.y);
+		z.push_back(v.z);
+	}
+};
+
+// the objects, the same primitives as struct of arrays, and the rays
+struct KernelScene {
+	std::vector<glm::vec3> orig, dir, inverseDir;
+
+	std::vector<Sphere> spheres;
+	SoA3 sphereCenter;
+	std::vector<float> sphereRadius;
+
+	std::vector<Box> boxes;
+	std::vector<Bbox> bboxes;
+	SoA3 boxLower, boxUpper;
+
+	std::vector<Plane> planes;
+	SoA3 planeNormal, planePoint;
+
+	std::vector<Rect> rects;
+	SoA3 rectCorner, rectNormal, rectEdge1, rectEdge2;
+	std::vector<float> rectEdge1LenSq, rectEdge2LenSq;
+	std::vector<float> rectEdge1Len, rectEdge2Len;
+};
+
+glm::vec3 randomUnit(std::mt19937& rng) {
+	std::normal_distribution<float> gauss(.0f, 1.0f);
+	return normalize(glm::vec3(gauss(rng), gauss(rng), gauss(rng)));
+}
+
+// any unit vector perpendicular to v
+glm::vec3 perpendicular(const glm::vec3& v, std::mt19937& rng) {
+	glm::vec3 p = cross(v, randomUnit(rng));
+	return dot(p, p) > 1e-6f ? normalize(p) : perpendicular(v, rng);
+}
+
+KernelScene* makeScene(rayDistribution distribution) {
+	KernelScene* scene = new KernelScene();
+	std::mt19937 rng(7 + distribution);
+	std::uniform_real_distribution<float> unit(.0f, 1.0f);
+	std::uniform_real_distribution<float> cube(-10.0f, 10.0f);
+	scene->spheres.reserve(KERNEL_TESTS);
+	scene->boxes.reserve(KERNEL_TESTS);
+	scene->planes.reserve(KERNEL_TESTS);
+	scene->rects.reserve(KERNEL_TESTS);
+
+	for (int j = 0; j < KERNEL_RAYS; ++j) {
+		glm::vec3 center, orig;
+		if (distribution == COHERENT_RAYS) {
+			// 32 x 32 leaves in front of the camera, rays in scanline order
+			center = glm::vec3((j % 32) / 31.0f * 16.0f - 8.0f,
+				(j / 32) / 31.0f * 9.0f - 4.5f, -12.0f);
+			orig = glm::vec3(.0f);
+		}
+		else {
+			center = glm::vec3(cube(rng), cube(rng), cube(rng));
+			do {
+				orig = glm::vec3(cube(rng), cube(rng), cube(rng));
+			} while (length(center - orig) < 4.0f);
+		}
+
+		glm::vec3 target = center + randomUnit(rng) * .5f * unit(rng);
+		glm::vec3 dir = normalize(target - orig);
+		glm::vec3 firstPos, firstNormal;
+		for (int k = 0; k < KERNEL_BATCH; ++k) {
+			glm::vec3 pos = center + randomUnit(rng) * 1.5f * unit(rng);
+			float size = .2f + .3f * unit(rng);
+			if (k == 0 && distribution == GRAZING_RAYS) {
+				// just touch the sphere (and the edge of the box)
+				glm::vec3 toPrim = normalize(pos - orig);
+				dir = normalize(pos + perpendicular(toPrim, rng) * size - orig);
+			}
+			// grazing planes & rects are almost edge-on to the ray
+			glm::vec3 normal = distribution == GRAZING_RAYS ?
+				normalize(perpendicular(dir, rng) + dir * .01f) : 
+				randomUnit(rng);
+
+			Color col(.5f, .5f, .5f, .0f);
+			scene->spheres.push_back(Sphere(pos, size, col, 1.5f, DIFFUSE));
+			scene->sphereCenter.push_back(pos);
+			scene->sphereRadius.push_back(size);
+
+			Box box(pos, size * 2.0f, col, 1.5f, DIFFUSE);
+			scene->boxes.push_back(box);
+			Bbox bbox;
+			bbox.minBounds = box.bounds[0];
+			bbox.maxBounds = box.bounds[1];
+			scene->bboxes.push_back(bbox);
+			scene->boxLower.push_back(bbox.getLower());
+			scene->boxUpper.push_back(bbox.getUpper());
+
+			scene->planes.push_back(Plane(normal, pos, col, DIFFUSE));
+			scene->planeNormal.push_back(normalize(normal));
+			scene->planePoint.push_back(pos);
+
+			glm::vec3 edge1 = perpendicular(normal, rng) * size * 2.0f;
+			glm::vec3 edge2 = normalize(cross(normal, edge1)) * size * 2.0f;
+			glm::vec3 corner = pos - (edge1 + edge2) * .5f;
+			scene->rects.push_back(Rect(corner, edge1, edge2, col, DIFFUSE));
+			scene->rectCorner.push_back(corner);
+			scene->rectNormal.push_back(normalize(cross(edge1, edge2)));
+			scene->rectEdge1.push_back(edge1);
+			scene->rectEdge2.push_back(edge2);
+			scene->rectEdge1LenSq.push_back(dot(edge1, edge1));
+			scene->rectEdge2LenSq.push_back(dot(edge2, edge2));
+			scene->rectEdge1Len.push_back(length(edge1));
+			scene->rectEdge2Len.push_back(length(edge2));
+		}
+		scene->orig.push_back(orig);
+		scene->dir.push_back(dir);
+		scene->inverseDir.push_back(1.0f / dir);
+	}
+	return scene;
+}
+
+const KernelScene& getScene(rayDistribution distribution) {
+	static std::unique_ptr<KernelScene> scenes[NUM_DISTRIBUTIONS];
+	if (!scenes[distribution]) {
+		scenes[distribution].reset(makeScene(distribution));
+	}
+	return *scenes[distribution];
+}
+
+// the scalar routines, one primitive at a time: t = FLT_MAX on a miss
+float sphereScalar(KernelScene& s, int ray, int prim) {
+	float t = FLT_MAX;
+	int index;
+	glm::vec2 uv;
+	return s.spheres[prim].findIntersection(s.orig[ray], s.dir[ray], 
+		t, index, uv) ? t : FLT_MAX;
+}
+
+float boxScalar(KernelScene& s, int ray, int prim) {
+	float t = FLT_MAX;
+	int index;
+	glm::vec2 uv;
+	return s.boxes[prim].findIntersection(s.orig[ray], s.dir[ray], 
+		t, index, uv) ? t : FLT_MAX;
+}
+
+float bboxScalar(KernelScene& s, int ray, int prim) {
+	float t = FLT_MAX;
+	return s.bboxes[prim].findIntersection(s.orig[ray], s.dir[ray], t) ? 
+		t : FLT_MAX;
+}
+
+float planeScalar(KernelScene& s, int ray, int prim) {
+	float t = FLT_MAX;
+	int index;
+	glm::vec2 uv;
+	return s.planes[prim].findIntersection(s.orig[ray], s.dir[ray], 
+		t, index, uv) ? t : FLT_MAX;
+}
+
+float rectScalar(KernelScene& s, int ray, int prim) {
+	float t = FLT_MAX;
+	int index;
+	glm::vec2 uv;
+	return s.rects[prim].findIntersection(s.orig[ray], s.dir[ray], 
+		t, index, uv) ? t : FLT_MAX;
+}
+
+// the batch kernels over the leaf starting at primitive "first"
+void sphereBatch(const KernelScene& s, int ray, int first, float* t) {
+	intersectSpheres(&s.sphereCenter.x[first], &s.sphereCenter.y[first],
+		&s.sphereCenter.z[first], &s.sphereRadius[first], KERNEL_BATCH,
+		s.orig[ray], s.dir[ray], t);
+}
+
+void boxBatch(const KernelScene& s, int ray, int first, float* t) {
+	intersectBoxes(&s.boxLower.x[first], &s.boxLower.y[first],
+		&s.boxLower.z[first], &s.boxUpper.x[first], &s.boxUpper.y[first],
+		&s.boxUpper.z[first], KERNEL_BATCH, 
+		s.orig[ray], s.inverseDir[ray], t);
+}
+
+void planeBatch(const KernelScene& s, int ray, int first, float* t) {
+	intersectPlanes(&s.planeNormal.x[first], &s.planeNormal.y[first],
+		&s.planeNormal.z[first], &s.planePoint.x[first], 
+		&s.planePoint.y[first], &s.planePoint.z[first], KERNEL_BATCH,
+		s.orig[ray], s.dir[ray], t);
+}
+
+void rectBatch(const KernelScene& s, int ray, int first, float* t) {
+	intersectRects(&s.rectCorner.x[first], &s.rectCorner.y[first],
+		&s.rectCorner.z[first], &s.rectNormal.x[first], 
+		&s.rectNormal.y[first], &s.rectNormal.z[first],
+		&s.rectEdge1.x[first], &s.rectEdge1.y[first], &s.rectEdge1.z[first],
+		&s.rectEdge2.x[first], &s.rectEdge2.y[first], &s.rectEdge2.z[first],
+		&s.rectEdge1LenSq[first], &s.rectEdge2LenSq[first],
+		&s.rectEdge1Len[first], &s.rectEdge2Len[first], KERNEL_BATCH,
+		s.orig[ray], s.dir[ray], t);
+}
+
+struct Kernel {
+	const char* name;
+	float (*scalar)(KernelScene& s, int ray, int prim);
+	void (*batch)(const KernelScene& s, int ray, int first, float* t);
+};
+
+// Bbox::findIntersection is the same slab test as Box, so both share 
+// the intersectBoxes kernel
+const Kernel kernels[] = {
+	{ "sphere", sphereScalar, sphereBatch },
+	{ "box", boxScalar, boxBatch },
+	{ "bbox", bboxScalar, boxBatch },
+	{ "plane", planeScalar, planeBatch },
+	{ "rect", rectScalar, rectBatch },
+};
+
+void setCounters(benchmark::State& state, long long hits) {
+	long long tests = (long long)state.iterations() * KERNEL_TESTS;
+	state.SetItemsProcessed(tests);
+	// shows as e.g. "12.3ns" per ray-primitive test
+	state.counters["perTest"] = benchmark::Counter((double)tests,
+		benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+	state.counters["hitRate"] = tests > 0 ? (double)hits / tests : .0;
+}
+
+void benchScalar(benchmark::State& state, const Kernel* kernel, 
+	rayDistribution distribution) {
+	KernelScene& scene = const_cast<KernelScene&>(getScene(distribution));
+	long long hits = 0;
+	for (auto _ : state) {
+		for (int j = 0; j < KERNEL_RAYS; ++j) {
+			for (int k = 0; k < KERNEL_BATCH; ++k) {
+				float t = kernel->scalar(scene, j, j * KERNEL_BATCH + k);
+				hits += t < FLT_MAX;
+				benchmark::DoNotOptimize(t);
+			}
+		}
+	}
+	setCounters(state, hits);
+}
+
+void benchBatch(benchmark::State& state, const Kernel* kernel, 
+	simdLevel level, rayDistribution distribution) {
+	KernelScene& scene = const_cast<KernelScene&>(getScene(distribution));
+	setBatchKernelLevel(level);
+
+	// the kernels promise the scalar results bit for bit, check it 
+	// before timing anything
+	float t[KERNEL_BATCH];
+	for (int j = 0; j < KERNEL_RAYS; ++j) {
+		kernel->batch(scene, j, j * KERNEL_BATCH, t);
+		for (int k = 0; k < KERNEL_BATCH; ++k) {
+			if (t[k] != kernel->scalar(scene, j, j * KERNEL_BATCH + k)) {
+				state.SkipWithError("batch kernel disagrees with scalar");
+				return;
+			}
+		}
+	}
+
+	long long hits = 0;
+	for (auto _ : state) {
+		for (int j = 0; j < KERNEL_RAYS; ++j) {
+			kernel->batch(scene, j, j * KERNEL_BATCH, t);
+			for (int k = 0; k < KERNEL_BATCH; ++k) {
+				hits += t[k] < FLT_MAX;
+			}
+			benchmark::DoNotOptimize(t);
+		}
+	}
+	setCounters(state, hits);
+}
+
+}
+
+// registered as <kernel>/<scalar|simd-LEVEL>/<ray distribution> 
+// with one simd entry per instruction set this cpu has, e.g. 
+// --benchmark_filter=sphere/ to only run the sphere kernels
+int main(int argc, char** argv) {
+	simdLevel supported = detectSimdLevel();
+	for (const Kernel& kernel : kernels) {
+		for (int d = 0; d < NUM_DISTRIBUTIONS; ++d) {
+			std::string suffix = std::string("/") + distributionNames[d];
+			benchmark::RegisterBenchmark(
+				(std::string(kernel.name) + "/scalar" + suffix).c_str(),
+				benchScalar, &kernel, (rayDistribution)d);
+			for (int l = 0; l <= supported; ++l) {
+				benchmark::RegisterBenchmark((std::string(kernel.name) + 
+					"/simd-" + simdLevelName((simdLevel)l) + suffix).c_str(),
+					benchBatch, &kernel, (simdLevel)l, (rayDistribution)d);
+			}
+		}
+	}
+	benchmark::AddCustomContext("dispatchedSimd", 
+		simdLevelName(batchKernelLevel()));
+	benchmark::Initialize(&argc, argv);
+	if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+	benchmark::RunSpecifiedBenchmarks();
+	benchmark::Shutdown();
+	return 0;
+}
\ No newline at end of file
@@ -61,6 +61,9 @@ glm::vec3 Light::getEdgeB()
 
 glm::vec3 Light::setLightPos(glm::vec3 pos)
 {
+	if (type == AREA_LIGHT) {
+		corner = pos;
+	}
 	return lightPos = pos;
 }
 
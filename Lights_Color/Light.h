@@ -23,6 +23,8 @@ public:
 		glm::vec3 a, glm::vec3 b);
 
 	//virtual glm::vec3 getLightDir();
+	// area lights are placed by their corner, 
+	// which is what these get & set for them
 	glm::vec3 getLightPos();
 	glm::vec3 setLightPos(glm::vec3 pos);
 
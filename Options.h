@@ -1,11 +1,18 @@
 #ifndef _OPTIONS_H_
 #define _OPTIONS_H_
 
+#include <stdint.h>
+#include <string>
 #include <glm/glm.hpp>
 #include "Lights_Color/Color.h"
+#include "Grid_Acceleration_Structure/AccelerationStructure.h"
+#include "Render/Heatmap.h"
+#include "Render/AOV.h"
 
 #define MAX_RECURSION_DEPTH 8
 #define STARTING_DEPTH 0
+// width & height (pixels) of the tiles handed out to render threads
+#define RENDER_TILE_SIZE 16
 
 class Options {
 private:
@@ -28,9 +35,115 @@ public:
 	glm::vec3 cameraRight;
 
 	bool softShadows;
+	// structure built over the scene objects before rendering
+	accelType accelStructure;
+	// render threads, 0 uses one per hardware thread
+	int numThreads;
+	// per tile / per pixel timing written out next to the image
+	heatmapMode heatmap;
+	// chrome trace event timeline of the render phases, "" for none
+	std::string traceFile;
+	// seconds between progress / ETA reports while rendering, 0 is 
+	// quiet. progressJSON adds a machine readable line on stderr
+	float progressInterval;
+	bool progressJSON;
+	// only renders tiles [firstTile, firstTile + tileCount) of the 
+	// frame (RENDER_TILE_SIZE tiles numbered row by row), tileCount 
+	// < 0 renders all of them. Used to split a frame across processes
+	int firstTile;
+	int tileCount;
+	// picks the per pixel random streams, the same seed gives the 
+	// same image whatever renders which tile
+	uint64_t seed;
+	// finished tiles are saved here every checkpointInterval seconds, 
+	// a render of the same frame resumes from it. "" for none
+	std::string checkpointFile;
+	float checkpointInterval;
+	// progressive mode: one sample per pixel per pass over the whole 
+	// frame, averaged as it goes. Stops after progressiveSamples 
+	// passes (0: sampleNum^2), progressiveTimeBudget seconds or once 
+	// the estimated relative noise is under progressiveNoiseTarget 
+	// (0: no limit), whichever comes first
+	bool progressive;
+	int progressiveSamples;
+	float progressiveTimeBudget;
+	float progressiveNoiseTarget;
+	// progressive previews go to previewFile ("" for none) every 
+	// previewPasses passes or previewInterval seconds (0: never)
+	std::string previewFile;
+	int previewPasses;
+	float previewInterval;
+	// > 1 renders that many views circling the vertical axis through 
+	// turntableCenter (the first is the camera above) in one batch
+	int turntableViews;
+	glm::vec3 turntableCenter;
+	// > 0 renders that many frames of an animation, animationFPS 
+	// frames a second, instead of one image. animationFile holds its 
+	// keyframes ("" for the scene's built-in one, see Animation.h)
+	int animationFrames;
+	float animationFPS;
+	std::string animationFile;
+	// Render::renderReprojected() keeps a pixel's last color when its 
+	// center hit is the same object within reprojectionTolerance 
+	// pixels (at that depth), seen at most reprojectionMaxAngle 
+	// radians from where it was, and carried over for fewer than 
+	// reprojectionMaxAge frames. reproject turns it on for render 
+	// server requests
+	bool reproject;
+	float reprojectionTolerance;
+	float reprojectionMaxAngle;
+	int reprojectionMaxAge;
+	// renderImage() notes which objects each tile's rays hit (see 
+	// TileFootprint), so Render::renderEdited() can redo only the 
+	// tiles a color or material edit shows up in
+	bool recordFootprint;
+	// startRender() runs the frame through a Denoiser, guided by the 
+	// first hit features renderImage() or renderProgressive() records 
+	// (see Denoiser.h) in denoiseIterations passes (clamped to 1-8). 
+	// denoiseStrength is how different two colors (0-1 RGB distance) 
+	// get before the first pass stops averaging them, halving each pass
+	bool denoise;
+	int denoiseIterations;
+	float denoiseStrength;
+	// AOV_* mask of the first hit buffers renderImage() or 
+	// renderProgressive() fills (Render::aovs), written next to the 
+	// image. AOV_NONE records nothing
+	unsigned aovs;
+	// scenes with more lights than lightSamples (> 0) shade that many 
+	// per hit, picked from a LightTree by how much each can light the 
+	// point, instead of all of them. 0 always shades every light
+	int lightSamples;
 	// default constructor
 	Options() {
 		softShadows = true;
+		accelStructure = BVH_ACCEL;
+		numThreads = 0;
+		heatmap = HEATMAP_OFF;
+		progressInterval = 2.0f;
+		progressJSON = false;
+		firstTile = 0;
+		tileCount = -1;
+		seed = 0;
+		checkpointInterval = 60.0f;
+		progressive = false;
+		progressiveSamples = 0;
+		progressiveTimeBudget = .0f;
+		progressiveNoiseTarget = .0f;
+		previewPasses = 0;
+		previewInterval = 5.0f;
+		turntableViews = 0;
+		animationFrames = 0;
+		animationFPS = 24.0f;
+		reproject = false;
+		reprojectionTolerance = 1.0f;
+		reprojectionMaxAngle = M_PI * (2.0f / 180.0f);
+		reprojectionMaxAge = 8;
+		recordFootprint = false;
+		denoise = false;
+		denoiseIterations = 5;
+		denoiseStrength = .35f;
+		aovs = AOV_NONE;
+		lightSamples = 0;
 		selectScene = 1;
 		sampleNum = 12;
 		width = 1080;
@@ -49,6 +162,7 @@ public:
 		cameraForward = glm::vec3(.0f, .0f, -1.0f);
 		cameraReferUp = glm::vec3(.0f, 1.0f, .0f);
 		cameraRight = glm::vec3(1.0f, .0f, .0f);
+		turntableCenter = glm::vec3(.0f, .0f, -3.0f);
 
 		//cameraPos = glm::vec3(.0f, 0.f, 0.0f);
 		//cameraForward = glm::vec3(.0f, -.10f, -1.0f); 
@@ -0,0 +1,139 @@
+#include "AOV.h"
+#include <fstream>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+AOVBuffers::AOVBuffers() : width(0), height(0), enabled(AOV_NONE) {
+}
+
+void AOVBuffers::reset(int frameWidth, int frameHeight, unsigned aovs,
+	const std::vector<Object*>& sceneObjects) {
+	width = frameWidth;
+	height = frameHeight;
+	enabled = aovs;
+	size_t pixels = (size_t)width * height;
+	// planes of disabled AOVs are freed
+	for (int c = 0; c < 3; ++c) {
+		albedo[c].assign((aovs & AOV_ALBEDO) ? pixels : 0, .0f);
+		normal[c].assign((aovs & AOV_NORMAL) ? pixels : 0, .0f);
+	}
+	depth.assign((aovs & AOV_DEPTH) ? pixels : 0, .0f);
+	specular.assign((aovs & AOV_SPECULAR) ? pixels : 0, .0f);
+	objectId.assign((aovs & AOV_OBJECT_ID) ? pixels : 0, -1);
+	materialId.assign((aovs & AOV_MATERIAL_ID) ? pixels : 0, -1);
+	samples.assign((aovs & AOV_SAMPLES) ? pixels : 0, 0);
+	objectIndex.clear();
+	if (aovs & AOV_OBJECT_ID) {
+		for (int i = 0; i < sceneObjects.size(); ++i) {
+			objectIndex[sceneObjects[i]] = i;
+		}
+	}
+}
+
+bool AOVBuffers::has(unsigned aovs) const {
+	return (enabled & aovs) == aovs;
+}
+
+void AOVBuffers::store(int x, int y, const FirstHitSample& sample) {
+	size_t i = (size_t)y * width + x;
+	float inv = sample.count > 0 ? 1.0f / sample.count : .0f;
+	if (enabled & AOV_ALBEDO) {
+		for (int c = 0; c < 3; ++c) {
+			albedo[c][i] = sample.albedo[c] * inv;
+		}
+	}
+	if (enabled & AOV_NORMAL) {
+		glm::vec3 n = sample.normal;
+		float length = sqrt(dot(n, n));
+		if (length > .0f) n = n * (1.0f / length);
+		for (int c = 0; c < 3; ++c) {
+			normal[c][i] = n[c];
+		}
+	}
+	if (enabled & AOV_DEPTH) {
+		depth[i] = sample.depth * inv;
+	}
+	if (enabled & AOV_SPECULAR) {
+		specular[i] = sample.specular * inv;
+	}
+	if (enabled & AOV_OBJECT_ID) {
+		std::unordered_map<const Object*, int>::const_iterator it = 
+			objectIndex.find(sample.object);
+		objectId[i] = it != objectIndex.end() ? it->second : -1;
+	}
+	if (enabled & AOV_MATERIAL_ID) {
+		materialId[i] = sample.material;
+	}
+	if (enabled & AOV_SAMPLES) {
+		samples[i] = sample.count;
+	}
+}
+
+const char* AOVBuffers::name(unsigned aov) {
+	switch (aov) {
+	case AOV_DEPTH: return "depth";
+	case AOV_NORMAL: return "normal";
+	case AOV_ALBEDO: return "albedo";
+	case AOV_OBJECT_ID: return "object";
+	case AOV_MATERIAL_ID: return "material";
+	case AOV_SAMPLES: return "samples";
+	case AOV_SPECULAR: return "specular";
+	default: return "unknown";
+	}
+}
+
+std::string AOVBuffers::fileName(const std::string& imageName, 
+	unsigned aov) {
+	std::string base = imageName;
+	size_t dot = imageName.find_last_of('.');
+	size_t slash = imageName.find_last_of("/\\");
+	if (dot != std::string::npos && 
+		(slash == std::string::npos || dot > slash)) {
+		base = imageName.substr(0, dot);
+	}
+	return base + "_" + name(aov) + ".pfm";
+}
+
+bool AOVBuffers::write(const std::string& pfmName, unsigned aov) const {
+	if (!has(aov)) return false;
+	// the plane(s) as floats, 1 or 3 channels
+	std::vector<const std::vector<float>*> planes;
+	std::vector<float> converted;
+	if (aov == AOV_NORMAL || aov == AOV_ALBEDO) {
+		const std::vector<float>* rgb = aov == AOV_NORMAL ? normal : albedo;
+		for (int c = 0; c < 3; ++c) planes.push_back(&rgb[c]);
+	}
+	else if (aov == AOV_DEPTH || aov == AOV_SPECULAR) {
+		planes.push_back(aov == AOV_DEPTH ? &depth : &specular);
+	}
+	else {
+		const std::vector<int>& ids = aov == AOV_OBJECT_ID ? objectId : 
+			aov == AOV_MATERIAL_ID ? materialId : samples;
+		converted.assign(ids.begin(), ids.end());
+		planes.push_back(&converted);
+	}
+
+	std::ofstream out(pfmName, std::ios::binary);
+	if (!out) return false;
+	// a negative scale says little endian
+	out << (planes.size() == 3 ? "PF" : "Pf") << "\n" << 
+		width << " " << height << "\n-1.0\n";
+	std::vector<unsigned char> row(width * planes.size() * 4);
+	for (int y = height - 1; y >= 0; --y) {
+		unsigned char* p = row.data();
+		for (int x = 0; x < width; ++x) {
+			for (int c = 0; c < planes.size(); ++c) {
+				float v = (*planes[c])[(size_t)y * width + x];
+				uint32_t bits;
+				memcpy(&bits, &v, 4);
+				*p++ = bits & 0xff;
+				*p++ = (bits >> 8) & 0xff;
+				*p++ = (bits >> 16) & 0xff;
+				*p++ = bits >> 24;
+			}
+		}
+		out.write((const char*)row.data(), row.size());
+	}
+	return (bool)out;
+}
\ No newline at end of file
@@ -0,0 +1,91 @@
+#ifndef _AOV_H_
+#define _AOV_H_
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <glm/glm.hpp>
+#include "../Shapes_and_globals/Object.h"
+
+// Arbitrary output variables: per pixel data about what the pixel's 
+// camera rays hit first, written next to the beauty image for 
+// denoising, compositing & QA. Options::aovs is a mask of these
+enum aovFlags {
+	AOV_NONE = 0,
+	// distance along the ray, 0 where nothing was hit
+	AOV_DEPTH = 1 << 0,
+	// world space, unit length (0 where nothing was hit)
+	AOV_NORMAL = 1 << 1,
+	// surface color (the checkered floor's tiles etc.), the 
+	// background where nothing was hit
+	AOV_ALBEDO = 1 << 2,
+	// index in the scene's object list, -1 where nothing was hit
+	AOV_OBJECT_ID = 1 << 3,
+	// materialType, -1 where nothing was hit
+	AOV_MATERIAL_ID = 1 << 4,
+	// camera rays cast through the pixel
+	AOV_SAMPLES = 1 << 5,
+	// the part of the samples that hit a mirror or glass
+	AOV_SPECULAR = 1 << 6,
+	AOV_ALL = (1 << 7) - 1,
+	// what the Denoiser goes by
+	AOV_DENOISE = AOV_DEPTH | AOV_NORMAL | AOV_ALBEDO | AOV_SPECULAR
+};
+
+// what the camera rays of one pixel hit first, summed over its 
+// samples by Render::castRay() while renderImage() records AOVs
+struct FirstHitSample {
+	glm::vec3 albedo;
+	glm::vec3 normal;
+	float depth;
+	int specular;
+	int count;
+	// the first sample's, object nullptr & material -1 if it missed
+	Object* object;
+	int material;
+	FirstHitSample() : albedo(.0f), normal(.0f), depth(.0f), 
+		specular(0), count(0), object(nullptr), material(-1) {}
+};
+
+// The enabled AOVs of a frame, one plane per channel. Depth, normal, 
+// albedo & specular are averaged over the pixel's samples, the ids 
+// are the first sample's
+class AOVBuffers {
+private:
+	// object -> index in the scene's object list
+	std::unordered_map<const Object*, int> objectIndex;
+
+public:
+	int width, height;
+	// the AOV_* mask of the planes below that are filled, the 
+	// others are empty
+	unsigned enabled;
+	std::vector<float> albedo[3];
+	std::vector<float> normal[3];
+	std::vector<float> depth;
+	std::vector<float> specular;
+	std::vector<int> objectId;
+	std::vector<int> materialId;
+	std::vector<int> samples;
+
+	AOVBuffers();
+	// width * height pixels of nothing hit for the aovs mask, 
+	// sceneObjects is what AOV_OBJECT_ID indexes
+	void reset(int frameWidth, int frameHeight, unsigned aovs, 
+		const std::vector<Object*>& sceneObjects);
+	// true if every AOV in the aovs mask is filled
+	bool has(unsigned aovs) const;
+	// averages pixel (x, y)'s samples into the enabled planes, each 
+	// pixel is written by one thread
+	void store(int x, int y, const FirstHitSample& sample);
+
+	// "depth", "normal" ... for a single AOV_* flag
+	static const char* name(unsigned aov);
+	// fileName with "_<name>.pfm" in place of its extension
+	static std::string fileName(const std::string& imageName, unsigned aov);
+	// writes one enabled AOV as a little endian PFM (floats, bottom 
+	// row first; ids as floats too), false if it couldn't
+	bool write(const std::string& pfmName, unsigned aov) const;
+};
+
+#endif
\ No newline at end of file
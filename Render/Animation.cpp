@@ -0,0 +1,245 @@
+#include "Animation.h"
+#include <stdio.h>
+#include <algorithm>
+#include <sstream>
+
+void AnimationTrack::addKey(float time, glm::vec3 value) {
+	std::vector<float>::iterator it = 
+		std::lower_bound(times.begin(), times.end(), time);
+	size_t i = it - times.begin();
+	if (it != times.end() && *it == time) {
+		values[i] = value;
+		return;
+	}
+	times.insert(it, time);
+	values.insert(values.begin() + i, value);
+}
+
+glm::vec3 AnimationTrack::evaluate(float time) const {
+	if (times.empty()) return glm::vec3(.0f);
+	if (time <= times.front()) return values.front();
+	if (time >= times.back()) return values.back();
+	// first key after time, there's one before it too
+	size_t i = std::upper_bound(times.begin(), times.end(), time) - 
+		times.begin();
+	float s = (time - times[i - 1]) / (times[i] - times[i - 1]);
+	return values[i - 1] + (values[i] - values[i - 1]) * s;
+}
+
+bool Animation::addObjectKey(Object* object, float time, glm::vec3 pos) {
+	for (int i = 0; i < objectTracks.size(); ++i) {
+		if (objectTracks[i].object == object) {
+			objectTracks[i].track.addKey(time, pos);
+			return true;
+		}
+	}
+	ObjectTrack track;
+	if (!object->getPosition(track.rest)) return false;
+	track.object = object;
+	track.current = track.rest;
+	track.track.addKey(time, pos);
+	objectTracks.push_back(track);
+	return true;
+}
+
+void Animation::addLightKey(Light* light, float time, glm::vec3 pos) {
+	for (int i = 0; i < lightTracks.size(); ++i) {
+		if (lightTracks[i].light == light) {
+			lightTracks[i].track.addKey(time, pos);
+			return;
+		}
+	}
+	LightTrack track;
+	track.light = light;
+	track.rest = track.current = light->getLightPos();
+	track.track.addKey(time, pos);
+	lightTracks.push_back(track);
+}
+
+void Animation::addCameraKey(float time, glm::vec3 pos, glm::vec3 target) {
+	cameraPos.addKey(time, pos);
+	cameraTarget.addKey(time, target);
+}
+
+bool Animation::apply(float time) {
+	bool moved = false;
+	for (int i = 0; i < objectTracks.size(); ++i) {
+		ObjectTrack& t = objectTracks[i];
+		glm::vec3 pos = t.track.evaluate(time);
+		if (pos == t.current) continue;
+		t.object->setPosition(pos);
+		t.current = pos;
+		moved = true;
+	}
+	for (int i = 0; i < lightTracks.size(); ++i) {
+		LightTrack& t = lightTracks[i];
+		glm::vec3 pos = t.track.evaluate(time);
+		if (pos == t.current) continue;
+		t.light->setLightPos(pos);
+		t.current = pos;
+	}
+	return moved;
+}
+
+bool Animation::restore() {
+	bool moved = false;
+	for (int i = 0; i < objectTracks.size(); ++i) {
+		ObjectTrack& t = objectTracks[i];
+		if (t.current == t.rest) continue;
+		t.object->setPosition(t.rest);
+		t.current = t.rest;
+		moved = true;
+	}
+	for (int i = 0; i < lightTracks.size(); ++i) {
+		LightTrack& t = lightTracks[i];
+		if (t.current == t.rest) continue;
+		t.light->setLightPos(t.rest);
+		t.current = t.rest;
+	}
+	return moved;
+}
+
+void Animation::cameraAt(float time, glm::vec3& pos, glm::vec3& target) const {
+	pos = cameraPos.evaluate(time);
+	target = cameraTarget.evaluate(time);
+}
+
+float Animation::getDuration() const {
+	float duration = cameraPos.lastTime();
+	for (int i = 0; i < objectTracks.size(); ++i) {
+		duration = std::max(duration, objectTracks[i].track.lastTime());
+	}
+	for (int i = 0; i < lightTracks.size(); ++i) {
+		duration = std::max(duration, lightTracks[i].track.lastTime());
+	}
+	return duration;
+}
+
+bool Animation::empty() const {
+	return objectTracks.empty() && lightTracks.empty() && cameraPos.empty();
+}
+
+bool Animation::parse(std::istream& in, std::vector<Object*>& objects,
+	std::vector<LightSources*>& lights, std::string& error) {
+
+	std::string line;
+	for (int lineNumber = 1; std::getline(in, line); ++lineNumber) {
+		size_t comment = line.find('#');
+		if (comment != std::string::npos) line.erase(comment);
+		std::istringstream words(line);
+		std::string kind;
+		if (!(words >> kind)) continue;
+
+		std::string where = "line " + std::to_string(lineNumber) + ": ";
+		int index = 0;
+		float time;
+		glm::vec3 pos, target;
+		if (kind == "object" || kind == "light") {
+			if (!(words >> index >> time >> pos.x >> pos.y >> pos.z)) {
+				error = where + "expected " + kind + 
+					" <index> <time> <x> <y> <z>";
+				return false;
+			}
+		}
+		else if (kind == "camera") {
+			if (!(words >> time >> pos.x >> pos.y >> pos.z >> 
+				target.x >> target.y >> target.z)) {
+				error = where + "expected camera <time> <x> <y> <z> "
+					"<targetX> <targetY> <targetZ>";
+				return false;
+			}
+		}
+		else {
+			error = where + "unknown key \"" + kind + "\"";
+			return false;
+		}
+		std::string extra;
+		if (words >> extra) {
+			error = where + "unexpected \"" + extra + "\"";
+			return false;
+		}
+
+		if (kind == "object") {
+			if (index < 0 || index >= objects.size()) {
+				error = where + "no object " + std::to_string(index);
+				return false;
+			}
+			if (!addObjectKey(objects[index], time, pos)) {
+				error = where + "object " + std::to_string(index) + 
+					" can't be moved";
+				return false;
+			}
+		}
+		else if (kind == "light") {
+			Light* light = (index >= 0 && index < lights.size()) ?
+				dynamic_cast<Light*>(lights[index]) : nullptr;
+			if (light == nullptr) {
+				error = where + "no light " + std::to_string(index);
+				return false;
+			}
+			addLightKey(light, time, pos);
+		}
+		else {
+			addCameraKey(time, pos, target);
+		}
+	}
+	return true;
+}
+
+Animation Animation::builtIn(int sceneNumber, std::vector<Object*>& objects,
+	std::vector<LightSources*>& lights) {
+
+	Animation animation;
+	glm::vec3 rest;
+	if (sceneNumber == 4) {
+		// a quarter second apart, each sphere goes up 
+		// a unit and back down in a second
+		int hop = 0;
+		for (int i = 0; i < objects.size(); ++i) {
+			if (!objects[i]->getPosition(rest)) continue;
+			float start = .25f * (hop++ % 4);
+			animation.addObjectKey(objects[i], start, rest);
+			animation.addObjectKey(objects[i], start + .5f, 
+				rest + glm::vec3(.0f, 1.0f, .0f));
+			animation.addObjectKey(objects[i], start + 1.0f, rest);
+		}
+		return animation;
+	}
+
+	// left, right & back to the middle over 3 seconds
+	static const float sweepTimes[] = { .0f, 1.0f, 2.0f, 3.0f };
+	static const float sweepOffsets[] = { .0f, -1.5f, 1.5f, .0f };
+	for (int i = 0; i < lights.size(); ++i) {
+		Light* light = dynamic_cast<Light*>(lights[i]);
+		if (light == nullptr) continue;
+		rest = light->getLightPos();
+		for (int k = 0; k < 4; ++k) {
+			animation.addLightKey(light, sweepTimes[k], 
+				rest + glm::vec3(sweepOffsets[k], .0f, .0f));
+		}
+	}
+	// the rects that show the light go along
+	for (int i = 0; i < objects.size(); ++i) {
+		if (objects[i]->getMaterialType() != LIGHT || 
+			!objects[i]->getPosition(rest)) continue;
+		for (int k = 0; k < 4; ++k) {
+			animation.addObjectKey(objects[i], sweepTimes[k], 
+				rest + glm::vec3(sweepOffsets[k], .0f, .0f));
+		}
+	}
+	return animation;
+}
+
+std::string Animation::frameFileName(const std::string& fileName, 
+	int frame) {
+
+	char number[16];
+	snprintf(number, sizeof(number), "_%04d", frame);
+	size_t dot = fileName.find_last_of('.');
+	size_t slash = fileName.find_last_of("/\\");
+	if (dot == std::string::npos || 
+		(slash != std::string::npos && dot < slash)) {
+		return fileName + number;
+	}
+	return fileName.substr(0, dot) + number + fileName.substr(dot);
+}
\ No newline at end of file
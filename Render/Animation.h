@@ -0,0 +1,99 @@
+#ifndef _ANIMATION_H_
+#define _ANIMATION_H_
+
+#include <istream>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+#include "../Shapes_and_globals/Object.h"
+#include "../Lights_Color/Light.h"
+
+// Keyed positions of one thing in the scene: linear in between 
+// keys, held before the first one and after the last
+class AnimationTrack {
+private:
+	// ascending
+	std::vector<float> times;
+	std::vector<glm::vec3> values;
+
+public:
+	// a key at a time that already has one replaces it
+	void addKey(float time, glm::vec3 value);
+
+	glm::vec3 evaluate(float time) const;
+
+	bool empty() const { return times.empty(); }
+	float lastTime() const { return times.empty() ? .0f : times.back(); }
+};
+
+// Where the objects, lights & camera of a scene are over time. 
+// apply() moves them in place: only what has keys is touched, and 
+// only when its position changed since the last frame, so a frame 
+// costs an update of the scene rather than a reload.
+//
+// Description (see parse()), a key per line, '#' starts a comment. 
+// Times are in seconds, positions are absolute world space ones 
+// (Object::setPosition(), an area light's corner), indices count 
+// the objects/lights in the order selectScene() added them: 
+//   object <index> <time> <x> <y> <z>
+//   light <index> <time> <x> <y> <z>
+//   camera <time> <x> <y> <z> <targetX> <targetY> <targetZ>
+class Animation {
+private:
+	struct ObjectTrack {
+		Object* object;
+		// where it was before the animation touched it
+		glm::vec3 rest;
+		glm::vec3 current;
+		AnimationTrack track;
+	};
+	struct LightTrack {
+		Light* light;
+		glm::vec3 rest;
+		glm::vec3 current;
+		AnimationTrack track;
+	};
+	std::vector<ObjectTrack> objectTracks;
+	std::vector<LightTrack> lightTracks;
+	AnimationTrack cameraPos, cameraTarget;
+
+public:
+	// false (and no key) for objects that can't be moved
+	bool addObjectKey(Object* object, float time, glm::vec3 pos);
+	void addLightKey(Light* light, float time, glm::vec3 pos);
+	void addCameraKey(float time, glm::vec3 pos, glm::vec3 target);
+
+	// Moves everything to where it is at time. Returns true if an 
+	// object moved, i.e. the acceleration structure is out of date
+	bool apply(float time);
+
+	// puts everything back where it was before the first apply(), 
+	// returns true if an object moved
+	bool restore();
+
+	bool hasCamera() const { return !cameraPos.empty(); }
+	// the camera position & target at time, only with hasCamera()
+	void cameraAt(float time, glm::vec3& pos, glm::vec3& target) const;
+
+	// time of the last key
+	float getDuration() const;
+	bool empty() const;
+
+	// Adds the keys described in "in" (format above) for the scene 
+	// selectScene() filled objects & lights with. On a bad line 
+	// returns false with error set, keeping the keys before it
+	bool parse(std::istream& in, std::vector<Object*>& objects,
+		std::vector<LightSources*>& lights, std::string& error);
+
+	// The animation of a built-in scene when there's no description: 
+	// scene 4's spheres hop one after another, the other scenes 
+	// sweep their area light (and the rect showing it) side to side
+	static Animation builtIn(int sceneNumber, std::vector<Object*>& objects,
+		std::vector<LightSources*>& lights);
+
+	// fileName with "_<frame>" (4 digits) before the extension
+	static std::string frameFileName(const std::string& fileName, 
+		int frame);
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,289 @@
+#include "Checkpoint.h"
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+
+static const char checkpointMagic[8] = { 'R', 'T', 'C', 'K', 'P', 'T', '0', '2' };
+
+// FNV-1a over the raw bytes of everything that changes the image
+class Fingerprint {
+private:
+	uint64_t hash;
+public:
+	Fingerprint() : hash(14695981039346656037ULL) {}
+
+	template <typename T>
+	void add(const T& value) {
+		const unsigned char* bytes = (const unsigned char*)&value;
+		for (size_t i = 0; i < sizeof(T); ++i) {
+			hash = (hash ^ bytes[i]) * 1099511628211ULL;
+		}
+	}
+
+	uint64_t value() const { return hash; }
+};
+
+// writes the tile's pixels of a plane row by row
+template <typename T>
+static bool writeTile(FILE* file, const std::vector<T>& plane, int width, 
+	int x0, int y0, int x1, int y1) {
+	for (int y = y0; y < y1; ++y) {
+		size_t count = x1 - x0;
+		if (fwrite(plane.data() + (size_t)y * width + x0, sizeof(T), 
+			count, file) != count) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// reads count values onto the end of values
+template <typename T>
+static bool readValues(FILE* file, std::vector<T>& values, size_t count) {
+	size_t offset = values.size();
+	values.resize(offset + count);
+	return fread(values.data() + offset, sizeof(T), count, file) == count;
+}
+
+// copies the tile's pixels of a plane from values, advancing it
+template <typename T>
+static void restoreTile(std::vector<T>& plane, const T*& values, 
+	int width, int x0, int y0, int x1, int y1) {
+	for (int y = y0; y < y1; ++y) {
+		std::copy(values, values + (x1 - x0), 
+			plane.begin() + (size_t)y * width + x0);
+		values += x1 - x0;
+	}
+}
+
+Checkpoint::Checkpoint(const Options& options, size_t numObjects, 
+	size_t numLights, AOVBuffers& aovs) : fileName(options.checkpointFile), 
+	interval(options.checkpointInterval), width(options.width), 
+	height(options.height), aovs(aovs) {
+
+	tilesX = (width + RENDER_TILE_SIZE - 1) / RENDER_TILE_SIZE;
+	numTiles = tilesX * ((height + RENDER_TILE_SIZE - 1) / RENDER_TILE_SIZE);
+	if (enabled()) finished.assign(numTiles, 0);
+	lastSave = std::chrono::steady_clock::now();
+
+	Color background = options.backgroundColor;
+	Fingerprint fp;
+	fp.add(options.width);
+	fp.add(options.height);
+	fp.add(options.fov);
+	fp.add(options.aspectRatio);
+	fp.add(options.ambientLight);
+	fp.add(background.getColorR());
+	fp.add(background.getColorG());
+	fp.add(background.getColorB());
+	fp.add(options.bias);
+	fp.add(options.selectScene);
+	fp.add(options.sampleNum);
+	fp.add(options.cameraPos);
+	fp.add(options.cameraForward);
+	fp.add(options.cameraReferUp);
+	fp.add(options.softShadows);
+	fp.add(options.accelStructure);
+	fp.add(options.seed);
+	fp.add(options.lightSamples);
+	fp.add((uint64_t)numObjects);
+	fp.add((uint64_t)numLights);
+	fp.add(aovs.enabled);
+	fingerprint = fp.value();
+}
+
+void Checkpoint::tileBounds(int tile, int& x0, int& y0, 
+	int& x1, int& y1) const {
+	x0 = (tile % tilesX) * RENDER_TILE_SIZE;
+	y0 = (tile / tilesX) * RENDER_TILE_SIZE;
+	x1 = std::min(x0 + RENDER_TILE_SIZE, width);
+	y1 = std::min(y0 + RENDER_TILE_SIZE, height);
+}
+
+void Checkpoint::aovPlanes(std::vector<std::vector<float>*>& floats, 
+	std::vector<std::vector<int>*>& ints) const {
+	// disabled planes are empty
+	std::vector<float>* floatPlanes[] = { 
+		&aovs.albedo[0], &aovs.albedo[1], &aovs.albedo[2], 
+		&aovs.normal[0], &aovs.normal[1], &aovs.normal[2], 
+		&aovs.depth, &aovs.specular 
+	};
+	std::vector<int>* intPlanes[] = { 
+		&aovs.objectId, &aovs.materialId, &aovs.samples 
+	};
+	for (std::vector<float>* plane : floatPlanes) {
+		if (!plane->empty()) floats.push_back(plane);
+	}
+	for (std::vector<int>* plane : intPlanes) {
+		if (!plane->empty()) ints.push_back(plane);
+	}
+}
+
+int Checkpoint::load(Color* colorBuffer) {
+	if (!enabled()) return 0;
+	// windows saves remove the old file before renaming the new one 
+	// over it, a kill in between leaves only the .tmp (a half written 
+	// one fails the checks below)
+	std::string name = fileName;
+	FILE* file = fopen(name.c_str(), "rb");
+	if (!file) {
+		name = fileName + ".tmp";
+		file = fopen(name.c_str(), "rb");
+	}
+	if (!file) return 0;
+
+	char magic[8];
+	uint64_t fileFingerprint;
+	int32_t header[3];
+	std::vector<unsigned char> fileFinished(numTiles);
+	bool ok = fread(magic, sizeof(magic), 1, file) == 1 &&
+		!memcmp(magic, checkpointMagic, sizeof(magic)) &&
+		fread(&fileFingerprint, sizeof(fileFingerprint), 1, file) == 1 &&
+		fread(header, sizeof(header), 1, file) == 1 &&
+		fileFingerprint == fingerprint && header[0] == width && 
+		header[1] == height && header[2] == numTiles &&
+		fread(fileFinished.data(), 1, numTiles, file) == numTiles;
+	if (!ok) {
+		fclose(file);
+		printf("%s is not a checkpoint of this frame, starting over\n", 
+			name.c_str());
+		return 0;
+	}
+
+	// read everything before touching the frame, a truncated file 
+	// restores nothing
+	std::vector<std::vector<float>*> floatPlanes;
+	std::vector<std::vector<int>*> intPlanes;
+	aovPlanes(floatPlanes, intPlanes);
+	std::vector<double> pixels;
+	std::vector<float> floats;
+	std::vector<int> ints;
+	for (int tile = 0; tile < numTiles && ok; ++tile) {
+		if (!fileFinished[tile]) continue;
+		int x0, y0, x1, y1;
+		tileBounds(tile, x0, y0, x1, y1);
+		size_t count = (size_t)(x1 - x0) * (y1 - y0);
+		ok = readValues(file, pixels, count * 3) &&
+			readValues(file, floats, count * floatPlanes.size()) &&
+			readValues(file, ints, count * intPlanes.size());
+	}
+	fclose(file);
+	if (!ok) {
+		printf("%s is truncated, starting over\n", name.c_str());
+		return 0;
+	}
+
+	int restored = 0;
+	const double* rgb = pixels.data();
+	const float* floatValues = floats.data();
+	const int* intValues = ints.data();
+	for (int tile = 0; tile < numTiles; ++tile) {
+		if (!fileFinished[tile]) continue;
+		int x0, y0, x1, y1;
+		tileBounds(tile, x0, y0, x1, y1);
+		for (int y = y0; y < y1; ++y) {
+			for (int x = x0; x < x1; ++x, rgb += 3) {
+				colorBuffer[y * width + x].setColorR(rgb[0]);
+				colorBuffer[y * width + x].setColorG(rgb[1]);
+				colorBuffer[y * width + x].setColorB(rgb[2]);
+			}
+		}
+		for (std::vector<float>* plane : floatPlanes) {
+			restoreTile(*plane, floatValues, width, x0, y0, x1, y1);
+		}
+		for (std::vector<int>* plane : intPlanes) {
+			restoreTile(*plane, intValues, width, x0, y0, x1, y1);
+		}
+		finished[tile] = 1;
+		restored++;
+	}
+	return restored;
+}
+
+void Checkpoint::tileDone(int tile, const Color* colorBuffer) {
+	if (!enabled()) return;
+	std::vector<unsigned char> snapshot;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		finished[tile] = 1;
+		if (interval <= .0f || std::chrono::duration<float>(
+			std::chrono::steady_clock::now() - lastSave).count() < interval) {
+			return;
+		}
+		lastSave = std::chrono::steady_clock::now();
+		snapshot = finished;
+	}
+	// the snapshot's tiles aren't written any more, so the other 
+	// threads carry on rendering while this one saves
+	writeFile(colorBuffer, snapshot);
+}
+
+bool Checkpoint::save(const Color* colorBuffer) {
+	if (!enabled()) return true;
+	std::vector<unsigned char> snapshot;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		lastSave = std::chrono::steady_clock::now();
+		snapshot = finished;
+	}
+	return writeFile(colorBuffer, snapshot);
+}
+
+bool Checkpoint::writeFile(const Color* colorBuffer, 
+	const std::vector<unsigned char>& tiles) {
+
+	std::lock_guard<std::mutex> lock(fileMutex);
+	std::string tmpName = fileName + ".tmp";
+	FILE* file = fopen(tmpName.c_str(), "wb");
+	if (!file) {
+		printf("Can't write checkpoint %s\n", tmpName.c_str());
+		return false;
+	}
+	int32_t header[3] = { width, height, numTiles };
+	bool ok = fwrite(checkpointMagic, sizeof(checkpointMagic), 1, file) == 1 &&
+		fwrite(&fingerprint, sizeof(fingerprint), 1, file) == 1 &&
+		fwrite(header, sizeof(header), 1, file) == 1 &&
+		fwrite(tiles.data(), 1, numTiles, file) == numTiles;
+
+	std::vector<std::vector<float>*> floatPlanes;
+	std::vector<std::vector<int>*> intPlanes;
+	aovPlanes(floatPlanes, intPlanes);
+	std::vector<double> row;
+	for (int tile = 0; tile < numTiles && ok; ++tile) {
+		if (!tiles[tile]) continue;
+		int x0, y0, x1, y1;
+		tileBounds(tile, x0, y0, x1, y1);
+		row.resize((x1 - x0) * 3);
+		for (int y = y0; y < y1 && ok; ++y) {
+			for (int x = x0; x < x1; ++x) {
+				// Color's getters aren't const
+				Color pixel = colorBuffer[y * width + x];
+				row[(x - x0) * 3 + 0] = pixel.getColorR();
+				row[(x - x0) * 3 + 1] = pixel.getColorG();
+				row[(x - x0) * 3 + 2] = pixel.getColorB();
+			}
+			ok = fwrite(row.data(), sizeof(double), row.size(), file) == 
+				row.size();
+		}
+		for (int i = 0; i < floatPlanes.size() && ok; ++i) {
+			ok = writeTile(file, *floatPlanes[i], width, x0, y0, x1, y1);
+		}
+		for (int i = 0; i < intPlanes.size() && ok; ++i) {
+			ok = writeTile(file, *intPlanes[i], width, x0, y0, x1, y1);
+		}
+	}
+	ok = fclose(file) == 0 && ok;
+	// posix rename() replaces the old file atomically, windows' 
+	// doesn't replace an existing one at all
+	if (ok) {
+#ifdef _WIN32
+		remove(fileName.c_str());
+#endif
+		ok = rename(tmpName.c_str(), fileName.c_str()) == 0;
+	}
+	if (!ok) {
+		printf("Can't write checkpoint %s\n", fileName.c_str());
+		remove(tmpName.c_str());
+	}
+	return ok;
+}
\ No newline at end of file
@@ -0,0 +1,82 @@
+#ifndef _CHECKPOINT_H_
+#define _CHECKPOINT_H_
+
+#include <stdint.h>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "../Options.h"
+#include "../Lights_Color/Color.h"
+#include "AOV.h"
+
+// The finished tiles of a frame, saved every options.checkpointInterval 
+// seconds while rendering so a killed render can pick up where it 
+// left off. Pixels sample from their own random streams (seeded by 
+// pixel index and options.seed), so a finished tile's colors are all 
+// the sampler state there is and the resumed frame comes out bit for 
+// bit the same. The frame's AOVs are saved with the tiles so a 
+// resumed frame's AOV files & denoised image match too.
+//
+// File: "RTCKPT02", a uint64 fingerprint of the options, scene & 
+// AOV mask, int32 width, height & tile count, a byte per tile (1: 
+// finished), then per finished tile in tile order its pixels' RGB 
+// doubles row by row, followed by each enabled AOV plane's floats 
+// or ints (albedo, normal, depth, specular, object, material, 
+// samples) over the tile row by row (host byte order). Saves go to 
+// <file>.tmp first and are renamed over the old one, a kill mid save 
+// keeps the last good one.
+class Checkpoint {
+private:
+	std::string fileName;
+	float interval;
+	int width, height, tilesX, numTiles;
+	uint64_t fingerprint;
+	AOVBuffers& aovs;
+	// a byte per tile, only written by the thread that rendered it
+	std::vector<unsigned char> finished;
+	// guards finished & lastSave
+	std::mutex mutex;
+	// one save at a time
+	std::mutex fileMutex;
+	std::chrono::steady_clock::time_point lastSave;
+
+	// pixel bounds of a tile
+	void tileBounds(int tile, int& x0, int& y0, int& x1, int& y1) const;
+	// the aovs' enabled planes, in file order
+	void aovPlanes(std::vector<std::vector<float>*>& floats, 
+		std::vector<std::vector<int>*>& ints) const;
+	// writes the given finished tiles
+	bool writeFile(const Color* colorBuffer, 
+		const std::vector<unsigned char>& tiles);
+
+public:
+	// disabled when options.checkpointFile is empty. numObjects & 
+	// numLights go into the fingerprint, the scene itself can't. 
+	// aovs are the frame's, already reset for it: their enabled 
+	// planes are saved & restored with the tiles
+	Checkpoint(const Options& options, size_t numObjects, 
+		size_t numLights, AOVBuffers& aovs);
+
+	bool enabled() const { return !fileName.empty(); }
+
+	// fills colorBuffer's (and the aovs') finished tiles from the 
+	// file if there is one for this frame (or its .tmp, left when a 
+	// windows save got killed between removing the old file & 
+	// renaming), returns how many tiles it restored
+	int load(Color* colorBuffer);
+
+	bool isFinished(int tile) const { 
+		return enabled() && finished[tile] != 0; 
+	}
+
+	// marks the tile done, saves when the interval is up. Called by 
+	// the thread that rendered the tile, after writing its pixels
+	void tileDone(int tile, const Color* colorBuffer);
+
+	// saves every tile finished so far, false if the file couldn't 
+	// be written
+	bool save(const Color* colorBuffer);
+};
+
+#endif
\ No newline at end of file
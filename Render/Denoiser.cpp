@@ -0,0 +1,187 @@
+#include "Denoiser.h"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include "Trace.h"
+
+// B3 spline taps
+static const float kernel[5] = { 
+	1.0f / 16.0f, 1.0f / 4.0f, 3.0f / 8.0f, 1.0f / 4.0f, 1.0f / 16.0f 
+};
+
+// exp(-e) for e >= 0 as (1 - e / 64)^64: close enough for filter 
+// weights, and unlike exp() it vectorizes
+static inline float expNeg(float e) {
+	float t = std::max(1.0f - e * (1.0f / 64.0f), .0f);
+	t *= t; t *= t; t *= t; 
+	t *= t; t *= t; t *= t;
+	return t;
+}
+
+Denoiser::Denoiser(const Options& options) {
+	iterations = std::min(std::max(options.denoiseIterations, 1), 
+		DENOISE_MAX_ITERATIONS);
+	colorSigma = options.denoiseStrength;
+	numThreads = options.numThreads;
+	if (numThreads <= 0) {
+		numThreads = std::max(1, (int)std::thread::hardware_concurrency());
+	}
+}
+
+void Denoiser::filterRows(const std::vector<float>* in, 
+	std::vector<float>* out, const AOVBuffers& features, int step, 
+	float invColor, int y0, int y1) const {
+
+	const int width = features.width;
+	const int height = features.height;
+	const float invNormal = 1.0f / DENOISE_NORMAL_SIGMA;
+	const float invDepth = 1.0f / DENOISE_DEPTH_SIGMA;
+	const float invAlbedo = 1.0f / 
+		(DENOISE_ALBEDO_SIGMA * DENOISE_ALBEDO_SIGMA);
+	// a row's sums, tap after tap, and the tap's weights. Every loop 
+	// below runs along a row of planes and stores to few of them so 
+	// it vectorizes
+	std::vector<float> sums(5 * (size_t)width);
+	float* sumR = sums.data();
+	float* sumG = sumR + width;
+	float* sumB = sumG + width;
+	float* sumW = sumB + width;
+	float* weight = sumW + width;
+
+	for (int y = y0; y < y1; ++y) {
+		size_t p = (size_t)y * width;
+		const float* pR = in[0].data() + p;
+		const float* pG = in[1].data() + p;
+		const float* pB = in[2].data() + p;
+		const float* pN0 = features.normal[0].data() + p;
+		const float* pN1 = features.normal[1].data() + p;
+		const float* pN2 = features.normal[2].data() + p;
+		const float* pA0 = features.albedo[0].data() + p;
+		const float* pA1 = features.albedo[1].data() + p;
+		const float* pA2 = features.albedo[2].data() + p;
+		const float* pZ = features.depth.data() + p;
+		const float* pS = features.specular.data() + p;
+		// the center tap, weight 1 times its kernel value
+		float center = kernel[2] * kernel[2];
+		for (int x = 0; x < width; ++x) {
+			sumR[x] = pR[x] * center;
+			sumG[x] = pG[x] * center;
+			sumB[x] = pB[x] * center;
+			sumW[x] = center;
+		}
+		for (int dy = -2; dy <= 2; ++dy) {
+			int yq = y + dy * step;
+			// taps off the image are left out
+			if (yq < 0 || yq >= height) continue;
+			for (int dx = -2; dx <= 2; ++dx) {
+				if (dx == 0 && dy == 0) continue;
+				int offset = dx * step;
+				int xBegin = std::max(0, -offset);
+				int xEnd = std::min(width, width - offset);
+				float k = kernel[dx + 2] * kernel[dy + 2];
+				size_t q = (size_t)yq * width + offset;
+				const float* qR = in[0].data() + q;
+				const float* qG = in[1].data() + q;
+				const float* qB = in[2].data() + q;
+				const float* qN0 = features.normal[0].data() + q;
+				const float* qN1 = features.normal[1].data() + q;
+				const float* qN2 = features.normal[2].data() + q;
+				const float* qA0 = features.albedo[0].data() + q;
+				const float* qA1 = features.albedo[1].data() + q;
+				const float* qA2 = features.albedo[2].data() + q;
+				const float* qZ = features.depth.data() + q;
+				const float* qS = features.specular.data() + q;
+				for (int x = xBegin; x < xEnd; ++x) {
+					float dr = qR[x] - pR[x];
+					float dg = qG[x] - pG[x];
+					float db = qB[x] - pB[x];
+					float dColor = dr * dr + dg * dg + db * db;
+					float dNormal = std::max(1.0f - (pN0[x] * qN0[x] + 
+						pN1[x] * qN1[x] + pN2[x] * qN2[x]), .0f);
+					float da0 = qA0[x] - pA0[x];
+					float da1 = qA1[x] - pA1[x];
+					float da2 = qA2[x] - pA2[x];
+					float dAlbedo = da0 * da0 + da1 * da1 + da2 * da2;
+					// relative, so near & far surfaces are treated alike
+					float dDepth = std::abs(qZ[x] - pZ[x]) / 
+						(std::max(qZ[x], pZ[x]) + 1e-4f);
+					// a specular pixel on either end rules the tap out
+					weight[x] = k * expNeg(dColor * invColor + 
+						dNormal * invNormal + dDepth * invDepth + 
+						dAlbedo * invAlbedo + (pS[x] + qS[x]) * 64.0f);
+				}
+				for (int x = xBegin; x < xEnd; ++x) {
+					sumR[x] += qR[x] * weight[x];
+					sumG[x] += qG[x] * weight[x];
+					sumB[x] += qB[x] * weight[x];
+					sumW[x] += weight[x];
+				}
+			}
+		}
+		float* oR = out[0].data() + p;
+		float* oG = out[1].data() + p;
+		float* oB = out[2].data() + p;
+		for (int x = 0; x < width; ++x) {
+			float inv = 1.0f / sumW[x];
+			oR[x] = sumR[x] * inv;
+			oG[x] = sumG[x] * inv;
+			oB[x] = sumB[x] * inv;
+		}
+	}
+}
+
+void Denoiser::apply(Color* colorBuffer, 
+	const AOVBuffers& features) const {
+
+	if (!features.has(AOV_DENOISE)) return;
+	TraceScope denoiseScope("denoise", "render");
+	int width = features.width;
+	int height = features.height;
+	size_t pixels = (size_t)width * height;
+	std::vector<float> planes[2][3];
+	for (int c = 0; c < 3; ++c) {
+		planes[0][c].resize(pixels);
+		planes[1][c].resize(pixels);
+	}
+	for (size_t i = 0; i < pixels; ++i) {
+		planes[0][0][i] = colorBuffer[i].getColorR();
+		planes[0][1][i] = colorBuffer[i].getColorG();
+		planes[0][2][i] = colorBuffer[i].getColorB();
+	}
+
+	int current = 0;
+	for (int pass = 0; pass < iterations; ++pass) {
+		// the color sigma halves every pass as the noise left drops
+		float sigma = colorSigma / (float)(1 << pass);
+		float invColor = 1.0f / std::max(sigma * sigma, 1e-8f);
+		const std::vector<float>* in = planes[current];
+		std::vector<float>* out = planes[1 - current];
+		// threads take bands of rows off this counter
+		const int band = 16;
+		std::atomic<int> nextBand(0);
+		auto filterBands = [&]() {
+			for (int y0 = band * nextBand++; y0 < height; 
+				y0 = band * nextBand++) {
+				filterRows(in, out, features, 1 << pass, invColor, 
+					y0, std::min(y0 + band, height));
+			}
+		};
+		std::vector<std::thread> workers;
+		for (int i = 1; i < numThreads; ++i) {
+			workers.push_back(std::thread(filterBands));
+		}
+		filterBands();
+		for (int i = 0; i < workers.size(); ++i) {
+			workers[i].join();
+		}
+		current = 1 - current;
+	}
+
+	for (size_t i = 0; i < pixels; ++i) {
+		// kept exactly, not through floats
+		if (features.specular[i] > .0f) continue;
+		colorBuffer[i].setColorR(planes[current][0][i]);
+		colorBuffer[i].setColorG(planes[current][1][i]);
+		colorBuffer[i].setColorB(planes[current][2][i]);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,48 @@
+#ifndef _DENOISER_H_
+#define _DENOISER_H_
+
+#include <vector>
+#include "../Options.h"
+#include "../Lights_Color/Color.h"
+#include "AOV.h"
+
+// how quickly the filter stops mixing pixels whose first hits differ, 
+// in 1 - cos(angle) between normals, relative depth and albedo 
+// distance. Smaller keeps edges sharper
+#define DENOISE_NORMAL_SIGMA .05f
+#define DENOISE_DEPTH_SIGMA .02f
+#define DENOISE_ALBEDO_SIGMA .05f
+// passes options.denoiseIterations gets clamped to, the last one's 
+// taps are already 128 pixels apart
+#define DENOISE_MAX_ITERATIONS 8
+
+// Edge avoiding a-trous wavelet filter (Dammertz et al. 2010): 
+// options.denoiseIterations (1 to DENOISE_MAX_ITERATIONS) passes of 
+// a 5x5 B3 spline kernel whose taps are 2^i pixels apart on pass i, 
+// each tap weighted down by how much its color (with a sigma halving 
+// every pass) and its first hit features differ from the center 
+// pixel's. Noise from soft shadow & anti-aliasing samples is averaged 
+// away within surfaces while geometry, texture and shadow edges stay. 
+// Pixels seeing a mirror or glass are left as they are. The passes 
+// are split across options.numThreads threads by rows.
+class Denoiser {
+private:
+	int iterations;
+	float colorSigma;
+	int numThreads;
+
+	// one pass with taps step pixels apart, rows [y0, y1) of out
+	void filterRows(const std::vector<float>* in, std::vector<float>* out,
+		const AOVBuffers& features, int step, float invColor, 
+		int y0, int y1) const;
+
+public:
+	Denoiser(const Options& options);
+
+	// filters the width * height pixels of colorBuffer in place, 
+	// features has to be of the same frame with the AOV_DENOISE 
+	// buffers filled
+	void apply(Color* colorBuffer, const AOVBuffers& features) const;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,73 @@
+#include "Footprint.h"
+
+TileFootprint::TileFootprint() : tilesX(0), tilesY(0), words(0) {
+}
+
+void TileFootprint::reset(const std::vector<Object*>& sceneObjects, 
+	int x, int y) {
+	objects = sceneObjects;
+	index.clear();
+	for (int i = 0; i < objects.size(); ++i) {
+		index[objects[i]] = i;
+	}
+	tilesX = x;
+	tilesY = y;
+	words = ((int)objects.size() + 63) / 64;
+	bits.assign((size_t)tilesX * tilesY * words, 0);
+	recorded.assign((size_t)tilesX * tilesY, 0);
+}
+
+bool TileFootprint::matches(const std::vector<Object*>& sceneObjects, 
+	int x, int y) const {
+	return tilesX == x && tilesY == y && objects == sceneObjects;
+}
+
+uint64_t* TileFootprint::beginTile(int tile) {
+	recorded[tile] = 0;
+	uint64_t* tileBits = bits.data() + (size_t)tile * words;
+	for (int w = 0; w < words; ++w) {
+		tileBits[w] = 0;
+	}
+	return tileBits;
+}
+
+void TileFootprint::endTile(int tile) {
+	recorded[tile] = 1;
+}
+
+bool TileFootprint::touched(int tile, const Object* object) const {
+	std::unordered_map<const Object*, int>::const_iterator it = 
+		index.find(object);
+	if (!recorded[tile] || it == index.end()) return false;
+	return (bits[(size_t)tile * words + (it->second >> 6)] >> 
+		(it->second & 63)) & 1;
+}
+
+std::vector<bool> TileFootprint::dirtyTiles(
+	const std::vector<Object*>& edited) const {
+
+	int numTiles = tilesX * tilesY;
+	std::vector<bool> dirty(numTiles, false);
+	// the edited objects' bits, to test a tile a word at a time
+	std::vector<uint64_t> mask(words, 0);
+	for (int i = 0; i < edited.size(); ++i) {
+		std::unordered_map<const Object*, int>::const_iterator it = 
+			index.find(edited[i]);
+		if (it == index.end()) {
+			// not something the rays could have been checked against
+			return std::vector<bool>(numTiles, true);
+		}
+		mask[it->second >> 6] |= (uint64_t)1 << (it->second & 63);
+	}
+	for (int tile = 0; tile < numTiles; ++tile) {
+		if (!recorded[tile]) {
+			dirty[tile] = true;
+			continue;
+		}
+		const uint64_t* tileBits = bits.data() + (size_t)tile * words;
+		for (int w = 0; w < words && !dirty[tile]; ++w) {
+			dirty[tile] = (tileBits[w] & mask[w]) != 0;
+		}
+	}
+	return dirty;
+}
\ No newline at end of file
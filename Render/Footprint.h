@@ -0,0 +1,64 @@
+#ifndef _FOOTPRINT_H_
+#define _FOOTPRINT_H_
+
+#include <stdint.h>
+#include <vector>
+#include <unordered_map>
+#include "../Shapes_and_globals/Object.h"
+
+// Which scene objects each RENDER_TILE_SIZE tile's rays hit in the 
+// frame Render::renderImage() recorded (options.recordFootprint): 
+// one bit per object per tile, set for everything a camera, 
+// reflection or refraction ray hit and every shadow casting occluder. 
+// Changing an object's color or material only changes the tiles 
+// whose bit for it is set, everywhere else every ray still takes 
+// the same path, so Render::renderEdited() redoes just those. 
+// Moving objects or editing lights isn't covered.
+class TileFootprint {
+private:
+	// the scene's object list, bit i is objects[i]
+	std::vector<Object*> objects;
+	std::unordered_map<const Object*, int> index;
+	int tilesX, tilesY;
+	int words;
+	// words per tile, tile after tile
+	std::vector<uint64_t> bits;
+	// tiles whose bits are complete, the rest always count as dirty
+	std::vector<char> recorded;
+
+public:
+	TileFootprint();
+
+	// starts over for a tilesX * tilesY frame of sceneObjects, every 
+	// tile unrecorded
+	void reset(const std::vector<Object*>& sceneObjects, 
+		int tilesX, int tilesY);
+	// true if it was reset() for this frame size & object list
+	bool matches(const std::vector<Object*>& sceneObjects, 
+		int tilesX, int tilesY) const;
+
+	// clears the tile's bits and returns them for mark(), each tile 
+	// is recorded by one thread
+	uint64_t* beginTile(int tile);
+	// the tile's bits are complete
+	void endTile(int tile);
+	// sets object's bit in a tile's bits (objects that aren't in the 
+	// list, like an instance's prototype objects, are ignored)
+	void mark(uint64_t* tileBits, const Object* object) const {
+		std::unordered_map<const Object*, int>::const_iterator it = 
+			index.find(object);
+		if (it != index.end()) {
+			tileBits[it->second >> 6] |= (uint64_t)1 << (it->second & 63);
+		}
+	}
+
+	// true if the tile was recorded and its rays hit object
+	bool touched(int tile, const Object* object) const;
+
+	// per tile: does it have to be rendered again after edited's 
+	// colors or materials changed. Unrecorded tiles and objects 
+	// that aren't in the list make it true
+	std::vector<bool> dirtyTiles(const std::vector<Object*>& edited) const;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,89 @@
+#include "Heatmap.h"
+#include <stdio.h>
+#include <math.h>
+#include <algorithm>
+
+Heatmap::Heatmap() : width(0), height(0), cellSize(1), 
+	cellsX(0), cellsY(0) {
+}
+
+void Heatmap::reset(int width, int height, int cellSize) {
+	this->width = width;
+	this->height = height;
+	this->cellSize = cellSize;
+	cellsX = (width + cellSize - 1) / cellSize;
+	cellsY = (height + cellSize - 1) / cellSize;
+	nanoseconds.assign(cellsX * cellsY, 0);
+	rays.assign(cellsX * cellsY, 0);
+}
+
+bool Heatmap::empty() const {
+	return nanoseconds.empty();
+}
+
+void Heatmap::record(int cellX, int cellY, long long ns, 
+	long long rayCount) {
+	nanoseconds[cellY * cellsX + cellX] = ns;
+	rays[cellY * cellsX + cellX] = rayCount;
+}
+
+// blue -> cyan -> green -> yellow -> red over t in [0, 1]
+static Color falseColor(float t) {
+	static const float ramp[5][3] = {
+		{ .0f, .0f, 1.0f }, { .0f, 1.0f, 1.0f }, { .0f, 1.0f, .0f },
+		{ 1.0f, 1.0f, .0f }, { 1.0f, .0f, .0f }
+	};
+	t = std::min(std::max(t, .0f), 1.0f) * 4.0f;
+	int i = std::min((int)t, 3);
+	float f = t - i;
+	return Color(
+		ramp[i][0] + (ramp[i + 1][0] - ramp[i][0]) * f,
+		ramp[i][1] + (ramp[i + 1][1] - ramp[i][1]) * f,
+		ramp[i][2] + (ramp[i + 1][2] - ramp[i][2]) * f, .0f);
+}
+
+void Heatmap::toImage(Color* buffer) const {
+	if (empty()) return;
+	// log scale, one glass tile can easily cost 100x a sky tile
+	long long lo = *std::min_element(nanoseconds.begin(), nanoseconds.end());
+	long long hi = *std::max_element(nanoseconds.begin(), nanoseconds.end());
+	float logLo = logf((float)std::max(lo, 1LL));
+	float logHi = logf((float)std::max(hi, 1LL));
+	float range = logHi > logLo ? logHi - logLo : 1.0f;
+
+	for (int y = 0; y < height; ++y) {
+		for (int x = 0; x < width; ++x) {
+			long long ns = nanoseconds[(y / cellSize) * cellsX + x / cellSize];
+			buffer[x + y * width] = 
+				falseColor((logf((float)std::max(ns, 1LL)) - logLo) / range);
+		}
+	}
+}
+
+bool Heatmap::writeCSV(const std::string& fileName) const {
+	FILE* file = fopen(fileName.c_str(), "w");
+	if (file == nullptr) return false;
+
+	fprintf(file, "cellX,cellY,x,y,width,height,nanoseconds,rays,nsPerRay\n");
+	for (int cy = 0; cy < cellsY; ++cy) {
+		for (int cx = 0; cx < cellsX; ++cx) {
+			int idx = cy * cellsX + cx;
+			int x = cx * cellSize, y = cy * cellSize;
+			fprintf(file, "%d,%d,%d,%d,%d,%d,%lld,%lld,%.1f\n", 
+				cx, cy, x, y, 
+				std::min(cellSize, width - x), std::min(cellSize, height - y),
+				nanoseconds[idx], rays[idx], 
+				rays[idx] > 0 ? (double)nanoseconds[idx] / rays[idx] : .0);
+		}
+	}
+	fclose(file);
+	return true;
+}
+
+int Heatmap::getWidth() const {
+	return width;
+}
+
+int Heatmap::getHeight() const {
+	return height;
+}
\ No newline at end of file
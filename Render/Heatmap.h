@@ -0,0 +1,50 @@
+#ifndef _HEATMAP_H_
+#define _HEATMAP_H_
+
+#include <string>
+#include <vector>
+#include "../Lights_Color/Color.h"
+
+// What renderImage() times for the heatmap: nothing, each 
+// RENDER_TILE_SIZE tile, or every single pixel (a clock read per 
+// pixel, so a bit slower)
+enum heatmapMode {
+	HEATMAP_OFF,
+	HEATMAP_TILES,
+	HEATMAP_PIXELS
+};
+
+// Time & rays spent on each cell (tile or pixel) of the last frame. 
+// Cells are only ever written by the thread rendering them, so the 
+// render threads record into it without locking.
+class Heatmap {
+private:
+	// image size & cell size in pixels (RENDER_TILE_SIZE or 1)
+	int width, height, cellSize;
+	int cellsX, cellsY;
+	std::vector<long long> nanoseconds;
+	// taken from the thread's RenderStats, zero if RENDER_STATS is 0
+	std::vector<long long> rays;
+
+public:
+	Heatmap();
+
+	// clears it for a width x height frame split into cellSize cells
+	void reset(int width, int height, int cellSize);
+	bool empty() const;
+
+	// cell (x, y) counted in cells, not pixels
+	void record(int cellX, int cellY, long long ns, long long rayCount);
+
+	// fills a width x height buffer with the cells' time in false 
+	// color (blue cheap -> red expensive, log scale) for writeImage()
+	void toImage(Color* buffer) const;
+
+	// one row per cell: position, size, ns, rays & ns per ray
+	bool writeCSV(const std::string& fileName) const;
+
+	int getWidth() const;
+	int getHeight() const;
+};
+
+#endif
\ No newline at end of file
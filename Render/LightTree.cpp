@@ -0,0 +1,161 @@
+#include "LightTree.h"
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+
+LightTree::LightTree() : samples(0) {
+}
+
+void LightTree::build(const std::vector<LightSources*>& sceneLights, 
+	int lightSamples) {
+	nodes.clear();
+	lights = sceneLights;
+	samples = lightSamples;
+	if (lightSamples <= 0 || (int)lights.size() <= lightSamples) {
+		return;
+	}
+
+	std::vector<glm::vec3> lower(lights.size()), upper(lights.size());
+	std::vector<float> power(lights.size());
+	std::vector<int> order(lights.size());
+	for (int i = 0; i < lights.size(); ++i) {
+		glm::vec3 pos = lights[i]->getLightPos();
+		lower[i] = upper[i] = pos;
+		if (lights[i]->getLightType() == AREA_LIGHT) {
+			glm::vec3 a = lights[i]->getEdgeA();
+			glm::vec3 b = lights[i]->getEdgeB();
+			glm::vec3 corners[3] = { pos + a, pos + b, pos + a + b };
+			for (int c = 0; c < 3; ++c) {
+				lower[i] = glm::min(lower[i], corners[c]);
+				upper[i] = glm::max(upper[i], corners[c]);
+			}
+		}
+		Color color = lights[i]->getLightColor();
+		power[i] = (float)(.2126 * color.getColorR() + 
+			.7152 * color.getColorG() + .0722 * color.getColorB());
+		order[i] = i;
+	}
+	nodes.reserve(2 * lights.size() - 1);
+	buildNode(order, 0, (int)order.size(), lower, upper, power);
+}
+
+int LightTree::buildNode(std::vector<int>& order, int first, int last,
+	const std::vector<glm::vec3>& lower,
+	const std::vector<glm::vec3>& upper,
+	const std::vector<float>& power) {
+
+	int index = (int)nodes.size();
+	nodes.push_back(Node());
+	Node node;
+	node.lower = lower[order[first]];
+	node.upper = upper[order[first]];
+	node.power = .0f;
+	node.right = -1;
+	node.light = -1;
+	glm::vec3 centerLower = (node.lower + node.upper) * .5f;
+	glm::vec3 centerUpper = centerLower;
+	for (int i = first; i < last; ++i) {
+		int l = order[i];
+		node.lower = glm::min(node.lower, lower[l]);
+		node.upper = glm::max(node.upper, upper[l]);
+		node.power += power[l];
+		glm::vec3 center = (lower[l] + upper[l]) * .5f;
+		centerLower = glm::min(centerLower, center);
+		centerUpper = glm::max(centerUpper, center);
+	}
+
+	if (last - first == 1) {
+		node.light = order[first];
+		nodes[index] = node;
+		return index;
+	}
+	// median split along the widest spread of light centers, so 
+	// lights that are close together share a subtree
+	glm::vec3 extent = centerUpper - centerLower;
+	int axis = 0;
+	if (extent[1] > extent[axis]) axis = 1;
+	if (extent[2] > extent[axis]) axis = 2;
+	int mid = (first + last) / 2;
+	std::nth_element(order.begin() + first, order.begin() + mid, 
+		order.begin() + last, [&](int a, int b) {
+			return lower[a][axis] + upper[a][axis] < 
+				lower[b][axis] + upper[b][axis];
+		});
+	buildNode(order, first, mid, lower, upper, power);
+	node.right = buildNode(order, mid, last, lower, upper, power);
+	nodes[index] = node;
+	return index;
+}
+
+bool LightTree::empty() const {
+	return nodes.empty();
+}
+
+int LightTree::sampleCount() const {
+	return samples;
+}
+
+float LightTree::importance(const Node& node, glm::vec3 P, 
+	glm::vec3 N) const {
+	// every direction from P into the box is within theta of the one 
+	// to its center, so the cosine with N is at most cos(alpha - theta)
+	glm::vec3 center = (node.lower + node.upper) * .5f;
+	float radius = length(node.upper - node.lower) * .5f;
+	glm::vec3 toCenter = center - P;
+	float distance = length(toCenter);
+	if (distance <= radius) {
+		return node.power;
+	}
+	float cosAlpha = dot(N, toCenter) / distance;
+	float sinTheta = radius / distance;
+	float cosTheta = sqrt(std::max(.0f, 1.0f - sinTheta * sinTheta));
+	if (cosAlpha >= cosTheta) {
+		return node.power;
+	}
+	float sinAlpha = sqrt(std::max(.0f, 1.0f - cosAlpha * cosAlpha));
+	float cosBound = cosAlpha * cosTheta + sinAlpha * sinTheta;
+	return node.power * std::max(LIGHT_TREE_MIN_COS, cosBound);
+}
+
+LightSources* LightTree::sample(glm::vec3 P, glm::vec3 N, float u, 
+	float& pmf) const {
+	pmf = 1.0f;
+	int n = 0;
+	while (nodes[n].light < 0) {
+		float left = importance(nodes[n + 1], P, N);
+		float right = importance(nodes[nodes[n].right], P, N);
+		if (left + right <= .0f) {
+			return nullptr;
+		}
+		// u is stretched back to [0, 1) for the next pick
+		float pLeft = left / (left + right);
+		if (u < pLeft) {
+			u = u / pLeft;
+			pmf *= pLeft;
+			n = n + 1;
+		}
+		else {
+			u = (u - pLeft) / (1.0f - pLeft);
+			pmf *= 1.0f - pLeft;
+			n = nodes[n].right;
+		}
+		u = std::min(u, 0.99999994f);
+	}
+	return lights[nodes[n].light];
+}
+
+uint64_t LightTree::seedFor(glm::vec3 P, glm::vec2 jitter) {
+	float values[5] = { P.x, P.y, P.z, jitter.x, jitter.y };
+	uint64_t h = 0x9e3779b97f4a7c15ULL;
+	for (int i = 0; i < 5; ++i) {
+		uint32_t bits;
+		memcpy(&bits, &values[i], sizeof(bits));
+		// splitmix64 finalizer
+		h ^= bits;
+		h *= 0xbf58476d1ce4e5b9ULL;
+		h ^= h >> 31;
+		h *= 0x94d049bb133111ebULL;
+		h ^= h >> 29;
+	}
+	return h;
+}
\ No newline at end of file
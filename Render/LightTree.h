@@ -0,0 +1,80 @@
+#ifndef _LIGHT_TREE_H_
+#define _LIGHT_TREE_H_
+
+#include <stdint.h>
+#include <vector>
+#include <glm/glm.hpp>
+#include "../Lights_Color/LightSources.h"
+
+// smallest cosine a node's importance is scaled by, so lights behind 
+// the surface still get picked now and then: phong's specular term 
+// can light a point from behind, and a light that's never picked 
+// would bias the estimate against shading every light
+#define LIGHT_TREE_MIN_COS .05f
+
+// Binary tree over the scene's lights for many light scenes: every 
+// node keeps the box around its lights and their summed power, which 
+// bounds how much of it can reach a shading point (phong shading has 
+// no distance falloff, so that's the power times the largest cosine 
+// between the surface normal and a direction into the box, floored 
+// at LIGHT_TREE_MIN_COS). 
+// sample() walks down from the root picking a child in proportion to 
+// that bound, so a light is picked roughly as often as it matters at 
+// the point, and returns its probability to weight the light with. 
+// Render::phongShading() traces options.lightSamples shadow rays per 
+// hit this way instead of one per light. 
+// The lights emit the same in every direction (area lights light 
+// both sides), so unlike a tree of emissive triangles the nodes 
+// don't need an orientation cone of their own.
+class LightTree {
+private:
+	// Flattened depth first like the BVH: an interior node's first 
+	// child is the next node, its second one sits at "right". Leaves 
+	// hold one light
+	struct Node {
+		glm::vec3 lower;
+		glm::vec3 upper;
+		float power;
+		int32_t right;
+		int32_t light; // -1 for interior nodes
+	};
+
+	std::vector<Node> nodes;
+	std::vector<LightSources*> lights;
+	int samples;
+
+	// builds the subtree over lights [first, last) of order, returns 
+	// its node
+	int buildNode(std::vector<int>& order, int first, int last,
+		const std::vector<glm::vec3>& lower,
+		const std::vector<glm::vec3>& upper,
+		const std::vector<float>& power);
+
+	// upper bound on what node's lights add to a point at P facing N
+	float importance(const Node& node, glm::vec3 P, glm::vec3 N) const;
+
+public:
+	LightTree();
+
+	// (Re)builds the tree over sceneLights, which can have moved since 
+	// the last call. Stays empty when lightSamples <= 0 or there are 
+	// no more lights than that, every light is shaded then
+	void build(const std::vector<LightSources*>& sceneLights, 
+		int lightSamples);
+	bool empty() const;
+	// the lights to shade per hit when not empty()
+	int sampleCount() const;
+
+	// a light for point P facing N picked with u in [0, 1), pmf gets 
+	// the probability it was picked with. Every light with some power 
+	// can be picked, nullptr if none has any
+	LightSources* sample(glm::vec3 P, glm::vec3 N, float u, 
+		float& pmf) const;
+
+	// seed for the light picks at a shading point, hashed from the 
+	// point and the sample's jitter so the same ray always picks the 
+	// same lights whichever thread traces it
+	static uint64_t seedFor(glm::vec3 P, glm::vec2 jitter);
+};
+
+#endif
\ No newline at end of file
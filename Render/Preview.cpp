@@ -0,0 +1,118 @@
+#include "Preview.h"
+#include "Render.h"
+
+PreviewWriter::PreviewWriter(Render& renderer, const std::string& fileName,
+	int width, int height) : renderer(renderer), fileName(fileName), 
+	width(width), height(height), finished(false), pendingSamples(0), 
+	written(0) {
+
+	writer = std::thread(&PreviewWriter::run, this);
+}
+
+PreviewWriter::~PreviewWriter() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		finished = true;
+	}
+	wake.notify_one();
+	writer.join();
+}
+
+void PreviewWriter::submit(const std::vector<double>& sums, int samples) {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		pending = sums;
+		pendingSamples = samples;
+	}
+	wake.notify_one();
+}
+
+int PreviewWriter::count() {
+	std::lock_guard<std::mutex> lock(mutex);
+	return written;
+}
+
+void PreviewWriter::run() {
+	Trace::setThreadName("preview writer");
+	std::vector<double> sums;
+	std::vector<Color> image(width * height);
+	std::unique_lock<std::mutex> lock(mutex);
+	for (;;) {
+		wake.wait(lock, [this] { return finished || pendingSamples > 0; });
+		if (pendingSamples == 0) break;
+		sums.swap(pending);
+		int samples = pendingSamples;
+		pendingSamples = 0;
+		lock.unlock();
+
+		TraceScope scope("preview", "io", samples);
+		double scale = 1.0 / samples;
+		for (int i = 0; i < width * height; ++i) {
+			image[i].setColorR(sums[3 * i + 0] * scale);
+			image[i].setColorG(sums[3 * i + 1] * scale);
+			image[i].setColorB(sums[3 * i + 2] * scale);
+		}
+		renderer.writeImage(fileName, 1.0f, 2.2f, image.data(), 
+			width, height);
+
+		lock.lock();
+		written++;
+	}
+}
+
+FrameWriter::FrameWriter(Render& renderer, int width, int height) : 
+	renderer(renderer), width(width), height(height), finished(false), 
+	hasPending(false), pending(width * height), written(0) {
+
+	writer = std::thread(&FrameWriter::run, this);
+}
+
+FrameWriter::~FrameWriter() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		finished = true;
+	}
+	wake.notify_one();
+	writer.join();
+}
+
+void FrameWriter::submit(std::vector<Color>& frame, 
+	const std::string& fileName) {
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		taken.wait(lock, [this] { return !hasPending; });
+		pending.swap(frame);
+		pendingName = fileName;
+		hasPending = true;
+	}
+	wake.notify_one();
+}
+
+int FrameWriter::count() {
+	std::lock_guard<std::mutex> lock(mutex);
+	return written;
+}
+
+void FrameWriter::run() {
+	Trace::setThreadName("frame writer");
+	std::vector<Color> image(width * height);
+	std::unique_lock<std::mutex> lock(mutex);
+	for (;;) {
+		wake.wait(lock, [this] { return finished || hasPending; });
+		if (!hasPending) break;
+		image.swap(pending);
+		std::string fileName = pendingName;
+		hasPending = false;
+		lock.unlock();
+		taken.notify_one();
+
+		{
+			TraceScope scope("frame", "io", written);
+			renderer.writeImage(fileName, 1.0f, 2.2f, image.data(), 
+				width, height);
+		}
+
+		lock.lock();
+		written++;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,84 @@
+#ifndef _PREVIEW_H_
+#define _PREVIEW_H_
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../Lights_Color/Color.h"
+
+class Render;
+
+// Writes the previews of a progressive render on a background 
+// thread, so a pass only pays for copying the accumulation buffer. 
+// Only the newest snapshot is kept: one submitted while the last is 
+// still being encoded replaces the one waiting.
+class PreviewWriter {
+private:
+	Render& renderer;
+	std::string fileName;
+	int width, height;
+
+	std::thread writer;
+	std::mutex mutex;
+	std::condition_variable wake;
+	bool finished;
+	// the snapshot waiting to be written, samples 0 if none
+	std::vector<double> pending;
+	int pendingSamples;
+	int written;
+
+	void run();
+
+public:
+	// writes through renderer.writeImage()
+	PreviewWriter(Render& renderer, const std::string& fileName, 
+		int width, int height);
+	// writes the snapshot still waiting, then stops
+	~PreviewWriter();
+
+	// sums -- per pixel RGB sums over samples passes
+	void submit(const std::vector<double>& sums, int samples);
+
+	// previews written so far
+	int count();
+};
+
+// Writes the frames of an animation on a background thread, so 
+// encoding one overlaps rendering the next. Unlike PreviewWriter 
+// nothing is dropped: while a frame is still waiting, submit() 
+// blocks until the writer has taken it.
+class FrameWriter {
+private:
+	Render& renderer;
+	int width, height;
+
+	std::thread writer;
+	std::mutex mutex;
+	// wakes the writer / a submit() waiting for the slot
+	std::condition_variable wake, taken;
+	bool finished;
+	bool hasPending;
+	std::vector<Color> pending;
+	std::string pendingName;
+	int written;
+
+	void run();
+
+public:
+	// writes through renderer.writeImage()
+	FrameWriter(Render& renderer, int width, int height);
+	// writes the frame still waiting, then stops
+	~FrameWriter();
+
+	// Queues frame (width * height pixels) to be written to fileName. 
+	// The pixels are swapped out, frame comes back holding an older 
+	// frame's buffer to render the next one into
+	void submit(std::vector<Color>& frame, const std::string& fileName);
+
+	// frames written so far
+	int count();
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,80 @@
+#include "Progress.h"
+#include <stdio.h>
+
+RenderProgress::RenderProgress(long long totalPixels, int totalTiles,
+	float interval, bool json) : totalPixels(totalPixels), 
+	totalTiles(totalTiles), interval(interval), json(json), 
+	pixelsDone(0), tilesDone(0), raysDone(0), finished(false) {
+
+	startTime = std::chrono::steady_clock::now();
+	if (interval > .0f) {
+		reporter = std::thread(&RenderProgress::run, this);
+	}
+}
+
+RenderProgress::~RenderProgress() {
+	stop();
+}
+
+void RenderProgress::run() {
+	std::chrono::duration<float> wait(interval);
+	std::unique_lock<std::mutex> lock(mutex);
+	while (!wake.wait_for(lock, wait, [this]() { return finished; })) {
+		report();
+	}
+}
+
+void RenderProgress::stop() {
+	if (!reporter.joinable()) return;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		finished = true;
+	}
+	wake.notify_one();
+	reporter.join();
+	report();
+}
+
+// "1h 02m 03s" / "2m 03s" / "3s"
+static std::string formatSeconds(double seconds) {
+	long long s = (long long)(seconds + 0.5);
+	char buffer[32];
+	if (s >= 3600) {
+		snprintf(buffer, sizeof(buffer), "%lldh %02lldm %02llds", 
+			s / 3600, s / 60 % 60, s % 60);
+	}
+	else if (s >= 60) {
+		snprintf(buffer, sizeof(buffer), "%lldm %02llds", s / 60, s % 60);
+	}
+	else {
+		snprintf(buffer, sizeof(buffer), "%llds", s);
+	}
+	return buffer;
+}
+
+void RenderProgress::report() {
+	long long pixels = pixelsDone.load(std::memory_order_relaxed);
+	long long rays = raysDone.load(std::memory_order_relaxed);
+	int tiles = tilesDone.load(std::memory_order_relaxed);
+	double elapsed = std::chrono::duration<double>(
+		std::chrono::steady_clock::now() - startTime).count();
+
+	double fraction = totalPixels > 0 ? (double)pixels / totalPixels : 1.0;
+	double raysPerSec = elapsed > .0 ? rays / elapsed : .0;
+	// assumes the rest of the frame costs what the done part did
+	double eta = pixels > 0 ? elapsed * (totalPixels - pixels) / pixels : -1.0;
+
+	printf("Rendering: %5.1f%% (%d/%d tiles), %.2fM rays/s, "
+		"elapsed %s, ETA %s\n", fraction * 100.0, tiles, totalTiles,
+		raysPerSec * 1e-6, formatSeconds(elapsed).c_str(), 
+		eta >= .0 ? formatSeconds(eta).c_str() : "?");
+	fflush(stdout);
+	if (json) {
+		fprintf(stderr, "{\"progress\":%.4f,\"tilesDone\":%d,"
+			"\"tilesTotal\":%d,\"pixelsDone\":%lld,\"pixelsTotal\":%lld,"
+			"\"rays\":%lld,\"raysPerSec\":%.0f,\"elapsedSec\":%.3f,"
+			"\"etaSec\":%.3f}\n", fraction, tiles, totalTiles, pixels, 
+			totalPixels, rays, raysPerSec, elapsed, eta);
+		fflush(stderr);
+	}
+}
\ No newline at end of file
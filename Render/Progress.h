@@ -0,0 +1,53 @@
+#ifndef _PROGRESS_H_
+#define _PROGRESS_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Percent done, rays/s & ETA of a running frame. The render threads 
+// bump two relaxed atomics per finished tile, a reporter thread 
+// wakes up every interval seconds to print them.
+class RenderProgress {
+private:
+	long long totalPixels;
+	int totalTiles;
+	float interval;
+	// also print a JSON line per report on stderr (for job schedulers)
+	bool json;
+
+	std::atomic<long long> pixelsDone;
+	std::atomic<int> tilesDone;
+	std::atomic<long long> raysDone;
+	std::chrono::steady_clock::time_point startTime;
+
+	std::thread reporter;
+	std::mutex mutex;
+	std::condition_variable wake;
+	bool finished;
+
+	void report();
+	void run();
+
+public:
+	// interval <= 0 counts but never prints
+	RenderProgress(long long totalPixels, int totalTiles, 
+		float interval, bool json);
+	// stop()s if that hasn't happened yet
+	~RenderProgress();
+
+	// called by the thread that finished the tile
+	void tileDone(int pixels, long long rays) {
+		pixelsDone.fetch_add(pixels, std::memory_order_relaxed);
+		raysDone.fetch_add(rays, std::memory_order_relaxed);
+		tilesDone.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	// stops the reporter after one last (100%) report
+	void stop();
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,68 @@
+#ifndef _RANDOM_H_
+#define _RANDOM_H_
+
+#include <stdint.h>
+
+// Small PCG32 generator (O'Neill, pcg-random.org) used for the 
+// jitter/shuffle values instead of rand(). rand() shares one hidden 
+// state between all threads, so every render thread would fight 
+// over it and the image would change with the thread count. Each 
+// pixel seeds its own generator from its index instead, so a frame 
+// comes out the same no matter how the tiles get scheduled.
+class PCG32 {
+private:
+	uint64_t state;
+	uint64_t inc;
+
+public:
+	// seed picks the start point, sequence picks one of 2^63 streams
+	PCG32(uint64_t seed, uint64_t sequence = 0) : state(0), 
+		inc((sequence << 1u) | 1u) {
+		nextUInt();
+		state += seed;
+		nextUInt();
+	}
+
+	uint32_t nextUInt() {
+		uint64_t oldState = state;
+		state = oldState * 6364136223846793005ULL + inc;
+		uint32_t xorShifted = (uint32_t)(((oldState >> 18u) ^ oldState) >> 27u);
+		uint32_t rot = (uint32_t)(oldState >> 59u);
+		return (xorShifted >> rot) | (xorShifted << ((-rot) & 31));
+	}
+
+	// skips delta numbers ahead in O(log delta) steps (Brown, 
+	// "Random number generation with arbitrary strides")
+	void advance(uint64_t delta) {
+		uint64_t curMult = 6364136223846793005ULL;
+		uint64_t curPlus = inc;
+		uint64_t accMult = 1u;
+		uint64_t accPlus = 0u;
+		while (delta > 0) {
+			if (delta & 1) {
+				accMult *= curMult;
+				accPlus = accPlus * curMult + curPlus;
+			}
+			curPlus = (curMult + 1) * curPlus;
+			curMult *= curMult;
+			delta /= 2;
+		}
+		state = accMult * state + accPlus;
+	}
+
+	// uniform in [0, bound), bound > 0 (rejects the biased low range)
+	uint32_t nextUInt(uint32_t bound) {
+		uint32_t threshold = (0u - bound) % bound;
+		for (;;) {
+			uint32_t r = nextUInt();
+			if (r >= threshold) return r % bound;
+		}
+	}
+
+	// uniform in [0, 1), top 24 bits so the result is exact in a float
+	float nextFloat() {
+		return (nextUInt() >> 8) * (1.0f / 16777216.0f);
+	}
+};
+
+#endif
\ No newline at end of file
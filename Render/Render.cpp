@@ -1,98 +1,819 @@
 #include "Render.h"
 
-Render::Render() 
+Render::Render() : ownsAccel(true), cancelled(false), sceneAccel(nullptr)
 {
 }
 
+Render::~Render()
+{
+	if (ownsAccel) delete sceneAccel;
+}
+
+void Render::shareAccelStructure(AccelerationStructure* accel) {
+	if (ownsAccel) delete sceneAccel;
+	sceneAccel = accel;
+	ownsAccel = false;
+}
+
+void Render::cancel() {
+	cancelled.store(true, std::memory_order_relaxed);
+}
+
+bool Render::isCancelled() const {
+	return cancelled.load(std::memory_order_relaxed);
+}
+
+void Render::buildAccelStructure(std::vector<Object*>& sceneObjects,
+	accelType type) {
+
+	static const char* traceNames[] = { "build none", "build BVH", 
+		"build kdtree", "build grid" };
+	TraceScope scope(traceNames[type], "accel");
+	if (ownsAccel) delete sceneAccel;
+	ownsAccel = true;
+	switch (type) {
+	case BVH_ACCEL: {
+		sceneAccel = new BVH(sceneObjects);
+		break;
+	}
+	case KDTREE_ACCEL: {
+		sceneAccel = new KdTree(sceneObjects);
+		break;
+	}
+	case GRID_ACCEL: {
+		sceneAccel = new Grid(sceneObjects);
+		break;
+	}
+	case NO_ACCEL:
+	default: {
+		// base class tests every object in turn
+		sceneAccel = new AccelerationStructure(sceneObjects);
+		break;
+	}
+	}
+}
+
+bool Render::updateAccelStructure(std::vector<Object*>& sceneObjects,
+	accelType type) {
+
+	if (ownsAccel && sceneAccel != nullptr) {
+		TraceScope scope("refit", "accel");
+		if (sceneAccel->refit()) return true;
+	}
+	buildAccelStructure(sceneObjects, type);
+	return false;
+}
+
+// the footprint bits of the tile this thread is rendering, nullptr 
+// when its renderImage() isn't recording one (see TileFootprint)
+static thread_local uint64_t* tileFootprint = nullptr;
+// sums up the first hits of the pixel this thread is rendering, 
+// nullptr when its renderImage() / renderProgressive() isn't 
+// recording AOVs
+static thread_local FirstHitSample* firstHit = nullptr;
+
+// the AOVs a render with these options records, the denoiser's 
+// features on top of the asked for ones
+static unsigned aovMaskFor(const Options& options) {
+	unsigned aovMask = options.aovs;
+	if (options.denoise) {
+		aovMask |= AOV_DENOISE;
+	}
+	return aovMask;
+}
+
+static long long elapsedNs(std::chrono::steady_clock::time_point start) {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now() - start).count();
+}
+
 void Render::startRender(std::vector<LightSources*>& lights,
 	std::vector<Object*>& sceneObjects, 
 	Color* colorBuffer, Camera cam,
-	Options options, glm::vec2* r, glm::vec2* s) {
+	Options options) {
 
-	// Construct the AccelStruct grid 
-	// (grid sizing/division/populate with objects etc.) 
+	// Construct the AccelStruct 
+	// (BVH build / grid sizing etc.) 
 	// then cast rays into scene
-	
-	// create the grid: 
-	//sceneGrid = new Grid(sceneObjects, lights);
-
-	// now grid is ready, we start casting
-	// rays into the scene and traversing the grid
-	for (int y = 0; y < options.height; y++) {
-		for (int x = 0; x < options.width; x++) {
-			Color pixelColor;
-			// Generate jittered components for camera and shadow rays
-			for (int idx = 0; 
-				idx < options.sampleNum * options.sampleNum; ++idx) {
-				// generates a value in range [0, 1)
-				s[idx].x = r[idx].x = ((float)rand()) / RAND_MAX;
-				s[idx].y = r[idx].y = ((float)rand()) / RAND_MAX;
+	buildAccelStructure(sceneObjects, options.accelStructure);
+
+	// now the structure is ready, we start casting
+	// rays into the scene and traversing it
+	if (options.progressive) {
+		renderProgressive(lights, sceneObjects, colorBuffer, cam, options);
+	}
+	else {
+		renderImage(lights, sceneObjects, colorBuffer, cam, options);
+	}
+	// smooths out what's left of the sampling noise
+	if (options.denoise && !isCancelled()) {
+		Denoiser(options).apply(colorBuffer, aovs);
+	}
+}
+
+void Render::renderImage(std::vector<LightSources*>& lights,
+	std::vector<Object*>& sceneObjects,
+	Color* colorBuffer, Camera& cam,
+	const Options& options) {
+
+	// the lights can have moved since the last frame
+	lightTree.build(lights, options.lightSamples);
+	int numThreads = options.numThreads;
+	if (numThreads <= 0) {
+		numThreads = max(1, (int)std::thread::hardware_concurrency());
+	}
+	int tilesX = (options.width + RENDER_TILE_SIZE - 1) / RENDER_TILE_SIZE;
+	int tilesY = (options.height + RENDER_TILE_SIZE - 1) / RENDER_TILE_SIZE;
+	int numTiles = tilesX * tilesY;
+	int firstTile = min(max(options.firstTile, 0), numTiles);
+	int endTile = numTiles;
+	if (options.tileCount >= 0) {
+		endTile = min(numTiles, firstTile + options.tileCount);
+	}
+	if (options.recordFootprint && 
+		!footprint.matches(sceneObjects, tilesX, tilesY)) {
+		footprint.reset(sceneObjects, tilesX, tilesY);
+	}
+	unsigned aovMask = aovMaskFor(options);
+	// renderEdited() keeps the rest of the frame's
+	if (tileMask.empty() || aovs.enabled != aovMask || 
+		aovs.width != options.width || aovs.height != options.height) {
+		aovs.reset(options.width, options.height, aovMask, sceneObjects);
+	}
+	// restores the finished tiles' AOVs along with their colors
+	Checkpoint checkpoint(options, sceneObjects.size(), lights.size(), 
+		aovs);
+	int restored = checkpoint.load(colorBuffer);
+	if (restored > 0) {
+		std::cout << "Resuming from " << options.checkpointFile << ", " << 
+			restored << " of " << numTiles << " tiles done" << std::endl;
+	}
+	// finished before, or not one renderEdited() wants
+	auto skipTile = [&](int tile) {
+		return checkpoint.isFinished(tile) || 
+			(!tileMask.empty() && !tileMask[tile]);
+	};
+	long long totalPixels = 0;
+	int tilesLeft = 0;
+	for (int tile = firstTile; tile < endTile; ++tile) {
+		if (skipTile(tile)) continue;
+		tilesLeft++;
+		int x0 = (tile % tilesX) * RENDER_TILE_SIZE;
+		int y0 = (tile / tilesX) * RENDER_TILE_SIZE;
+		int x1 = min(x0 + RENDER_TILE_SIZE, options.width);
+		int y1 = min(y0 + RENDER_TILE_SIZE, options.height);
+		totalPixels += (long long)(x1 - x0) * (y1 - y0);
+	}
+	int samples = (int)(options.sampleNum * options.sampleNum);
+
+	// threads grab the next tile off this counter until they run 
+	// out, so a slow tile (glass, mirrors) doesn't hold the others up
+	std::atomic<int> nextTile(firstTile);
+	std::mutex statsMutex;
+	stats = RenderStats();
+	if (options.heatmap == HEATMAP_PIXELS) {
+		heatmap.reset(options.width, options.height, 1);
+	}
+	else if (options.heatmap == HEATMAP_TILES) {
+		heatmap.reset(options.width, options.height, RENDER_TILE_SIZE);
+	}
+	else {
+		heatmap = Heatmap();
+	}
+	// rays/s stays at 0 when RENDER_STATS is compiled out
+	RenderProgress progress(totalPixels, 
+		tilesLeft, options.progressInterval, options.progressJSON);
+
+	auto renderTiles = [&](int worker) {
+		// per-thread jitter arrays
+		// r -- cam ray x-y jitter values
+		// s -- shadow ray x-y jitter values
+		std::vector<glm::vec2> r(max(samples, 1));
+		std::vector<glm::vec2> s(max(samples, 1));
+		RenderStats::local() = RenderStats();
+		if (worker > 0) {
+			Trace::setThreadName("render worker " + std::to_string(worker));
+		}
+		TraceScope workerScope("renderTiles", "render");
+
+		for (int tile = nextTile++; tile < endTile; tile = nextTile++) {
+			if (isCancelled()) break;
+			if (skipTile(tile)) continue;
+			TraceScope tileScope("tile", "render", tile);
+			int x0 = (tile % tilesX) * RENDER_TILE_SIZE;
+			int y0 = (tile / tilesX) * RENDER_TILE_SIZE;
+			int x1 = min(x0 + RENDER_TILE_SIZE, options.width);
+			int y1 = min(y0 + RENDER_TILE_SIZE, options.height);
+			std::chrono::steady_clock::time_point tileStart, pixelStart;
+			long long tileRays = RenderStats::local().totalRays();
+			if (options.heatmap == HEATMAP_TILES) {
+				tileStart = std::chrono::steady_clock::now();
+			}
+			if (options.recordFootprint) {
+				tileFootprint = footprint.beginTile(tile);
+			}
+			for (int y = y0; y < y1; y++) {
+				for (int x = x0; x < x1; x++) {
+					long long pixelRays = RenderStats::local().totalRays();
+					if (options.heatmap == HEATMAP_PIXELS) {
+						pixelStart = std::chrono::steady_clock::now();
+					}
+					FirstHitSample firstHitSample;
+					if (aovMask != AOV_NONE) {
+						firstHit = &firstHitSample;
+					}
+					Color pixelColor = renderPixel(x, y, lights, 
+						sceneObjects, cam, options, r.data(), s.data());
+					if (aovMask != AOV_NONE) {
+						aovs.store(x, y, firstHitSample);
+						firstHit = nullptr;
+					}
+					if (options.heatmap == HEATMAP_PIXELS) {
+						heatmap.record(x, y, elapsedNs(pixelStart),
+							RenderStats::local().totalRays() - pixelRays);
+					}
+					// write the color to the (i,j)-th pixel in the image buffer
+					setPixelColor(x, y, colorBuffer, options.width,
+						pixelColor.getColorR(),
+						pixelColor.getColorG(),
+						pixelColor.getColorB());
+				}
+			}
+			if (options.recordFootprint) {
+				footprint.endTile(tile);
+				tileFootprint = nullptr;
+			}
+			if (options.heatmap == HEATMAP_TILES) {
+				heatmap.record(tile % tilesX, tile / tilesX, 
+					elapsedNs(tileStart),
+					RenderStats::local().totalRays() - tileRays);
+			}
+			progress.tileDone((x1 - x0) * (y1 - y0), 
+				RenderStats::local().totalRays() - tileRays);
+			checkpoint.tileDone(tile, colorBuffer);
+			if (onTileDone) {
+				onTileDone(x0, y0, x1, y1);
+			}
+		}
+
+		std::lock_guard<std::mutex> lock(statsMutex);
+		stats += RenderStats::local();
+	};
+
+	// the calling thread renders too
+	std::vector<std::thread> workers;
+	for (int i = 1; i < numThreads; ++i) {
+		workers.push_back(std::thread(renderTiles, i));
+	}
+	renderTiles(0);
+	for (int i = 0; i < workers.size(); ++i) {
+		workers[i].join();
+	}
+	progress.stop();
+	// also keeps what a cancelled render got done
+	checkpoint.save(colorBuffer);
+}
+
+int Render::renderEdited(std::vector<LightSources*>& lights,
+	std::vector<Object*>& sceneObjects,
+	Color* colorBuffer, Camera& cam,
+	const Options& options, 
+	const std::vector<Object*>& edited) {
+
+	int tilesX = (options.width + RENDER_TILE_SIZE - 1) / RENDER_TILE_SIZE;
+	int tilesY = (options.height + RENDER_TILE_SIZE - 1) / RENDER_TILE_SIZE;
+	// the whole frame, recording where everything shows up
+	Options frameOptions = options;
+	frameOptions.recordFootprint = true;
+	frameOptions.firstTile = 0;
+	frameOptions.tileCount = -1;
+	frameOptions.checkpointFile = "";
+	if (footprint.matches(sceneObjects, tilesX, tilesY)) {
+		tileMask = footprint.dirtyTiles(edited);
+	}
+	else {
+		tileMask.assign(tilesX * tilesY, true);
+	}
+	int dirty = (int)std::count(tileMask.begin(), tileMask.end(), true);
+	if (dirty > 0) {
+		renderImage(lights, sceneObjects, colorBuffer, cam, frameOptions);
+	}
+	else {
+		stats = RenderStats();
+	}
+	tileMask.clear();
+	return dirty;
+}
+
+void Render::renderViews(std::vector<LightSources*>& lights,
+	std::vector<Object*>& sceneObjects,
+	std::vector<RenderView>& views,
+	const Options& options) {
+
+	// the lights can have moved since the last frame
+	lightTree.build(lights, options.lightSamples);
+	int numThreads = options.numThreads;
+	if (numThreads <= 0) {
+		numThreads = max(1, (int)std::thread::hardware_concurrency());
+	}
+	int tilesX = (options.width + RENDER_TILE_SIZE - 1) / RENDER_TILE_SIZE;
+	int tilesY = (options.height + RENDER_TILE_SIZE - 1) / RENDER_TILE_SIZE;
+	int viewTiles = tilesX * tilesY;
+	int numTiles = viewTiles * (int)views.size();
+	int samples = (int)(options.sampleNum * options.sampleNum);
+
+	// tile t is tile t % viewTiles of view t / viewTiles, so the 
+	// views start in order but their tails overlap
+	std::atomic<int> nextTile(0);
+	std::vector<std::atomic<int> > tilesLeft(views.size());
+	for (int v = 0; v < views.size(); ++v) {
+		tilesLeft[v] = viewTiles;
+	}
+	std::mutex statsMutex;
+	stats = RenderStats();
+	heatmap = Heatmap();
+	RenderProgress progress(
+		(long long)options.width * options.height * views.size(),
+		numTiles, options.progressInterval, options.progressJSON);
+
+	auto renderTiles = [&](int worker) {
+		std::vector<glm::vec2> r(max(samples, 1));
+		std::vector<glm::vec2> s(max(samples, 1));
+		RenderStats::local() = RenderStats();
+		if (worker > 0) {
+			Trace::setThreadName("render worker " + std::to_string(worker));
+		}
+		TraceScope workerScope("renderTiles", "render");
+
+		for (int tile = nextTile++; tile < numTiles; tile = nextTile++) {
+			if (isCancelled()) break;
+			int v = tile / viewTiles;
+			RenderView& view = views[v];
+			TraceScope tileScope("tile", "render", tile);
+			int x0 = (tile % viewTiles % tilesX) * RENDER_TILE_SIZE;
+			int y0 = (tile % viewTiles / tilesX) * RENDER_TILE_SIZE;
+			int x1 = min(x0 + RENDER_TILE_SIZE, options.width);
+			int y1 = min(y0 + RENDER_TILE_SIZE, options.height);
+			long long tileRays = RenderStats::local().totalRays();
+			for (int y = y0; y < y1; y++) {
+				for (int x = x0; x < x1; x++) {
+					Color pixelColor = renderPixel(x, y, lights, 
+						sceneObjects, view.cam, options, r.data(), s.data());
+					setPixelColor(x, y, view.colorBuffer, options.width,
+						pixelColor.getColorR(),
+						pixelColor.getColorG(),
+						pixelColor.getColorB());
+				}
+			}
+			progress.tileDone((x1 - x0) * (y1 - y0), 
+				RenderStats::local().totalRays() - tileRays);
+			// the view's pixels are all written once this hits 0
+			if (--tilesLeft[v] == 0 && !view.outFileName.empty()) {
+				writeImage(view.outFileName, 1.0f, 2.2f, view.colorBuffer,
+					options.width, options.height);
+			}
+		}
+
+		std::lock_guard<std::mutex> lock(statsMutex);
+		stats += RenderStats::local();
+	};
+
+	std::vector<std::thread> workers;
+	for (int i = 1; i < numThreads; ++i) {
+		workers.push_back(std::thread(renderTiles, i));
+	}
+	renderTiles(0);
+	for (int i = 0; i < workers.size(); ++i) {
+		workers[i].join();
+	}
+	progress.stop();
+}
+
+// mean relative standard error of the pixels' luminance after 
+// "samples" passes. Dark pixels count as at least 1% bright so 
+// their noise doesn't dominate
+static double estimateNoise(const std::vector<double>& sums, 
+	const std::vector<double>& lumaSquares, int samples) {
+
+	if (samples < 2) return -1.0;
+	double total = .0;
+	for (size_t i = 0; i < lumaSquares.size(); ++i) {
+		double luma = .2126 * sums[3 * i] + .7152 * sums[3 * i + 1] + 
+			.0722 * sums[3 * i + 2];
+		double mean = luma / samples;
+		double variance = (lumaSquares[i] - luma * mean) / (samples - 1);
+		double standardError = sqrt(max(variance, .0) / samples);
+		total += standardError / max(mean, .01);
+	}
+	return total / lumaSquares.size();
+}
+
+int Render::renderAnimation(std::vector<LightSources*>& lights,
+	std::vector<Object*>& sceneObjects,
+	Animation& animation, Camera cam,
+	const Options& options, const std::string& fileName) {
+
+	// every frame is a new image: nothing to resume or refine
+	Options frameOptions = options;
+	frameOptions.checkpointFile.clear();
+	frameOptions.progressive = false;
+
+	int refits = 0, rebuilds = 0;
+	int f = 0;
+	{
+		// waits for the last frame to be written when it goes
+		FrameWriter writer(*this, options.width, options.height);
+		std::vector<Color> frame(options.width * options.height);
+		for (; f < options.animationFrames && !isCancelled(); ++f) {
+			TraceScope scope("frame", "animation", f);
+			float time = f / options.animationFPS;
+			bool moved = animation.apply(time);
+			if (f == 0) {
+				buildAccelStructure(sceneObjects, options.accelStructure);
+			}
+			else if (moved) {
+				if (updateAccelStructure(sceneObjects, options.accelStructure)) {
+					refits++;
+				}
+				else rebuilds++;
 			}
-			// shuffle array s[] -- shirley shuffle method
-			// reduce/eliminates coherence between r[] and s[] float values
-			// for more randomized shadow noise
-			if (options.sampleNum > 1) { 
-				shuffleFloatArray(s, options.sampleNum);
+			if (animation.hasCamera()) {
+				glm::vec3 pos, target;
+				animation.cameraAt(time, pos, target);
+				cam = Camera(pos, target, options.cameraReferUp);
 			}
-			float alpha, beta;
-			glm::vec3 rayDir, rayOrigin;
-			// Render with anti-aliasing & soft shadows
-			if (options.softShadows) {
-				for (int l = 0; 
-					l < options.sampleNum * options.sampleNum; ++l) {
-					// Jitter the rays casted into each pixel
-					alpha = ((2 * (x + r[l].x) / (float)options.width) - 1.0f)
-						* options.aspectRatio * tan(options.fov / 2);
-					beta = (1 - (2 * (y + r[l].y) / (float)options.height))
-						* tan(options.fov / 2);
-					rayDir = normalize(glm::vec3(alpha, beta, .0f) +
-						cam.getCamLookAt());
-					rayOrigin = cam.getCamPos();
-					Ray camRay(rayOrigin, rayDir); // generate cam ray
-
-
-					Object* hitObj = nullptr;
-					float tNear = .0f;
-					int objIndex = .0f;
-					glm::vec2 uv(.0f);
-					// Cast ray into the scene
-					pixelColor = pixelColor + castRay(rayOrigin, rayDir,
-						lights, sceneObjects, options, STARTING_DEPTH, s[l]);
-					
-					/*pixelColor = sceneGrid->intersect(rayOrigin, rayDir,
-						sceneObjects, tNear, objIndex, uv, hitObj) ? Color(1.0f, 1.0f, 1.0f, .0f) : Color(.0f, .0f, .0f, .0f);*/
+	
+			std::fill(frame.begin(), frame.end(), options.backgroundColor);
+			renderImage(lights, sceneObjects, frame.data(), cam, frameOptions);
+			if (isCancelled()) break;
+			writer.submit(frame, Animation::frameFileName(fileName, f));
+		}
+	}
+	std::cout << "Animation: " << f << " frames, structure refitted " << 
+		refits << " times, rebuilt " << rebuilds << " times" << std::endl;
+	return f;
+}
+
+static bool sameColor(Color a, Color b) {
+	return a.getColorR() == b.getColorR() && 
+		a.getColorG() == b.getColorG() && 
+		a.getColorB() == b.getColorB();
+}
+
+int Render::renderReprojected(std::vector<LightSources*>& lights,
+	std::vector<Object*>& sceneObjects,
+	Color* colorBuffer, Camera& cam,
+	const Options& options, ReprojectionCache& cache) {
+
+	// the lights can have moved since the last frame
+	lightTree.build(lights, options.lightSamples);
+	int numThreads = options.numThreads;
+	if (numThreads <= 0) {
+		numThreads = max(1, (int)std::thread::hardware_concurrency());
+	}
+	int tilesX = (options.width + RENDER_TILE_SIZE - 1) / RENDER_TILE_SIZE;
+	int tilesY = (options.height + RENDER_TILE_SIZE - 1) / RENDER_TILE_SIZE;
+	int numTiles = tilesX * tilesY;
+	int samples = (int)(options.sampleNum * options.sampleNum);
+
+	bool reuse = cache.usableFor(options);
+	cache.begin(options);
+	glm::vec3 camPos = cam.getCamPos();
+	glm::vec3 lastCamPos = cache.getCamPos();
+	float cosMaxAngle = cos(options.reprojectionMaxAngle);
+	// how wide a pixel is a unit away from the camera
+	float pixelSize = 2 * tan(options.fov / 2) / options.height;
+
+	std::atomic<int> nextTile(0);
+	std::atomic<int> reused(0);
+	std::mutex statsMutex;
+	stats = RenderStats();
+	heatmap = Heatmap();
+	RenderProgress progress((long long)options.width * options.height,
+		numTiles, options.progressInterval, options.progressJSON);
+
+	auto renderTiles = [&](int worker) {
+		std::vector<glm::vec2> r(max(samples, 1));
+		std::vector<glm::vec2> s(max(samples, 1));
+		RenderStats::local() = RenderStats();
+		if (worker > 0) {
+			Trace::setThreadName("render worker " + std::to_string(worker));
+		}
+		TraceScope workerScope("renderTiles", "render");
+
+		int threadReused = 0;
+		for (int tile = nextTile++; tile < numTiles; tile = nextTile++) {
+			if (isCancelled()) break;
+			TraceScope tileScope("tile", "render", tile);
+			int x0 = (tile % tilesX) * RENDER_TILE_SIZE;
+			int y0 = (tile / tilesX) * RENDER_TILE_SIZE;
+			int x1 = min(x0 + RENDER_TILE_SIZE, options.width);
+			int y1 = min(y0 + RENDER_TILE_SIZE, options.height);
+			long long tileRays = RenderStats::local().totalRays();
+			for (int y = y0; y < y1; y++) {
+				for (int x = x0; x < x1; x++) {
+					// what the pixel's center sees now
+					glm::vec3 dir = cameraRayDir(x + .5f, y + .5f, cam, options);
+					RENDER_STATS_ADD(cameraRays, 1);
+					ReprojectionCache::Pixel pixel;
+					pixel.hit = camPos;
+					pixel.object = nullptr;
+					pixel.age = 0;
+					float tNear = FLT_MAX;
+					int index;
+					glm::vec2 uv;
+					if (trace(camPos, dir, sceneObjects, tNear, index, uv, 
+						&pixel.object)) {
+						pixel.hit = camPos + dir * tNear;
+						pixel.surface = getSurfaceColor(pixel.object, pixel.hit);
+					}
+
+					// the sky is cheap to render again, and what mirrors 
+					// & glass show moves much more than they do
+					const ReprojectionCache::Pixel* last = 
+						(reuse && ReprojectionCache::reusable(pixel.object)) ? 
+						cache.lookup(pixel.hit) : nullptr;
+					if (last != nullptr && last->object == pixel.object &&
+						sameColor(last->surface, pixel.surface) &&
+						last->age < options.reprojectionMaxAge &&
+						glm::length(last->hit - pixel.hit) <= 
+							options.reprojectionTolerance * pixelSize * tNear &&
+						dot(normalize(pixel.hit - lastCamPos), dir) >= cosMaxAngle) {
+						pixel.color = last->color;
+						pixel.age = last->age + 1;
+						threadReused++;
+						RENDER_STATS_ADD(reprojectedPixels, 1);
+					}
+					else {
+						pixel.color = renderPixel(x, y, lights, 
+							sceneObjects, cam, options, r.data(), s.data());
+					}
+					cache.store(x, y, pixel);
+					setPixelColor(x, y, colorBuffer, options.width,
+						pixel.color.getColorR(),
+						pixel.color.getColorG(),
+						pixel.color.getColorB());
 				}
-				// average out the color sampled from 
-				// n^2 rays cast each indiv. pixel
-				// by dividing pixelColor / n^2 
-				pixelColor = pixelColor *
-					(float)(1.0f / 
-						(float)(options.sampleNum * options.sampleNum));
 			}
-			// Render w/o anti-aliasing & soft shadows
-			else if (!options.softShadows) {
-				alpha = ((2 * (x + .5f) / (float)options.width) - 1.0f)
-					* options.aspectRatio * tan(options.fov / 2);
-				beta = (1 - (2 * (y + 0.5) / (float)options.height))
-					* tan(options.fov / 2);
-				rayDir = normalize(glm::vec3(alpha, beta, .0f) +
-					cam.getCamLookAt());
-				rayOrigin = cam.getCamPos();
-				Ray camRay(rayOrigin, rayDir); // generate cam ray
-
-				// castRay function (replaces the getColor() function)
-				// this replaces getColor function
-				pixelColor = castRay(rayOrigin, rayDir, lights,
-					sceneObjects, options, STARTING_DEPTH, glm::vec2(.0f));
+			progress.tileDone((x1 - x0) * (y1 - y0), 
+				RenderStats::local().totalRays() - tileRays);
+			if (onTileDone) {
+				onTileDone(x0, y0, x1, y1);
+			}
+		}
+		reused += threadReused;
+
+		std::lock_guard<std::mutex> lock(statsMutex);
+		stats += RenderStats::local();
+	};
+
+	std::vector<std::thread> workers;
+	for (int i = 1; i < numThreads; ++i) {
+		workers.push_back(std::thread(renderTiles, i));
+	}
+	renderTiles(0);
+	for (int i = 0; i < workers.size(); ++i) {
+		workers[i].join();
+	}
+	progress.stop();
+	// half a frame is no use to the next one, the last full one is
+	if (!isCancelled()) cache.commit(cam);
+	return reused;
+}
+
+int Render::renderProgressive(std::vector<LightSources*>& lights,
+	std::vector<Object*>& sceneObjects,
+	Color* colorBuffer, Camera& cam,
+	const Options& options) {
+
+	if (!options.softShadows) {
+		renderImage(lights, sceneObjects, colorBuffer, cam, options);
+		return 1;
+	}
+	// the lights can have moved since the last frame
+	lightTree.build(lights, options.lightSamples);
+	int numThreads = options.numThreads;
+	if (numThreads <= 0) {
+		numThreads = max(1, (int)std::thread::hardware_concurrency());
+	}
+	int width = options.width;
+	int height = options.height;
+	int tilesX = (width + RENDER_TILE_SIZE - 1) / RENDER_TILE_SIZE;
+	int tilesY = (height + RENDER_TILE_SIZE - 1) / RENDER_TILE_SIZE;
+	int numTiles = tilesX * tilesY;
+	int maxPasses = options.progressiveSamples;
+	if (maxPasses <= 0) {
+		maxPasses = (int)(options.sampleNum * options.sampleNum);
+	}
+
+	// per pixel RGB sums, and luminance squared for the noise estimate
+	std::vector<double> sums(width * height * 3, .0);
+	std::vector<double> lumaSquares(width * height, .0);
+	// per pixel first hits summed over the passes, stored into aovs 
+	// once the last pass is done
+	unsigned aovMask = aovMaskFor(options);
+	aovs.reset(width, height, aovMask, sceneObjects);
+	std::vector<FirstHitSample> firstHits;
+	if (aovMask != AOV_NONE) {
+		firstHits.resize(width * height);
+	}
+	std::mutex statsMutex;
+	stats = RenderStats();
+	heatmap = Heatmap();
+	std::unique_ptr<PreviewWriter> preview;
+	if (!options.previewFile.empty()) {
+		preview.reset(new PreviewWriter(*this, options.previewFile, 
+			width, height));
+	}
+
+	std::chrono::steady_clock::time_point start = 
+		std::chrono::steady_clock::now();
+	std::chrono::steady_clock::time_point lastPreview = start;
+	std::chrono::steady_clock::time_point lastReport = start;
+	int pass = 0;
+	while (pass < maxPasses && !isCancelled()) {
+		TraceScope passScope("pass", "render", pass);
+		std::atomic<int> nextTile(0);
+		auto renderPass = [&](int worker) {
+			RenderStats::local() = RenderStats();
+			if (worker > 0) {
+				Trace::setThreadName("render worker " + std::to_string(worker));
+			}
+			for (int tile = nextTile++; tile < numTiles; tile = nextTile++) {
+				int x0 = (tile % tilesX) * RENDER_TILE_SIZE;
+				int y0 = (tile / tilesX) * RENDER_TILE_SIZE;
+				int x1 = min(x0 + RENDER_TILE_SIZE, width);
+				int y1 = min(y0 + RENDER_TILE_SIZE, height);
+				for (int y = y0; y < y1; y++) {
+					for (int x = x0; x < x1; x++) {
+						// the pixel's own stream again, 4 numbers per pass
+						PCG32 rng((uint64_t)y * width + x, options.seed);
+						rng.advance(4 * (uint64_t)pass);
+						glm::vec2 jitter, shadowJitter;
+						jitter.x = rng.nextFloat();
+						jitter.y = rng.nextFloat();
+						shadowJitter.x = rng.nextFloat();
+						shadowJitter.y = rng.nextFloat();
+						int pixel = y * width + x;
+						if (aovMask != AOV_NONE) {
+							firstHit = &firstHits[pixel];
+						}
+						Color sample = castCameraRay(x, y, jitter, 
+							shadowJitter, lights, sceneObjects, cam, options);
+						firstHit = nullptr;
+
+						double r = sample.getColorR();
+						double g = sample.getColorG();
+						double b = sample.getColorB();
+						sums[3 * pixel + 0] += r;
+						sums[3 * pixel + 1] += g;
+						sums[3 * pixel + 2] += b;
+						double luma = .2126 * r + .7152 * g + .0722 * b;
+						lumaSquares[pixel] += luma * luma;
+					}
+				}
 			}
+			std::lock_guard<std::mutex> lock(statsMutex);
+			stats += RenderStats::local();
+		};
+
+		// a pass always finishes, so every pixel has the same count
+		std::vector<std::thread> workers;
+		for (int i = 1; i < numThreads; ++i) {
+			workers.push_back(std::thread(renderPass, i));
+		}
+		renderPass(0);
+		for (int i = 0; i < workers.size(); ++i) {
+			workers[i].join();
+		}
+		pass++;
+
+		std::chrono::steady_clock::time_point now = 
+			std::chrono::steady_clock::now();
+		float elapsed = std::chrono::duration<float>(now - start).count();
+		double noise = estimateNoise(sums, lumaSquares, pass);
+		bool done = pass >= maxPasses || 
+			(options.progressiveTimeBudget > .0f && 
+				elapsed >= options.progressiveTimeBudget) ||
+			(options.progressiveNoiseTarget > .0f && noise >= .0 &&
+				noise <= options.progressiveNoiseTarget);
+
+		if (preview && !done && ((options.previewPasses > 0 && 
+			pass % options.previewPasses == 0) ||
+			(options.previewInterval > .0f && std::chrono::duration<float>(
+				now - lastPreview).count() >= options.previewInterval))) {
+			preview->submit(sums, pass);
+			lastPreview = now;
+		}
+		if (options.progressInterval > .0f && (done || 
+			std::chrono::duration<float>(now - lastReport).count() >= 
+			options.progressInterval)) {
+			printf("Pass %d/%d: %.2fM rays/s, noise %.4f, elapsed %.1fs\n",
+				pass, maxPasses, stats.totalRays() * 1e-6 / elapsed, 
+				noise, elapsed);
+			fflush(stdout);
+			lastReport = now;
+		}
+		if (done) break;
+	}
+
+	double scale = pass > 0 ? 1.0 / pass : .0;
+	for (int pixel = 0; pixel < width * height; ++pixel) {
+		setPixelColor(pixel % width, pixel / width, colorBuffer, width,
+			sums[3 * pixel + 0] * scale, sums[3 * pixel + 1] * scale,
+			sums[3 * pixel + 2] * scale);
+	}
+	if (aovMask != AOV_NONE) {
+		for (int pixel = 0; pixel < width * height; ++pixel) {
+			aovs.store(pixel % width, pixel / width, firstHits[pixel]);
+		}
+	}
+	return pass;
+}
+
+glm::vec3 Render::cameraRayDir(float px, float py, Camera& cam, 
+	const Options& options) {
+
+	float alpha = ((2 * px / (float)options.width) - 1.0f)
+		* options.aspectRatio * tan(options.fov / 2);
+	float beta = (1 - (2 * py / (float)options.height))
+		* tan(options.fov / 2);
+	return normalize(alpha * cam.getScreenX() + 
+		beta * cam.getScreenY() + cam.getCamLookAt());
+}
+
+Color Render::castCameraRay(int x, int y, glm::vec2 jitter, 
+	glm::vec2 shadowJitter,
+	std::vector<LightSources*>& lights,
+	std::vector<Object*>& sceneObjects,
+	Camera& cam, const Options& options) {
+
+	glm::vec3 rayDir = cameraRayDir(x + jitter.x, y + jitter.y, 
+		cam, options);
+
+	// Cast ray into the scene
+	RENDER_STATS_ADD(cameraRays, 1);
+	return castRay(cam.getCamPos(), rayDir, lights, sceneObjects, 
+		options, STARTING_DEPTH, shadowJitter);
+}
 
-			// write the color to the (i,j)-th pixel in the image buffer
-			setPixelColor(x, y, colorBuffer, options.width,
-				pixelColor.getColorR(),
-				pixelColor.getColorG(),
-				pixelColor.getColorB());
+Color Render::renderPixel(int x, int y,
+	std::vector<LightSources*>& lights,
+	std::vector<Object*>& sceneObjects,
+	Camera& cam, const Options& options,
+	glm::vec2* r, glm::vec2* s) {
+
+	Color pixelColor;
+	// every pixel gets its own random stream so the image doesn't 
+	// depend on which thread renders it or in what order
+	PCG32 rng((uint64_t)y * options.width + x, options.seed);
+	// Generate jittered components for camera and shadow rays
+	for (int idx = 0; 
+		idx < options.sampleNum * options.sampleNum; ++idx) {
+		// generates a value in range [0, 1)
+		s[idx].x = r[idx].x = rng.nextFloat();
+		s[idx].y = r[idx].y = rng.nextFloat();
+	}
+	// shuffle array s[] -- shirley shuffle method
+	// reduce/eliminates coherence between r[] and s[] float values
+	// for more randomized shadow noise
+	if (options.sampleNum > 1) { 
+		shuffleFloatArray(s, options.sampleNum, rng);
+	}
+	float alpha, beta;
+	glm::vec3 rayDir, rayOrigin;
+	// Render with anti-aliasing & soft shadows
+	if (options.softShadows) {
+		for (int l = 0; 
+			l < options.sampleNum * options.sampleNum; ++l) {
+			// Jitter the rays casted into each pixel
+			pixelColor = pixelColor + castCameraRay(x, y, r[l], s[l],
+				lights, sceneObjects, cam, options);
 		}
+		// average out the color sampled from 
+		// n^2 rays cast each indiv. pixel
+		// by dividing pixelColor / n^2 
+		pixelColor = pixelColor *
+			(float)(1.0f / 
+				(float)(options.sampleNum * options.sampleNum));
 	}
+	// Render w/o anti-aliasing & soft shadows
+	else if (!options.softShadows) {
+		alpha = ((2 * (x + .5f) / (float)options.width) - 1.0f)
+			* options.aspectRatio * tan(options.fov / 2);
+		beta = (1 - (2 * (y + 0.5) / (float)options.height))
+			* tan(options.fov / 2);
+		rayDir = normalize(alpha * cam.getScreenX() + 
+			beta * cam.getScreenY() + cam.getCamLookAt());
+		rayOrigin = cam.getCamPos();
+
+		// castRay function (replaces the getColor() function)
+		// this replaces getColor function
+		RENDER_STATS_ADD(cameraRays, 1);
+		pixelColor = castRay(rayOrigin, rayDir, lights,
+			sceneObjects, options, STARTING_DEPTH, glm::vec2(.0f));
+	}
+	return pixelColor;
 }
 
 void Render::setPixelColor(int i, int j, Color* buffer, 
@@ -117,6 +838,9 @@ Color Render::castRay(const glm::vec3& orig, const glm::vec3& dir,
 		return hitColor = Color(.0f, .0f, .0f, .0f);
 	}
 
+	RENDER_STATS_ADD(depthHistogram[min(depth, 
+		(uint32_t)RENDER_STATS_DEPTHS - 1)], 1);
+
 	int objIndex; // stores idx of closest obj in scene list
 	glm::vec2 uv; 
 	Object* hitObj = nullptr;
@@ -139,6 +863,9 @@ Color Render::castRay(const glm::vec3& orig, const glm::vec3& dir,
 	//}
 	if (trace(orig, dir, objects, tNear, objIndex, uv, &hitObj)) {
 	//if (firstTime) {
+		if (tileFootprint != nullptr) {
+			footprint.mark(tileFootprint, hitObj);
+		}
 		// intersection pt & ptr to object has been found
 		glm::vec3 hitPoint = orig + dir * tNear;
 		glm::vec3 N; // normal
@@ -146,25 +873,31 @@ Color Render::castRay(const glm::vec3& orig, const glm::vec3& dir,
 		glm::vec3 reflection_dir;
 		glm::vec3 reflection_ray_origin;
 		
-		// set floor tiles to be checkered
-		if (hitObj->getColor().getColorSpecial() == 2.0f) {
-			int squareTile = floor(hitPoint.x) + floor(hitPoint.z);
-			if (squareTile % 2 == 0) {
-				//hitObj->setColor(229/255.0f, 48/255.0f, 36/255.0f);
-				hitObj->setColor(0.0f, 0.0f, 0.0f);
-			}
-			else {
-				//hitObj->setColor(235/255.0f, 230/255.0f, 3/255.0f);
-				hitObj->setColor(1.0f, 1.0f, 1.0f);
-			}
-		}
+		Color surfaceColor = getSurfaceColor(hitObj, hitPoint);
 
 		// getSurfaceProperties returns normal of the surface only (for now)
 		hitObj->getSurfaceProperties(hitPoint, orig, dir, objIndex, uv, N, st);
+		if (depth == STARTING_DEPTH && firstHit != nullptr) {
+			firstHit->albedo += glm::vec3(surfaceColor.getColorR(), 
+				surfaceColor.getColorG(), surfaceColor.getColorB());
+			firstHit->normal += N;
+			firstHit->depth += tNear;
+			materialType material = hitObj->getMaterialType();
+			if (material == REFLECTION || 
+				material == REFLECTION_AND_REFRACTION ||
+				material == DIFFUSE_AND_GLOSSY_AND_REFLECTION) {
+				firstHit->specular++;
+			}
+			if (firstHit->count == 0) {
+				firstHit->object = hitObj;
+				firstHit->material = material;
+			}
+			firstHit->count++;
+		}
 
 		switch (hitObj->getMaterialType()) {
 		case LIGHT: {
-			hitColor = hitColor + hitObj->getColor();
+			hitColor = hitColor + surfaceColor;
 		}
 		case REFLECTION_AND_REFRACTION: {
 			float kr = 0.0f; // reflected light ratio
@@ -187,7 +920,8 @@ Color Render::castRay(const glm::vec3& orig, const glm::vec3& dir,
 				// we multiply transmitted ray color by surface color of 
 				// transmitted object to get the transparent dielectric 
 				// color (effect)
-				hitColor = hitColor + hitObj->getColor() *
+				RENDER_STATS_ADD(refractionRays, 1);
+				hitColor = hitColor + surfaceColor *
 					castRay(refract_ray_orig, refract_ray_dir,
 						sources, objects, opts, ++depth, jitter) * kt;
 			}
@@ -195,7 +929,8 @@ Color Render::castRay(const glm::vec3& orig, const glm::vec3& dir,
 			// Generate reflection ray: 
 			reflect(dir, N, hitPoint,
 				reflection_ray_origin, reflection_dir, opts);
-			hitColor = hitColor + hitObj->getColor() *
+			RENDER_STATS_ADD(reflectionRays, 1);
+			hitColor = hitColor + surfaceColor *
 				castRay(reflection_ray_origin, reflection_dir,
 					sources, objects, opts, ++depth, jitter) * kr;
 			break;
@@ -208,6 +943,7 @@ Color Render::castRay(const glm::vec3& orig, const glm::vec3& dir,
 			// compute reflection direction
 			reflect(dir, N, hitPoint,
 				reflection_ray_origin, reflection_dir, opts);
+			RENDER_STATS_ADD(reflectionRays, 1);
 
 			// make recursive call to castRay function to sample the color of 
 			// the reflected ray cast out from the hitPoint 
@@ -225,6 +961,7 @@ Color Render::castRay(const glm::vec3& orig, const glm::vec3& dir,
 			// compute reflection direction
 			reflect(dir, N, hitPoint,
 				reflection_ray_origin, reflection_dir, opts);
+			RENDER_STATS_ADD(reflectionRays, 1);
 			// make recursive call to castRay function to sample the color of 
 			// the reflected ray cast out from the hitPoint 
 			hitColor = hitColor +
@@ -233,7 +970,7 @@ Color Render::castRay(const glm::vec3& orig, const glm::vec3& dir,
 
 			// Apply phong shading
 			hitColor = hitColor + phongShading(dir, N, hitPoint,
-				hitObj, sources, objects, opts, jitter);
+				hitObj, surfaceColor, sources, objects, opts, jitter);
 			break;
 		}
 		// default material is DIFFUSE_AND_GLOSSY 
@@ -241,7 +978,7 @@ Color Render::castRay(const glm::vec3& orig, const glm::vec3& dir,
 		case DIFFUSE_AND_GLOSSY: {
 			// apply Phong shading
 			hitColor = hitColor + phongShading(dir, N, hitPoint,
-				hitObj, sources, objects, opts, jitter);
+				hitObj, surfaceColor, sources, objects, opts, jitter);
 			break;
 		}
 		default: {
@@ -249,34 +986,59 @@ Color Render::castRay(const glm::vec3& orig, const glm::vec3& dir,
 			// apply Phong shading -- the summation already
 			// done inside
 			hitColor = hitColor + phongShading(dir, N, hitPoint,
-				hitObj, sources, objects, opts, jitter);
+				hitObj, surfaceColor, sources, objects, opts, jitter);
 			break;
 		}
 		}
 	}
 	else {
 		// no object intersected, return b.g. color
+		if (depth == STARTING_DEPTH && firstHit != nullptr) {
+			Color background = opts.backgroundColor;
+			firstHit->albedo += glm::vec3(background.getColorR(), 
+				background.getColorG(), background.getColorB());
+			firstHit->count++;
+		}
 		return hitColor = opts.backgroundColor;
 	}
 	// clip color incase value exceeds 1.0f in any component
 	return hitColor.colorClip();
 }
 
-void Render::shuffleFloatArray(glm::vec2* s, int sampleNum)
+void Render::shuffleFloatArray(glm::vec2* s, int sampleNum, PCG32& rng)
 {
 	for (int p = sampleNum * sampleNum - 1; p > 0; --p) {
 		// choose rand num in [0, p]
-		float number = ((float)rand() / (float)RAND_MAX) - .001f;
-		int j = (p + 1) * number;
+		int j = rng.nextUInt(p + 1);
 		std::swap(s[p], s[j]);
 	}
 }
 
+Color Render::getSurfaceColor(Object* hitObj, glm::vec3 hitPoint) {
+	// set floor tiles to be checkered -- on a local copy, the 
+	// object is shared by every render thread
+	Color surfaceColor = hitObj->getColor();
+	if (surfaceColor.getColorSpecial() == 2.0f) {
+		int squareTile = floor(hitPoint.x) + floor(hitPoint.z);
+		float tileColor = (squareTile % 2 == 0) ? 0.0f : 1.0f;
+		surfaceColor.setColorR(tileColor);
+		surfaceColor.setColorG(tileColor);
+		surfaceColor.setColorB(tileColor);
+	}
+	return surfaceColor;
+}
+
 bool Render::trace(glm::vec3 orig, glm::vec3 dir, 
 	const std::vector<Object*>& objects, 
 	float& tNear, int& objIndex, glm::vec2& uv, 
 	Object** hitObject) {
 
+	// hand over to the acceleration structure once one is built
+	if (sceneAccel != nullptr) {
+		return sceneAccel->findIntersection(orig, dir, 
+			tNear, objIndex, uv, hitObject);
+	}
+
 	*hitObject = nullptr;
 	int indexK;
 	glm::vec2 uvK;
@@ -289,7 +1051,7 @@ bool Render::trace(glm::vec3 orig, glm::vec3 dir,
 		if (objects[k]->findIntersection(orig, dir, tCurrNearest, indexK, uvK)
 			&& tCurrNearest < tNear) {
 			tNear = tCurrNearest;
-			objIndex = k;
+			objIndex = indexK;
 			*hitObject = objects[k];
 			uv = uvK;
 		}
@@ -323,6 +1085,7 @@ void Render::fresnel(const glm::vec3& I, glm::vec3& N, float& ior, float& kr) {
 	// obj's refractive index is infinity, i.e. obj is opaque. c/v = Infinity
 	if (sint >= 1.0f || n2 == FLT_MAX) {
 		// TIR occurs 
+		if (sint >= 1.0f) RENDER_STATS_ADD(fresnelTIR, 1);
 		kr = 1.0f;
 	}
 	// if NOT TIR, theres some portion of 
@@ -361,8 +1124,11 @@ glm::vec3 Render::refract(glm::vec3 I, glm::vec3 N, float ior) {
 	// check for total internal reflection TIR -- see if  1- sin(theta2)^2
 	// +ve or -ve, if negative, no portion of ray is transmitted
 	float k = 1 - eta * eta * (1 - cosi * cosi);
-	return k < 0.0f ? glm::vec3(.0f) : 
-		eta * I + nRef * (eta * cosi - sqrtf(k));
+	if (k < 0.0f) {
+		RENDER_STATS_ADD(refractTIR, 1);
+		return glm::vec3(.0f);
+	}
+	return eta * I + nRef * (eta * cosi - sqrtf(k));
 }
 
 void Render::reflect(glm::vec3 ray_dir, glm::vec3 N, 
@@ -378,7 +1144,7 @@ void Render::reflect(glm::vec3 ray_dir, glm::vec3 N,
 }
 
 Color Render::phongShading(const glm::vec3 dir, const glm::vec3 N, 
-	const glm::vec3 hitPoint, Object* hitObj, 
+	const glm::vec3 hitPoint, Object* hitObj, Color surfaceColor,
 	const std::vector<LightSources*>& sources, 
 	const std::vector<Object*>& objects, 
 	const Options& opts, glm::vec2& jitter) {
@@ -391,20 +1157,22 @@ Color Render::phongShading(const glm::vec3 dir, const glm::vec3 N,
 	glm::vec3 shadowOrigPoint = (dot(dir, N) < 0) ?
 		hitPoint + N * opts.bias :
 		hitPoint - N * opts.bias;
-	for (int i = 0; i < sources.size(); i++) {
+	// adds one light's contribution, its color scaled by weight
+	auto shadeLight = [&](LightSources* light, double weight) {
+		Color lightColor = light->getLightColor() * weight;
 		float tShadowNear = FLT_MAX;
 		Object* shadowObj = nullptr;
 		glm::vec3 light_pos;
 		glm::vec3 light_dir;
 		float light_distance_sq;
-		if (sources[i]->getLightType() == AREA_LIGHT) {
+		if (light->getLightType() == AREA_LIGHT) {
 			// we want to sample at a randomized position on the 
 			// area light = corner vector (starting pt) +
 			// some dist in a + 
 			// some dist in b
-			light_pos = sources[i]->getLightPos() +
-				sources[i]->getEdgeA() * jitter.x +
-				sources[i]->getEdgeB() * jitter.y;
+			light_pos = light->getLightPos() +
+				light->getEdgeA() * jitter.x +
+				light->getEdgeB() * jitter.y;
 			light_dir = light_pos - hitPoint;
 			// squared distance from hit point to light source
 			light_distance_sq = dot(light_dir, light_dir);
@@ -412,7 +1180,7 @@ Color Render::phongShading(const glm::vec3 dir, const glm::vec3 N,
 		}
 		else {
 			// get light direction,  
-			light_dir = sources[i]->getLightPos() - hitPoint;
+			light_dir = light->getLightPos() - hitPoint;
 			// squared distance from hit point to light source
 			light_distance_sq = dot(light_dir, light_dir);
 			light_dir = normalize(light_dir);
@@ -422,9 +1190,14 @@ Color Render::phongShading(const glm::vec3 dir, const glm::vec3 N,
 		// to the shadowOrigin than the light, the region will be in shadow
 		glm::vec2 uv;
 		int objIndex;
+		RENDER_STATS_ADD(shadowRays, 1);
 		bool inShadow = trace(shadowOrigPoint, light_dir, objects,
 			tShadowNear, objIndex, uv, &shadowObj) && 
 			(tShadowNear * tShadowNear) < light_distance_sq;
+		// the occluder's material decides how dark the shadow is
+		if (inShadow && tileFootprint != nullptr) {
+			footprint.mark(tileFootprint, shadowObj);
+		}
 
 		// calculate diffuse contribution
 		// not sure why you need to include the surface color in this equation
@@ -434,11 +1207,11 @@ Color Render::phongShading(const glm::vec3 dir, const glm::vec3 N,
 		if (inShadow && 
 			shadowObj->getMaterialType() == REFLECTION_AND_REFRACTION) {
 
-			sumDiffuse = sumDiffuse + sources[i]->getLightColor() *
+			sumDiffuse = sumDiffuse + lightColor *
 				max(0.0f, dot(N, light_dir)) * 0.35f;
 		}
 		else {
-			sumDiffuse = sumDiffuse + sources[i]->getLightColor() *
+			sumDiffuse = sumDiffuse + lightColor *
 				max(0.0f, dot(N, light_dir)) * ((double)1 - inShadow);
 		}
 		// non-purely diffuse materials have specular/shiny component
@@ -446,20 +1219,54 @@ Color Render::phongShading(const glm::vec3 dir, const glm::vec3 N,
 			// calculate specular contribution
 			glm::vec3 scalar = 2.0f * N * dot(light_dir, N);
 			glm::vec3 reflectionDir = normalize(scalar - light_dir);
-			sumSpecular = sumSpecular + sources[i]->getLightColor() *
+			sumSpecular = sumSpecular + lightColor *
 				pow(max(0.0f, dot(reflectionDir, -dir)), 50) *
 				((double)1 - inShadow);
 		}
+	};
+	if (lightTree.empty()) {
+		for (int i = 0; i < sources.size(); i++) {
+			shadeLight(sources[i], 1.0);
+		}
+	}
+	else {
+		// a few lights picked by how much they can add here stand in 
+		// for all of them: each light is expected to be picked with 
+		// its probability, so dividing by it keeps the sum unbiased. 
+		// The picks are stratified over [0, 1)
+		int samples = lightTree.sampleCount();
+		PCG32 rng(LightTree::seedFor(hitPoint, jitter), opts.seed);
+		for (int k = 0; k < samples; ++k) {
+			float pmf;
+			float u = (k + rng.nextFloat()) / samples;
+			LightSources* light = lightTree.sample(hitPoint, N, 
+				min(u, 0.99999994f), pmf);
+			if (light != nullptr) {
+				shadeLight(light, 1.0 / ((double)pmf * samples));
+			}
+		}
 	}
 
 	// sum up the 3 color components 
-	return hitObj->getColor() * opts.ambientLight + // ambient
-		sumDiffuse * hitObj->getColor() * hitObj->kd + // diffuse
+	return surfaceColor * opts.ambientLight + // ambient
+		sumDiffuse * surfaceColor * hitObj->kd + // diffuse
 		sumSpecular * hitObj->ks; // specular 
 }
 void Render::writeImage(std::string fileName, float exposure,
 	float gamma, Color* pixelData, int width, int height) {
 
+	TraceScope scope("writeImage", "io");
+	std::vector<unsigned char> imageData = 
+		toImageData(pixelData, width, height);
+	std::cout << imageData.size() << std::endl;
+	std::cout << height << " " << width << std::endl;
+	TraceScope encodeScope("encodePNG", "io");
+	resultToPNG(fileName, width, height, imageData);
+}
+
+std::vector<unsigned char> Render::toImageData(Color* pixelData, 
+	int width, int height) {
+
 	std::vector<unsigned char> imageData(width * height * 4);
 
 	for (int x = 0; x < width; x++) {
@@ -475,21 +1282,51 @@ void Render::writeImage(std::string fileName, float exposure,
 			imageData[index + 3] = 255.0f; // alpha channel
 		}
 	}
-	std::cout << imageData.size() << std::endl;
-	std::cout << height << " " << width << std::endl;
-	resultToPNG(fileName, width, height, imageData);
+	return imageData;
+}
+
+void Render::writeAOVs(std::string fileName) {
+	for (unsigned aov = 1; aov < AOV_ALL; aov <<= 1) {
+		if (!aovs.has(aov)) continue;
+		std::string aovName = AOVBuffers::fileName(fileName, aov);
+		if (!aovs.write(aovName, aov)) {
+			std::cout << "Couldn't write " << aovName << std::endl;
+		}
+	}
+}
+
+void Render::writeHeatmap(std::string fileName) {
+	if (heatmap.empty()) return;
+	std::vector<Color> image(heatmap.getWidth() * heatmap.getHeight());
+	heatmap.toImage(image.data());
+	writeImage(fileName, 1.0f, 1.0f, image.data(), 
+		heatmap.getWidth(), heatmap.getHeight());
+
+	// swap the extension (if the file name has one) for .csv
+	std::string csvName = fileName;
+	size_t dot = fileName.find_last_of('.');
+	size_t slash = fileName.find_last_of("/\\");
+	if (dot != std::string::npos && 
+		(slash == std::string::npos || dot > slash)) {
+		csvName = fileName.substr(0, dot);
+	}
+	csvName += ".csv";
+	if (!heatmap.writeCSV(csvName)) {
+		std::cout << "Couldn't write " << csvName << std::endl;
+	}
 }
 
 // Pass in an empty light and objects vector, 
 // as well as an integer value to choose a scene.
 // Fills vector w objects & lights for a specified scene. 
 // Objects/shapes and lights taken from "scene.h" file
-// --- Currently there are 4 scenes
+// --- Currently there are 5 scenes
 void Render::selectScene(std::vector<Object*>& sceneObjects,
 	std::vector<LightSources*>& lightSources, 
 	int sceneNumber) {
 
-	if (sceneNumber <= 0 || sceneNumber > 4) return;
+	TraceScope scope("selectScene", "scene", sceneNumber);
+	if (sceneNumber <= 0 || sceneNumber > 5) return;
 	
 	switch (sceneNumber) {
 	case 1: {
@@ -566,6 +1403,34 @@ void Render::selectScene(std::vector<Object*>& sceneObjects,
 		lightSources.push_back(&scene4_areaLight);
 		break;
 	}
+	case 5: {
+		// spiral of instances sharing the one unit sphere
+		// stored in scene5_prototype
+		scene5_instances.clear();
+		scene5_instances.reserve(SCENE5_NUM_INSTANCES);
+		for (int i = 0; i < SCENE5_NUM_INSTANCES; ++i) {
+			float angle = i * 0.35f;
+			float dist = 2.0f + i * 0.25f;
+			float radius = .2f + .1f * (i % 3);
+			glm::vec3 pos(sinf(angle) * dist * .6f, -1.0f + radius, -dist);
+			glm::mat4 transform = glm::translate(glm::mat4(1.0f), pos);
+			transform = glm::scale(transform, glm::vec3(radius));
+			if (i % 2 == 0) {
+				scene5_instances.push_back(Instance(&scene5_prototype,
+					transform, pastel_blue, 3.6f, REFLECTION));
+			}
+			else {
+				scene5_instances.push_back(Instance(&scene5_prototype,
+					transform, white, 1.025f, REFLECTION_AND_REFRACTION));
+			}
+		}
+		for (int i = 0; i < scene5_instances.size(); ++i) {
+			sceneObjects.push_back(&scene5_instances[i]);
+		}
+		sceneObjects.push_back(&scene5_plane1);
+		lightSources.push_back(&scene5_areaLight);
+		break;
+	}
 	default:
 		break;
 	}
@@ -3,33 +3,212 @@
 #include <iostream>
 #include <string>
 #include <vector>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <algorithm>
 #include "../write_image_lib/utils.h"
 #include "../Camera_Ray/Camera.h"
 #define _USE_MATH_DEFINES
 #include <math.h>
 #include "../Options.h"
-#include "windows.h"
 #include "../Shapes_and_globals/Object.h"
 #include "../Lights_Color/LightSources.h"
 #include "../Grid_Acceleration_Structure/Grid.h"
+#include "../Grid_Acceleration_Structure/BVH.h"
+#include "../Grid_Acceleration_Structure/KdTree.h"
 #include "../Shapes_and_globals/Scene.h"
+#include "Random.h"
+#include "RenderStats.h"
+#include "Heatmap.h"
+#include "Trace.h"
+#include "Progress.h"
+#include "Checkpoint.h"
+#include "Preview.h"
+#include "Animation.h"
+#include "Reprojection.h"
+#include "Footprint.h"
+#include "AOV.h"
+#include "Denoiser.h"
+#include "LightTree.h"
+
+// one camera of a Render::renderViews() batch
+struct RenderView {
+	Camera cam;
+	// options.width * options.height pixels
+	Color* colorBuffer;
+	// written as soon as the view's last tile is done, "" for none
+	std::string outFileName;
+};
 
 class Render {
 
 private:
 	//std::vector<Objects*> sceneObjects;
 
+	// false once shareAccelStructure() hands us someone else's
+	bool ownsAccel;
+	std::atomic<bool> cancelled;
+	// the tiles renderEdited() has renderImage() redo, empty for all
+	std::vector<bool> tileMask;
+	// over the lights of the frame being rendered when 
+	// options.lightSamples calls for it, see phongShading()
+	LightTree lightTree;
+
 public:
 	Render();
-	Grid* sceneGrid;
+	~Render();
+
+	// built by startRender() over the scene's objects, 
+	// trace() goes through it when set
+	AccelerationStructure* sceneAccel;
+
+	// Renders over another Render's (or anyone's) structure without 
+	// taking ownership, e.g. concurrent jobs sharing one built scene. 
+	// The structure is only read while rendering.
+	void shareAccelStructure(AccelerationStructure* accel);
+
+	// called by the render thread that finished each tile with the 
+	// tile's pixel bounds [x0, x1) x [y0, y1), so it has to be thread 
+	// safe. Empty by default.
+	std::function<void(int x0, int y0, int x1, int y1)> onTileDone;
+
+	// makes the render threads stop at their next tile, renderImage() 
+	// then returns with the rest of the frame unrendered. Stays set 
+	// for the lifetime of this Render.
+	void cancel();
+	bool isCancelled() const;
+
+	// (Re)builds sceneAccel over the objects using the chosen
+	// structure type (NO_ACCEL just tests every object)
+	void buildAccelStructure(std::vector<Object*>& sceneObjects,
+		accelType type);
+
+	// After objects moved: refits sceneAccel when it can (see 
+	// AccelerationStructure::refit()) and rebuilds it otherwise, 
+	// also when it's shared. Returns true if it was refitted
+	bool updateAccelStructure(std::vector<Object*>& sceneObjects,
+		accelType type);
 
-	// The actual rendering function that generates camera and
-	// camera rays to cast into each pixel
+	// ray counts etc. of the last renderImage() call, merged from 
+	// every render thread (see RenderStats.h)
+	RenderStats stats;
+
+	// time & rays per tile or pixel of the last renderImage() call, 
+	// only filled when options.heatmap isn't HEATMAP_OFF
+	Heatmap heatmap;
+
+	// objects hit per tile by the renderImage() calls with 
+	// options.recordFootprint set, see renderEdited()
+	TileFootprint footprint;
+
+	// the AOVs of the last renderImage() / renderProgressive() call 
+	// with options.aovs or options.denoise (which needs AOV_DENOISE) set
+	AOVBuffers aovs;
+
+	// The actual rendering function: builds the acceleration 
+	// structure then renders the frame with renderImage(), denoised 
+	// after when options.denoise is set
 	void startRender(std::vector<LightSources*>& lights,
 		std::vector<Object*>& sceneObjects,
 		Color* colorBuffer, Camera cam,
-		Options options, glm::vec2* r,
-		glm::vec2* s);
+		Options options);
+
+	// Renders the frame over the already built sceneAccel. 
+	// The image is split into RENDER_TILE_SIZE tiles which 
+	// options.numThreads threads pull off a shared counter. With 
+	// options.checkpointFile set the tiles a killed render of this 
+	// frame finished are restored first, and the finished ones are 
+	// saved as it goes (see Checkpoint.h)
+	void renderImage(std::vector<LightSources*>& lights,
+		std::vector<Object*>& sceneObjects,
+		Color* colorBuffer, Camera& cam,
+		const Options& options);
+
+	// Redoes the frame in colorBuffer, last rendered by renderImage() 
+	// with the same camera & options, after edited's colors or 
+	// materials changed: only the tiles footprint says the edited 
+	// objects show up in are rendered, recording their footprint 
+	// again. Without a footprint of this frame everything is. 
+	// Returns the tiles rendered
+	int renderEdited(std::vector<LightSources*>& lights,
+		std::vector<Object*>& sceneObjects,
+		Color* colorBuffer, Camera& cam,
+		const Options& options, 
+		const std::vector<Object*>& edited);
+
+	// Renders several views of the scene over the already built 
+	// sceneAccel: the tiles of every view go into one queue the 
+	// options.numThreads threads share, so a view finishing doesn't 
+	// leave cores idle. The thread finishing a view's last tile 
+	// writes its outFileName. Each view comes out as renderImage() 
+	// would render it
+	void renderViews(std::vector<LightSources*>& lights,
+		std::vector<Object*>& sceneObjects,
+		std::vector<RenderView>& views,
+		const Options& options);
+
+	// Renders options.animationFrames frames, frame f showing the 
+	// scene at time f / options.animationFPS: animation moves it, the 
+	// structure is updated (see updateAccelStructure()) and the frame 
+	// is handed to a FrameWriter as Animation::frameFileName(fileName, 
+	// f), so it's encoded while the next one renders. The scene is 
+	// left as in the last frame. Returns the frames rendered, fewer 
+	// when cancelled
+	int renderAnimation(std::vector<LightSources*>& lights,
+		std::vector<Object*>& sceneObjects,
+		Animation& animation, Camera cam,
+		const Options& options, const std::string& fileName);
+
+	// Renders the frame reusing what cache recorded of the last one 
+	// where it can (see ReprojectionCache, options.reprojection*): 
+	// every pixel traces its center ray, pixels whose hit matches the 
+	// last frame's keep its color, the rest are rendered as 
+	// renderImage() would. The frame is then recorded in cache. 
+	// Always the whole frame, over the already built sceneAccel. 
+	// Returns the pixels reused
+	int renderReprojected(std::vector<LightSources*>& lights,
+		std::vector<Object*>& sceneObjects,
+		Color* colorBuffer, Camera& cam,
+		const Options& options, ReprojectionCache& cache);
+
+	// Progressive mode: renders one sample per pixel per pass over 
+	// the whole frame into an accumulation buffer until one of 
+	// options' progressive limits is reached (checked between 
+	// passes), writing previews on a background thread. colorBuffer 
+	// gets the average, returns the passes (samples per pixel) 
+	// rendered. The AOVs are averaged over every pass's first hits. 
+	// Without soft shadows there's nothing to refine and this is 
+	// renderImage()
+	int renderProgressive(std::vector<LightSources*>& lights,
+		std::vector<Object*>& sceneObjects,
+		Color* colorBuffer, Camera& cam,
+		const Options& options);
+
+	// direction of the camera ray through point (px, py) of the 
+	// image plane (pixel (x, y) spans [x, x + 1) x [y, y + 1))
+	glm::vec3 cameraRayDir(float px, float py, Camera& cam, 
+		const Options& options);
+
+	// the color seen through point (x + jitter.x, y + jitter.y) of 
+	// the image plane, shadowJitter picks the area light samples
+	Color castCameraRay(int x, int y, glm::vec2 jitter, 
+		glm::vec2 shadowJitter,
+		std::vector<LightSources*>& lights,
+		std::vector<Object*>& sceneObjects,
+		Camera& cam, const Options& options);
+
+	// generates the camera rays for pixel (x, y) and returns the 
+	// averaged color. r, s -- scratch arrays of sampleNum^2 
+	// camera & shadow ray jitter values
+	Color renderPixel(int x, int y, 
+		std::vector<LightSources*>& lights,
+		std::vector<Object*>& sceneObjects,
+		Camera& cam, const Options& options,
+		glm::vec2* r, glm::vec2* s);
 
 	// sets the color data at the i,j-th pixel to be of color value
 	// r, g, b
@@ -48,14 +227,17 @@ public:
 
 	// Shuffles the randomized float values within the 
 	// populated array pointed tp by "s"
-	void shuffleFloatArray(glm::vec2* s, int sampleNum);
+	void shuffleFloatArray(glm::vec2* s, int sampleNum, PCG32& rng);
+
+	// hitObj's color at hitPoint (the checkered floor's tiles etc.)
+	Color getSurfaceColor(Object* hitObj, glm::vec3 hitPoint);
 
 	// Given a ray, computes ray intersections with all of the 
 	// objects in the scene and
 	// Stores intersection info of closest obj intersected.
 	// returns true if object intersected
 	// stores: tNear -- distance to nearest hitpoint
-	// objIndex -- index of nearest object
+	// objIndex -- index reported by the nearest object
 	// uv -- 
 	// hitObj -- stores pointer to the closest object encountered
 	bool trace(glm::vec3 orig, glm::vec3 dir,
@@ -88,9 +270,12 @@ public:
 
 	// Executes the phong shading routine: 
 	// accounts for: ambient, diffuse, and specular lighting 
-	// returns surface Color after summing up all contributions
+	// returns surface Color after summing up all contributions. 
+	// When lightTree is built only lightTree.sampleCount() lights it 
+	// picks are shaded, each weighted by one over its probability
+	// surfaceColor -- hitObj's color at hitPoint (checkered floor etc.)
 	Color phongShading(const glm::vec3 dir, const glm::vec3 N,
-		const glm::vec3 hitPoint, Object* hitObj,
+		const glm::vec3 hitPoint, Object* hitObj, Color surfaceColor,
 		const std::vector<LightSources*>& sources,
 		const std::vector<Object*>& objects,
 		const Options& opts, glm::vec2& jitter);
@@ -100,6 +285,18 @@ public:
 	void writeImage(std::string fileName, float exposure,
 		float gamma, Color* pixelData, int width, int height);
 
+	// the 8 bit RGBA pixels writeImage() encodes
+	std::vector<unsigned char> toImageData(Color* pixelData, 
+		int width, int height);
+
+	// Writes every enabled AOV of aovs as 
+	// AOVBuffers::fileName(fileName, aov)
+	void writeAOVs(std::string fileName);
+
+	// Writes the heatmap as a false color image through writeImage() 
+	// and its numbers to the same name with a .csv extension
+	void writeHeatmap(std::string fileName);
+
 	// Pass in an empty light and objects vector, 
 	// as well as an integer value to choose a scene.
 	// Fills vector w objects & lights for a specified scene. 
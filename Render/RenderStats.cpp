@@ -0,0 +1,55 @@
+#include "RenderStats.h"
+#include "../Shapes_and_globals/BatchIntersect.h"
+#include <stdio.h>
+
+RenderStats::RenderStats() : cameraRays(0), reflectionRays(0), 
+	refractionRays(0), shadowRays(0), primitiveTests(0), 
+	nodesVisited(0), fresnelTIR(0), refractTIR(0), reprojectedPixels(0) {
+	for (int i = 0; i < RENDER_STATS_DEPTHS; ++i) {
+		depthHistogram[i] = 0;
+	}
+}
+
+long long RenderStats::totalRays() const {
+	return cameraRays + reflectionRays + refractionRays + shadowRays;
+}
+
+RenderStats& RenderStats::operator+= (const RenderStats& s) {
+	cameraRays += s.cameraRays;
+	reflectionRays += s.reflectionRays;
+	refractionRays += s.refractionRays;
+	shadowRays += s.shadowRays;
+	primitiveTests += s.primitiveTests;
+	nodesVisited += s.nodesVisited;
+	for (int i = 0; i < RENDER_STATS_DEPTHS; ++i) {
+		depthHistogram[i] += s.depthHistogram[i];
+	}
+	fresnelTIR += s.fresnelTIR;
+	refractTIR += s.refractTIR;
+	reprojectedPixels += s.reprojectedPixels;
+	return *this;
+}
+
+std::string RenderStats::toJSON() const {
+	long long rays = totalRays();
+	char buffer[1024];
+	int length = snprintf(buffer, sizeof(buffer),
+		"{\"enabled\":%s,\"simd\":\"%s\",\"cameraRays\":%lld,\"reflectionRays\":%lld,"
+		"\"refractionRays\":%lld,\"shadowRays\":%lld,"
+		"\"primitiveTests\":%lld,\"primitiveTestsPerRay\":%.3f,"
+		"\"nodesVisited\":%lld,\"nodesVisitedPerRay\":%.3f,"
+		"\"fresnelTIR\":%lld,\"refractTIR\":%lld,\"reprojectedPixels\":%lld,"
+		"\"depthHistogram\":[",
+		RENDER_STATS ? "true" : "false", 
+		simdLevelName(batchKernelLevel()), cameraRays, reflectionRays,
+		refractionRays, shadowRays,
+		primitiveTests, rays > 0 ? (double)primitiveTests / rays : .0,
+		nodesVisited, rays > 0 ? (double)nodesVisited / rays : .0,
+		fresnelTIR, refractTIR, reprojectedPixels);
+	std::string json(buffer, length);
+	for (int i = 0; i < RENDER_STATS_DEPTHS; ++i) {
+		if (i > 0) json += ",";
+		json += std::to_string(depthHistogram[i]);
+	}
+	return json + "]}";
+}
\ No newline at end of file
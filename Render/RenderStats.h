@@ -0,0 +1,86 @@
+#ifndef _RENDER_STATS_H_
+#define _RENDER_STATS_H_
+
+#include <string>
+#include "../Options.h"
+
+// Set to 0 (e.g. /DRENDER_STATS=0) to compile all the counting out, 
+// the counters below then stay at zero
+#ifndef RENDER_STATS
+#define RENDER_STATS 1
+#endif
+
+// castRay() depths go up to MAX_RECURSION_DEPTH + 1 (the call that 
+// gives up), one histogram bucket each
+#define RENDER_STATS_DEPTHS (MAX_RECURSION_DEPTH + 2)
+
+// Where the rays of a frame went. Every render thread counts into 
+// its own copy (RenderStats::local()), renderImage() merges them 
+// into Render::stats once the frame is done.
+struct RenderStats {
+	long long cameraRays;
+	long long reflectionRays;
+	long long refractionRays;
+	long long shadowRays;
+	// Object::findIntersection calls made by the acceleration 
+	// structures (planes included)
+	long long primitiveTests;
+	// BVH / k-d tree nodes or grid cells visited
+	long long nodesVisited;
+	// castRay() calls at each recursion depth
+	long long depthHistogram[RENDER_STATS_DEPTHS];
+	// total internal reflections found by fresnel() and refract()
+	long long fresnelTIR;
+	long long refractTIR;
+	// pixels Render::renderReprojected() took from the last frame
+	long long reprojectedPixels;
+
+	RenderStats();
+
+	long long totalRays() const;
+	RenderStats& operator+= (const RenderStats& s);
+
+	// one line JSON object with the counters, per ray averages and 
+	// the instruction set the batch kernels run with
+	std::string toJSON() const;
+
+	// the calling thread's counters
+	static RenderStats& local() {
+		static thread_local RenderStats stats;
+		return stats;
+	}
+};
+
+#if RENDER_STATS
+#define RENDER_STATS_ADD(counter, n) (RenderStats::local().counter += (n))
+#else
+#define RENDER_STATS_ADD(counter, n) ((void)0)
+#endif
+
+// Counts node visits & primitive tests in locals while an 
+// acceleration structure is traversed and adds them to the thread's 
+// stats when it goes out of scope (so early returns are covered). 
+// Empty when RENDER_STATS is 0.
+class TraversalStats {
+#if RENDER_STATS
+private:
+	long long nodes;
+	long long tests;
+
+public:
+	TraversalStats() : nodes(0), tests(0) {}
+	~TraversalStats() {
+		RenderStats& stats = RenderStats::local();
+		stats.nodesVisited += nodes;
+		stats.primitiveTests += tests;
+	}
+	void node() { ++nodes; }
+	void primitives(int n) { tests += n; }
+#else
+public:
+	void node() {}
+	void primitives(int n) {}
+#endif
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,82 @@
+#include "Reprojection.h"
+#include <math.h>
+
+ReprojectionCache::ReprojectionCache() : valid(false) {
+}
+
+bool ReprojectionCache::reusable(Object* object) {
+	if (object == nullptr) return false;
+	materialType material = object->getMaterialType();
+	return material == DIFFUSE || material == DIFFUSE_AND_GLOSSY || 
+		material == LIGHT;
+}
+
+void ReprojectionCache::clear() {
+	valid = false;
+	std::vector<Pixel>().swap(previous);
+}
+
+bool ReprojectionCache::usableFor(const Options& frameOptions) const {
+	if (!valid) return false;
+	Color a = options.backgroundColor;
+	Color b = frameOptions.backgroundColor;
+	return options.width == frameOptions.width &&
+		options.height == frameOptions.height &&
+		options.fov == frameOptions.fov &&
+		options.aspectRatio == frameOptions.aspectRatio &&
+		options.sampleNum == frameOptions.sampleNum &&
+		options.softShadows == frameOptions.softShadows &&
+		options.seed == frameOptions.seed &&
+		options.ambientLight == frameOptions.ambientLight &&
+		options.bias == frameOptions.bias &&
+		options.selectScene == frameOptions.selectScene &&
+		options.lightSamples == frameOptions.lightSamples &&
+		a.getColorR() == b.getColorR() && 
+		a.getColorG() == b.getColorG() && 
+		a.getColorB() == b.getColorB();
+}
+
+const ReprojectionCache::Pixel* ReprojectionCache::lookup(glm::vec3 P) const {
+	if (!valid) return nullptr;
+	// camera rays run along alpha * screenX + beta * screenY + lookAt 
+	// (see Render::castCameraRay()), solve P - pos = k * that 
+	// for (k * alpha, k * beta, k) by Cramer's rule
+	Camera view = cam;
+	glm::vec3 a = view.getScreenX();
+	glm::vec3 b = view.getScreenY();
+	glm::vec3 c = view.getCamLookAt();
+	glm::vec3 d = P - view.getCamPos();
+	float det = dot(a, cross(b, c));
+	if (det == .0f) return nullptr;
+	float k = dot(a, cross(b, d)) / det;
+	if (k <= .0f) return nullptr;
+	float alpha = dot(d, cross(b, c)) / det / k;
+	float beta = dot(a, cross(d, c)) / det / k;
+
+	float t = tan(options.fov / 2);
+	float px = (alpha / (options.aspectRatio * t) + 1.0f) * 
+		options.width * .5f;
+	float py = (1.0f - beta / t) * options.height * .5f;
+	if (!(px >= .0f && px < options.width && 
+		py >= .0f && py < options.height)) {
+		return nullptr;
+	}
+	return &previous[(int)py * options.width + (int)px];
+}
+
+glm::vec3 ReprojectionCache::getCamPos() const {
+	Camera view = cam;
+	return view.getCamPos();
+}
+
+void ReprojectionCache::begin(const Options& frameOptions) {
+	nextOptions = frameOptions;
+	next.resize(frameOptions.width * frameOptions.height);
+}
+
+void ReprojectionCache::commit(const Camera& frameCam) {
+	previous.swap(next);
+	options = nextOptions;
+	cam = frameCam;
+	valid = true;
+}
\ No newline at end of file
@@ -0,0 +1,71 @@
+#ifndef _REPROJECTION_H_
+#define _REPROJECTION_H_
+
+#include <vector>
+#include <glm/glm.hpp>
+#include "../Options.h"
+#include "../Camera_Ray/Camera.h"
+#include "../Shapes_and_globals/Object.h"
+#include "../Lights_Color/Color.h"
+
+// What the last frame of Render::renderReprojected() saw through 
+// each pixel: where the ray through the pixel's center hit, and the 
+// color the pixel got. The next frame, from a camera that moved a 
+// little, projects its own center hits back into the old camera and 
+// keeps the old color where the same object was hit at (nearly) the 
+// same spot, in the same surface color, from (nearly) the same 
+// direction. Only the rest, mostly disoccluded pixels, is traced again.
+class ReprojectionCache {
+public:
+	struct Pixel {
+		glm::vec3 hit;
+		// nullptr when the center ray left the scene
+		Object* object;
+		// the object's color at hit (see Render::getSurfaceColor()), 
+		// so a texture edge between two hits isn't smeared
+		Color surface;
+		Color color;
+		// frames the color has been carried over, 0 if it was rendered
+		int age;
+	};
+
+private:
+	// the stored frame, and the one being rendered
+	std::vector<Pixel> previous, next;
+	Camera cam;
+	// what previous / next are rendered with
+	Options options, nextOptions;
+	bool valid;
+
+public:
+	ReprojectionCache();
+
+	// only surfaces that look (nearly) the same from a bit further 
+	// along are carried over: diffuse & glossy ones, not reflections
+	static bool reusable(Object* object);
+
+	// forgets the stored frame, e.g. after the scene changed
+	void clear();
+
+	// true if a frame rendered with these options can reuse the 
+	// stored one (same image size, sampling & shading settings)
+	bool usableFor(const Options& frameOptions) const;
+
+	// The stored pixel world point P was seen through, nullptr if 
+	// there's no stored frame, P is behind its camera or off its image
+	const Pixel* lookup(glm::vec3 P) const;
+	// where the stored frame was seen from
+	glm::vec3 getCamPos() const;
+
+	// starts recording a frame of options' size
+	void begin(const Options& frameOptions);
+	// pixel (x, y) of the frame being recorded, each pixel is written 
+	// by one thread
+	void store(int x, int y, const Pixel& pixel) {
+		next[y * nextOptions.width + x] = pixel;
+	}
+	// the recorded frame, seen from frameCam, becomes the stored one
+	void commit(const Camera& frameCam);
+};
+
+#endif
\ No newline at end of file
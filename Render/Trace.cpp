@@ -0,0 +1,101 @@
+#include "Trace.h"
+#include <stdio.h>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+struct TraceEvent {
+	const char* name;
+	const char* category;
+	int thread;
+	// microseconds since enable()
+	double start, duration;
+	int id;
+};
+
+std::atomic<bool> traceEnabled(false);
+std::mutex traceMutex;
+Trace::timePoint traceOrigin;
+std::vector<TraceEvent> traceEvents;
+std::vector<std::pair<int, std::string> > threadNames;
+std::atomic<int> nextThreadId(1);
+
+// small stable ids read better in the viewer than std::thread::id
+int threadId() {
+	static thread_local int id = nextThreadId++;
+	return id;
+}
+
+double microseconds(Trace::timePoint from, Trace::timePoint to) {
+	return std::chrono::duration<double, std::micro>(to - from).count();
+}
+
+}
+
+void Trace::enable() {
+	std::lock_guard<std::mutex> lock(traceMutex);
+	traceEvents.clear();
+	threadNames.clear();
+	traceOrigin = std::chrono::steady_clock::now();
+	traceEnabled = true;
+}
+
+void Trace::disable() {
+	traceEnabled = false;
+}
+
+bool Trace::enabled() {
+	return traceEnabled;
+}
+
+void Trace::setThreadName(const std::string& name) {
+	if (!enabled()) return;
+	int thread = threadId();
+	std::lock_guard<std::mutex> lock(traceMutex);
+	for (int i = 0; i < threadNames.size(); ++i) {
+		if (threadNames[i].first == thread) {
+			threadNames[i].second = name;
+			return;
+		}
+	}
+	threadNames.push_back(std::make_pair(thread, name));
+}
+
+void Trace::addSpan(const char* name, const char* category,
+	timePoint start, timePoint end, int id) {
+	int thread = threadId();
+	std::lock_guard<std::mutex> lock(traceMutex);
+	TraceEvent event = { name, category, thread,
+		microseconds(traceOrigin, start), microseconds(start, end), id };
+	traceEvents.push_back(event);
+}
+
+bool Trace::write(const std::string& fileName) {
+	FILE* file = fopen(fileName.c_str(), "w");
+	if (file == nullptr) return false;
+
+	std::lock_guard<std::mutex> lock(traceMutex);
+	fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	bool first = true;
+	for (int i = 0; i < threadNames.size(); ++i) {
+		fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,"
+			"\"tid\":%d,\"args\":{\"name\":\"%s\"}}", first ? "" : ",\n",
+			threadNames[i].first, threadNames[i].second.c_str());
+		first = false;
+	}
+	for (int i = 0; i < traceEvents.size(); ++i) {
+		const TraceEvent& e = traceEvents[i];
+		fprintf(file, "%s{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\","
+			"\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f", 
+			first ? "" : ",\n", e.name, e.category, e.thread, 
+			e.start, e.duration);
+		if (e.id >= 0) fprintf(file, ",\"args\":{\"id\":%d}", e.id);
+		fprintf(file, "}");
+		first = false;
+	}
+	fprintf(file, "\n]}\n");
+	fclose(file);
+	return true;
+}
\ No newline at end of file
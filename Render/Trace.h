@@ -0,0 +1,67 @@
+#ifndef _TRACE_H_
+#define _TRACE_H_
+
+#include <string>
+#include <chrono>
+
+// Set to 0 (e.g. /DRENDER_TRACE=0) to compile the TraceScope spans 
+// out, Trace::write() then gives an empty timeline
+#ifndef RENDER_TRACE
+#define RENDER_TRACE 1
+#endif
+
+// Timeline of the render phases (scene setup, accel build, tiles per 
+// thread, image encoding) in the chrome trace event format, open the 
+// file in chrome://tracing or ui.perfetto.dev. Nothing is recorded 
+// until enable() is called.
+class Trace {
+public:
+	typedef std::chrono::steady_clock::time_point timePoint;
+
+	// drops old events and starts recording, timestamps are 
+	// relative to this call
+	static void enable();
+	static void disable();
+	static bool enabled();
+
+	// label for the calling thread's row in the viewer
+	static void setThreadName(const std::string& name);
+
+	// a finished span on the calling thread, id shows up under 
+	// args when >= 0 (tile index etc.)
+	static void addSpan(const char* name, const char* category,
+		timePoint start, timePoint end, int id);
+
+	// writes {"traceEvents": [...]}, false if the file can't be opened
+	static bool write(const std::string& fileName);
+};
+
+// Records a span from construction to destruction when tracing is 
+// on. name & category must outlive the scope (string literals).
+class TraceScope {
+#if RENDER_TRACE
+private:
+	const char* name;
+	const char* category;
+	int id;
+	bool active;
+	Trace::timePoint start;
+
+public:
+	TraceScope(const char* name, const char* category, int id = -1) :
+		name(name), category(category), id(id), active(Trace::enabled()) {
+		if (active) start = std::chrono::steady_clock::now();
+	}
+	~TraceScope() {
+		if (active) {
+			Trace::addSpan(name, category, start, 
+				std::chrono::steady_clock::now(), id);
+		}
+	}
+#else
+public:
+	TraceScope(const char* name, const char* category, int id = -1) {}
+#endif
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,242 @@
+#include "RenderCoordinator.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "RenderServer.h"
+#include "Sockets.h"
+
+namespace {
+
+struct Chunk {
+	int firstTile;
+	int tileCount;
+	// workers rendering it right now
+	int assigned;
+	bool done;
+	std::chrono::steady_clock::time_point started;
+};
+
+// keys the coordinator sets itself
+const char* reservedKeys[] = { "firstTile", "tileCount", "format", 
+	"stream", "output" };
+
+}
+
+RenderCoordinator::RenderCoordinator(
+	const std::vector<std::string>& workers, int chunkTiles) :
+	workers(workers), chunkTiles(max(chunkTiles, 1))
+{
+}
+
+bool RenderCoordinator::render(int sceneNumber, accelType accel, 
+	const std::string& renderArgs, std::vector<Color>& frame, 
+	std::string& error) {
+
+	RenderRequest request;
+	if (!request.parse(renderArgs, error)) return false;
+	std::istringstream keys(renderArgs);
+	std::string pair;
+	while (keys >> pair) {
+		for (const char* reserved : reservedKeys) {
+			if (pair.compare(0, pair.find('='), reserved) == 0) {
+				error = std::string(reserved) + " is set by the coordinator";
+				return false;
+			}
+		}
+	}
+	int width = request.options.width;
+	int height = request.options.height;
+	int tilesX = (width + RENDER_TILE_SIZE - 1) / RENDER_TILE_SIZE;
+	int tilesY = (height + RENDER_TILE_SIZE - 1) / RENDER_TILE_SIZE;
+	int numTiles = tilesX * tilesY;
+
+	std::vector<Chunk> chunks;
+	for (int tile = 0; tile < numTiles; tile += chunkTiles) {
+		Chunk chunk;
+		chunk.firstTile = tile;
+		chunk.tileCount = min(chunkTiles, numTiles - tile);
+		chunk.assigned = 0;
+		chunk.done = false;
+		chunks.push_back(chunk);
+	}
+	frame.assign(width * height, request.options.backgroundColor);
+	std::vector<bool> tileDone(numTiles, false);
+	workerStats.assign(workers.size(), WorkerStats());
+
+	std::mutex mutex;
+	std::condition_variable wake;
+	int chunksLeft = (int)chunks.size();
+	double chunkSeconds = .0;
+	int chunksTimed = 0;
+	std::vector<int> workerFds(workers.size(), -1);
+	int running = (int)workers.size();
+	char loadRequest[64];
+	snprintf(loadRequest, sizeof(loadRequest), "load scene=%d accel=%s", 
+		sceneNumber, RenderServer::accelName(accel));
+
+	// next chunk for a worker, -1 if there's nothing to do right now
+	// (called with the mutex held)
+	auto pickChunk = [&](bool& speculative) {
+		for (int c = 0; c < chunks.size(); ++c) {
+			if (!chunks[c].done && chunks[c].assigned == 0) {
+				speculative = false;
+				return c;
+			}
+		}
+		if (chunksTimed == 0) return -1;
+		// nothing unrendered left: help the chunk that has been in 
+		// flight the longest, if it's taking longer than usual
+		std::chrono::steady_clock::time_point now = 
+			std::chrono::steady_clock::now();
+		int oldest = -1;
+		for (int c = 0; c < chunks.size(); ++c) {
+			if (chunks[c].done || chunks[c].assigned != 1) continue;
+			if (oldest < 0 || chunks[c].started < chunks[oldest].started) {
+				oldest = c;
+			}
+		}
+		if (oldest < 0) return -1;
+		double inFlight = std::chrono::duration<double>(
+			now - chunks[oldest].started).count();
+		if (inFlight <= chunkSeconds / chunksTimed) return -1;
+		speculative = true;
+		return oldest;
+	};
+
+	auto work = [&](int w) {
+		WorkerStats& stats = workerStats[w];
+		stats.address = workers[w];
+		stats.chunks = 0;
+		stats.speculative = 0;
+		stats.failed = false;
+
+		int fd = connectTo(workers[w], stats.error);
+		std::string line;
+		SocketReader reader(fd);
+		if (fd >= 0 && (!sendLine(fd, loadRequest) || 
+			!reader.readLine(line) || line.compare(0, 2, "ok") != 0)) {
+			stats.error = line.empty() ? "load failed" : line;
+			close(fd);
+			fd = -1;
+		}
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			workerFds[w] = fd;
+		}
+		std::vector<char> payload;
+		int chunk = -1;
+		bool ok = fd >= 0;
+		while (ok) {
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				bool speculative = false;
+				while (chunksLeft > 0 && 
+					(chunk = pickChunk(speculative)) < 0) {
+					wake.wait_for(lock, std::chrono::milliseconds(10));
+				}
+				if (chunksLeft == 0) break;
+				if (chunks[chunk].assigned++ == 0) {
+					chunks[chunk].started = std::chrono::steady_clock::now();
+				}
+				if (speculative) stats.speculative++;
+			}
+
+			char range[64];
+			snprintf(range, sizeof(range), 
+				" firstTile=%d tileCount=%d format=float", 
+				chunks[chunk].firstTile, chunks[chunk].tileCount);
+			ok = sendLine(fd, "render " + renderArgs + range) && 
+				reader.readLine(line) && line.compare(0, 4, "job ") == 0;
+			while (ok) {
+				ok = reader.readLine(line);
+				if (!ok || line.compare(0, 5, "done ") == 0) break;
+				int x0, y0, tw, th;
+				size_t bytes;
+				ok = sscanf(line.c_str(), "tile %d %d %d %d %zu", 
+					&x0, &y0, &tw, &th, &bytes) == 5 && 
+					bytes == (size_t)tw * th * 3 * sizeof(double) &&
+					x0 >= 0 && y0 >= 0 && x0 + tw <= width && y0 + th <= height;
+				if (!ok) break;
+				payload.resize(bytes);
+				ok = reader.read(payload.data(), bytes);
+				if (!ok) break;
+
+				int tile = (y0 / RENDER_TILE_SIZE) * tilesX + 
+					x0 / RENDER_TILE_SIZE;
+				const double* channels = (const double*)payload.data();
+				std::lock_guard<std::mutex> lock(mutex);
+				// the straggler's copy is the same, first one wins
+				if (tileDone[tile]) continue;
+				for (int y = 0; y < th; ++y) {
+					for (int x = 0; x < tw; ++x) {
+						const double* rgb = channels + 3 * (y * tw + x);
+						Color& pixel = frame[(y0 + y) * width + x0 + x];
+						pixel.setColorR(rgb[0]);
+						pixel.setColorG(rgb[1]);
+						pixel.setColorB(rgb[2]);
+					}
+				}
+				tileDone[tile] = true;
+			}
+			if (!ok && stats.error.empty()) {
+				stats.error = line.compare(0, 6, "error ") == 0 ? 
+					line : "connection lost";
+			}
+
+			std::lock_guard<std::mutex> lock(mutex);
+			chunks[chunk].assigned--;
+			if (ok) {
+				stats.chunks++;
+				if (!chunks[chunk].done) {
+					chunks[chunk].done = true;
+					chunksLeft--;
+					chunkSeconds += std::chrono::duration<double>(
+						std::chrono::steady_clock::now() - 
+						chunks[chunk].started).count();
+					chunksTimed++;
+				}
+			}
+			wake.notify_all();
+		}
+
+		std::lock_guard<std::mutex> lock(mutex);
+		// a worker cut off after the frame was done didn't fail
+		stats.failed = !ok && chunksLeft > 0;
+		if (fd >= 0) close(fd);
+		workerFds[w] = -1;
+		running--;
+		wake.notify_all();
+	};
+
+	std::vector<std::thread> threads;
+	for (int w = 0; w < workers.size(); ++w) {
+		threads.push_back(std::thread(work, w));
+	}
+	{
+		// once the frame is done, stragglers still on a chunk someone 
+		// else finished get cut off (the server cancels a job when 
+		// its client hangs up)
+		std::unique_lock<std::mutex> lock(mutex);
+		wake.wait(lock, [&] { return chunksLeft == 0 || running == 0; });
+		for (int fd : workerFds) {
+			if (fd >= 0) shutdown(fd, SHUT_RDWR);
+		}
+	}
+	for (int i = 0; i < threads.size(); ++i) {
+		threads[i].join();
+	}
+
+	if (chunksLeft > 0) {
+		error = std::to_string(chunksLeft) + " chunks couldn't be rendered";
+		for (const WorkerStats& stats : workerStats) {
+			if (stats.failed) error += ", " + stats.address + ": " + stats.error;
+		}
+		return false;
+	}
+	return true;
+}
\ No newline at end of file
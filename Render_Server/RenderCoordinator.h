@@ -0,0 +1,51 @@
+#ifndef _RENDER_COORDINATOR_H_
+#define _RENDER_COORDINATOR_H_
+
+#include <string>
+#include <vector>
+#include "../Lights_Color/Color.h"
+#include "../Grid_Acceleration_Structure/AccelerationStructure.h"
+
+// Splits one frame across several render servers (RenderServer, 
+// local or on other machines). The frame's tiles are cut into chunks 
+// of consecutive tiles which every worker connection pulls one at a 
+// time, the tiles come back unquantized (format=float) and are 
+// copied into the frame. A worker that fails gives its chunk back, 
+// and once nothing is left to hand out, idle workers also take 
+// chunks that have been in flight for longer than an average chunk 
+// took (stragglers), whichever copy finishes first is kept. Pixels 
+// seed their own random streams, so the frame is the same as a 
+// single process render whoever renders what.
+class RenderCoordinator {
+public:
+	struct WorkerStats {
+		std::string address;
+		int chunks;
+		// chunks taken over from a straggler
+		int speculative;
+		bool failed;
+		std::string error;
+	};
+
+private:
+	std::vector<std::string> workers;
+	int chunkTiles;
+
+public:
+	// chunkTiles -- tiles per chunk handed to a worker
+	RenderCoordinator(const std::vector<std::string>& workers, 
+		int chunkTiles);
+
+	// per worker numbers of the last render()
+	std::vector<WorkerStats> workerStats;
+
+	// Has every worker load the scene, then renders the frame 
+	// described by renderArgs (render request keys, see 
+	// RenderServer.h) into frame. False (and error set) when some 
+	// tiles couldn't be rendered by any worker.
+	bool render(int sceneNumber, accelType accel, 
+		const std::string& renderArgs, std::vector<Color>& frame, 
+		std::string& error);
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,431 @@
+#include "RenderServer.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "Sockets.h"
+
+namespace {
+
+const struct {
+	const char* name;
+	accelType type;
+} accelNames[] = {
+	{ "none", NO_ACCEL },
+	{ "bvh", BVH_ACCEL },
+	{ "kdtree", KDTREE_ACCEL },
+	{ "grid", GRID_ACCEL },
+};
+
+// largest frame a job may ask for, per side and in pixels (each 
+// pixel is a 32 byte Color, so this is about 512 MB)
+const int maxJobSize = 16384;
+const long long maxJobPixels = 4096LL * 4096LL;
+// samples per pixel side (so 4096 per pixel), and render threads per 
+// hardware thread a job may ask for
+const int maxJobSamples = 64;
+const int maxJobThreadsPerCore = 4;
+
+int maxJobThreads() {
+	return maxJobThreadsPerCore * 
+		(int)std::max(1u, std::thread::hardware_concurrency());
+}
+
+bool parseVec3(const std::string& value, glm::vec3& v) {
+	char end;
+	return sscanf(value.c_str(), "%f,%f,%f%c", &v.x, &v.y, &v.z, &end) == 3;
+}
+
+bool parseFloat(const std::string& value, float& f) {
+	char end;
+	return sscanf(value.c_str(), "%f%c", &f, &end) == 1;
+}
+
+bool parseInt(const std::string& value, int& i) {
+	char end;
+	return sscanf(value.c_str(), "%d%c", &i, &end) == 1;
+}
+
+bool parseUInt64(const std::string& value, uint64_t& u) {
+	char end;
+	unsigned long long parsed;
+	if (sscanf(value.c_str(), "%llu%c", &parsed, &end) != 1) return false;
+	u = parsed;
+	return true;
+}
+
+// applies one key=value of a render request
+bool setJobOption(RenderRequest& request, const std::string& key, 
+	const std::string& value) {
+
+	Options& options = request.options;
+	int i;
+	float f;
+	if (key == "width" || key == "height") {
+		if (!parseInt(value, i) || i <= 0 || i > maxJobSize) return false;
+		(key == "width" ? options.width : options.height) = i;
+		return true;
+	}
+	if (key == "samples") {
+		if (!parseInt(value, i) || i <= 0 || i > maxJobSamples) return false;
+		options.sampleNum = (float)i;
+		return true;
+	}
+	if (key == "threads") {
+		if (!parseInt(value, i) || i < 0 || i > maxJobThreads()) return false;
+		options.numThreads = i;
+		return true;
+	}
+	if (key == "fov") {
+		if (!parseFloat(value, f) || f <= .0f || f >= 180.0f) return false;
+		options.fov = M_PI * (f / 180.0f);
+		return true;
+	}
+	if (key == "pos") return parseVec3(value, options.cameraPos);
+	if (key == "forward") return parseVec3(value, options.cameraForward);
+	if (key == "up") return parseVec3(value, options.cameraReferUp);
+	if (key == "softShadows" || key == "stream") {
+		if (!parseInt(value, i)) return false;
+		(key == "stream" ? request.stream : options.softShadows) = i != 0;
+		return true;
+	}
+	if (key == "ambient") return parseFloat(value, options.ambientLight);
+	if (key == "bias") return parseFloat(value, options.bias);
+	if (key == "seed") return parseUInt64(value, options.seed);
+	if (key == "firstTile") {
+		return parseInt(value, options.firstTile) && options.firstTile >= 0;
+	}
+	if (key == "tileCount") return parseInt(value, options.tileCount);
+	if (key == "format") {
+		if (value == "rgba8") request.format = TILE_RGBA8;
+		else if (value == "float") request.format = TILE_FLOAT;
+		else return false;
+		return true;
+	}
+	if (key == "output") {
+		request.output = value;
+		return !value.empty();
+	}
+	if (key == "reproject") {
+		if (!parseInt(value, i)) return false;
+		options.reproject = i != 0;
+		return true;
+	}
+	return false;
+}
+
+double millisecondsSince(std::chrono::steady_clock::time_point start) {
+	return std::chrono::duration<double, std::milli>(
+		std::chrono::steady_clock::now() - start).count();
+}
+
+}
+
+RenderRequest::RenderRequest() : stream(true), format(TILE_RGBA8)
+{
+	// the server's stdout is a log, not a terminal to report to
+	options.progressInterval = .0f;
+}
+
+bool RenderRequest::parse(const std::string& args, std::string& error) {
+	std::istringstream in(args);
+	std::string pair;
+	while (in >> pair) {
+		size_t eq = pair.find('=');
+		if (eq == std::string::npos) {
+			error = "expected key=value, got " + pair;
+			return false;
+		}
+		if (!setJobOption(*this, pair.substr(0, eq), pair.substr(eq + 1))) {
+			error = "bad render argument " + pair;
+			return false;
+		}
+	}
+	if ((long long)options.width * options.height > maxJobPixels) {
+		error = "frame larger than " + std::to_string(maxJobPixels) + 
+			" pixels";
+		return false;
+	}
+	options.aspectRatio = (float)options.width / (float)options.height;
+	return true;
+}
+
+RenderServer::RenderServer(const std::string& address) :
+	address(address), listenFd(-1), stopping(false), 
+	nextJobId(1), runningJobs(0), sceneNumber(0), sceneAccel(NO_ACCEL),
+	sceneVersion(0)
+{
+}
+
+RenderServer::~RenderServer()
+{
+	stop();
+}
+
+const char* RenderServer::accelName(accelType type) {
+	for (const auto& accel : accelNames) {
+		if (accel.type == type) return accel.name;
+	}
+	return "none";
+}
+
+bool RenderServer::accelFromName(const std::string& name, 
+	accelType& type) {
+	for (const auto& accel : accelNames) {
+		if (name == accel.name) {
+			type = accel.type;
+			return true;
+		}
+	}
+	return false;
+}
+
+bool RenderServer::loadScene(int number, accelType type, 
+	double* buildMs) {
+
+	if (number <= 0 || number > 5) return false;
+	// waits for the running jobs, new ones wait for the build
+	std::unique_lock<std::shared_mutex> lock(sceneMutex);
+	std::chrono::steady_clock::time_point start = 
+		std::chrono::steady_clock::now();
+	sceneObjects.clear();
+	lights.clear();
+	resident.selectScene(sceneObjects, lights, number);
+	resident.buildAccelStructure(sceneObjects, type);
+	sceneNumber = number;
+	sceneAccel = type;
+	sceneVersion++;
+	if (buildMs) *buildMs = millisecondsSince(start);
+	return true;
+}
+
+bool RenderServer::run() {
+	std::string error;
+	listenFd = listenOn(address, error);
+	if (listenFd < 0) {
+		std::cerr << "Can't listen on " << error << std::endl;
+		return false;
+	}
+	std::cout << "Listening on " << address << std::endl;
+
+	while (!stopping) {
+		int fd = accept(listenFd, nullptr, nullptr);
+		if (fd < 0) {
+			if (errno == EINTR || errno == ECONNABORTED) continue;
+			break;
+		}
+		std::lock_guard<std::mutex> lock(clientsMutex);
+		if (stopping) {
+			close(fd);
+			break;
+		}
+		if (isTcpAddress(address)) setNoDelay(fd);
+		clientFds.push_back(fd);
+		std::thread(&RenderServer::serveClient, this, fd).detach();
+	}
+
+	// idle clients wake up from recv(), running jobs finish first
+	std::unique_lock<std::mutex> lock(clientsMutex);
+	for (int fd : clientFds) {
+		shutdown(fd, SHUT_RD);
+	}
+	clientsDone.wait(lock, [this] { return clientFds.empty(); });
+	lock.unlock();
+
+	close(listenFd);
+	listenFd = -1;
+	if (!isTcpAddress(address)) unlink(address.c_str());
+	std::cout << "Server stopped" << std::endl;
+	return true;
+}
+
+void RenderServer::stop() {
+	stopping = true;
+	// wakes up accept()
+	int fd = listenFd;
+	if (fd >= 0) shutdown(fd, SHUT_RDWR);
+}
+
+void RenderServer::serveClient(int fd) {
+	SocketReader reader(fd);
+	ClientState client;
+	std::string line;
+	while (reader.readLine(line) && handleRequest(fd, line, client)) {
+	}
+
+	std::lock_guard<std::mutex> lock(clientsMutex);
+	for (int i = 0; i < clientFds.size(); ++i) {
+		if (clientFds[i] == fd) {
+			clientFds.erase(clientFds.begin() + i);
+			break;
+		}
+	}
+	close(fd);
+	clientsDone.notify_all();
+}
+
+bool RenderServer::handleRequest(int fd, const std::string& line, 
+	ClientState& client) {
+	std::istringstream in(line);
+	std::string request, args;
+	in >> request;
+	std::getline(in, args);
+
+	if (request.empty()) return true;
+	if (request == "render") return renderJob(fd, args, client);
+	if (request == "load") return loadRequest(fd, args);
+	if (request == "info") {
+		std::shared_lock<std::shared_mutex> lock(sceneMutex);
+		return sendLine(fd, "ok scene=" + std::to_string(sceneNumber) + 
+			" accel=" + accelName(sceneAccel) + 
+			" objects=" + std::to_string(sceneObjects.size()) +
+			" jobs=" + std::to_string(runningJobs));
+	}
+	if (request == "quit") return false;
+	if (request == "shutdown") {
+		sendLine(fd, "ok");
+		stop();
+		return false;
+	}
+	return sendLine(fd, "error unknown request " + request);
+}
+
+bool RenderServer::loadRequest(int fd, const std::string& args) {
+	int number = 0;
+	accelType type;
+	{
+		std::shared_lock<std::shared_mutex> lock(sceneMutex);
+		type = sceneAccel;
+	}
+	std::istringstream in(args);
+	std::string pair;
+	while (in >> pair) {
+		size_t eq = pair.find('=');
+		std::string key = pair.substr(0, eq);
+		std::string value = eq == std::string::npos ? "" : pair.substr(eq + 1);
+		if (key == "scene" && parseInt(value, number)) continue;
+		if (key == "accel" && accelFromName(value, type)) continue;
+		return sendLine(fd, "error bad load argument " + pair);
+	}
+	double buildMs;
+	if (!loadScene(number, type, &buildMs)) {
+		return sendLine(fd, "error no built-in scene " + 
+			std::to_string(number));
+	}
+	char reply[64];
+	snprintf(reply, sizeof(reply), "ok %.3f", buildMs);
+	return sendLine(fd, reply);
+}
+
+bool RenderServer::renderJob(int fd, const std::string& args, 
+	ClientState& client) {
+	RenderRequest request;
+	std::string error;
+	if (!request.parse(args, error)) {
+		return sendLine(fd, "error " + error);
+	}
+	// anyone who can reach a TCP port could have the server write 
+	// files wherever it can, only local clients get output
+	if (!request.output.empty() && isTcpAddress(address)) {
+		return sendLine(fd, "error output is only taken over unix sockets");
+	}
+	Options& options = request.options;
+	if (options.reproject && (options.firstTile != 0 || options.tileCount >= 0)) {
+		return sendLine(fd, "error reproject renders whole frames");
+	}
+	int width = options.width;
+	int height = options.height;
+	int numTiles = ((width + RENDER_TILE_SIZE - 1) / RENDER_TILE_SIZE) * 
+		((height + RENDER_TILE_SIZE - 1) / RENDER_TILE_SIZE);
+	int firstTile = min(options.firstTile, numTiles);
+	int tiles = numTiles - firstTile;
+	if (options.tileCount >= 0) tiles = min(tiles, options.tileCount);
+
+	std::shared_lock<std::shared_mutex> sceneLock(sceneMutex);
+	if (sceneNumber == 0) {
+		return sendLine(fd, "error no scene loaded");
+	}
+	options.selectScene = sceneNumber;
+	options.accelStructure = sceneAccel;
+	// the cached hits point into the scene that was loaded then
+	if (client.sceneVersion != sceneVersion) {
+		client.reprojection.clear();
+		client.sceneVersion = sceneVersion;
+	}
+	Render job;
+	job.shareAccelStructure(resident.sceneAccel);
+	Camera cam(options.cameraPos, options.cameraForward, 
+		options.cameraReferUp);
+	std::vector<Color> colorBuffer(width * height, options.backgroundColor);
+
+	int id = nextJobId++;
+	if (!sendLine(fd, "job " + std::to_string(id) + " " + 
+		std::to_string(width) + " " + std::to_string(height) + " " + 
+		std::to_string(tiles))) {
+		return false;
+	}
+
+	std::mutex sendMutex;
+	if (request.stream) {
+		job.onTileDone = [&](int x0, int y0, int x1, int y1) {
+			int w = x1 - x0;
+			int h = y1 - y0;
+			std::vector<Color> tile(w * h);
+			for (int y = 0; y < h; ++y) {
+				std::copy(colorBuffer.begin() + (y0 + y) * width + x0, 
+					colorBuffer.begin() + (y0 + y) * width + x1, 
+					tile.begin() + y * w);
+			}
+			std::vector<unsigned char> pixels;
+			if (request.format == TILE_FLOAT) {
+				pixels.resize(w * h * 3 * sizeof(double));
+				double* channels = (double*)pixels.data();
+				for (int i = 0; i < w * h; ++i) {
+					channels[3 * i + 0] = tile[i].getColorR();
+					channels[3 * i + 1] = tile[i].getColorG();
+					channels[3 * i + 2] = tile[i].getColorB();
+				}
+			}
+			else {
+				pixels = job.toImageData(tile.data(), w, h);
+			}
+			char header[96];
+			snprintf(header, sizeof(header), "tile %d %d %d %d %zu\n", 
+				x0, y0, w, h, pixels.size());
+
+			std::lock_guard<std::mutex> lock(sendMutex);
+			if (job.isCancelled()) return;
+			// nobody to render for any more
+			if (!sendAll(fd, header, strlen(header)) ||
+				!sendAll(fd, pixels.data(), pixels.size())) {
+				job.cancel();
+			}
+		};
+	}
+
+	std::chrono::steady_clock::time_point start = 
+		std::chrono::steady_clock::now();
+	runningJobs++;
+	if (options.reproject) {
+		job.renderReprojected(lights, sceneObjects, colorBuffer.data(), 
+			cam, options, client.reprojection);
+	}
+	else {
+		job.renderImage(lights, sceneObjects, colorBuffer.data(), cam, options);
+	}
+	runningJobs--;
+	double wallMs = millisecondsSince(start);
+	sceneLock.unlock();
+	if (job.isCancelled()) return false;
+
+	if (!request.output.empty()) {
+		job.writeImage(request.output, 1.0f, 2.2f, colorBuffer.data(), 
+			width, height);
+	}
+	char done[64];
+	snprintf(done, sizeof(done), "done %d %.3f ", id, wallMs);
+	return sendLine(fd, done + job.stats.toJSON());
+}
\ No newline at end of file
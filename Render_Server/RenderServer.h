@@ -0,0 +1,132 @@
+#ifndef _RENDER_SERVER_H_
+#define _RENDER_SERVER_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../Options.h"
+#include "../Render/Render.h"
+
+// pixel payload of the streamed tiles
+enum tileFormat {
+	// 8 bit RGBA rows, as written to the png
+	TILE_RGBA8,
+	// 3 doubles (the Color channels, host byte order) per pixel, 
+	// unquantized so several processes' tiles assemble into exactly 
+	// the frame a single process renders
+	TILE_FLOAT
+};
+
+// a parsed render request line (see RenderServer)
+struct RenderRequest {
+	Options options;
+	// png the server writes when done, "" for none
+	std::string output;
+	bool stream;
+	tileFormat format;
+
+	RenderRequest();
+	// applies the request's key=value pairs, false (and error set) 
+	// on a bad one
+	bool parse(const std::string& args, std::string& error);
+};
+
+// Long running render daemon on a local (unix domain) or TCP 
+// socket. The scene & its acceleration structure are built once and 
+// stay resident, every client connection gets its own thread and 
+// jobs from different connections render at the same time over the 
+// same read-only structure (each job has its own Render borrowing 
+// it through shareAccelStructure()).
+//
+// Protocol: one text request per line, a connection's requests run 
+// in order.
+//   render [key=value]...   renders a frame, keys:
+//       width, height, samples (per axis), threads (0: all cores), 
+//       fov (degrees), pos, forward, up (x,y,z camera vectors), 
+//       softShadows, ambient, bias, seed (numbers), 
+//       firstTile, tileCount (only render that range of tiles), 
+//       output (png path written by the server when done, unix 
+//       sockets only), 
+//       stream (0 to skip the tile payloads), format (rgba8|float), 
+//       reproject (1: reuse what this connection's last reprojected 
+//       frame saw where it still matches, see ReprojectionCache. 
+//       Whole frames only, for interactive camera moves)
+//     replies  job <id> <width> <height> <tiles>
+//              tile <x0> <y0> <w> <h> <bytes>  + the tile's pixels 
+//                                                 in rows, per 
+//                                                 finished tile
+//              done <id> <wallMs> <stats JSON>
+//   load scene=N [accel=none|bvh|kdtree|grid]
+//     rebuilds the resident scene once running jobs finished, 
+//     replies  ok <buildMs>
+//   info     replies  ok scene=N accel=<name> objects=N jobs=N
+//   quit     closes the connection
+//   shutdown stops the server after the running jobs
+// Bad requests get  error <message>  and the connection stays open. 
+// Frames are capped at 16384 pixels a side and 4096 * 4096 pixels, 
+// samples at 64 per pixel side and threads at 4 per hardware thread. 
+// There's no authentication: anyone reaching the socket can render, 
+// load & shut down, so TCP is for trusted networks only (see Sockets.h)
+class RenderServer {
+private:
+	// unix socket path or host:port, see Sockets.h
+	std::string address;
+	int listenFd;
+	std::atomic<bool> stopping;
+	std::atomic<int> nextJobId;
+	std::atomic<int> runningJobs;
+
+	// jobs hold it shared while rendering, load takes it exclusively
+	std::shared_mutex sceneMutex;
+	std::vector<Object*> sceneObjects;
+	std::vector<LightSources*> lights;
+	// owns the resident acceleration structure
+	Render resident;
+	int sceneNumber;
+	accelType sceneAccel;
+	// bumped by every load, connections drop their cached frames
+	int sceneVersion;
+
+	// what a connection keeps between its requests
+	struct ClientState {
+		ReprojectionCache reprojection;
+		// the scene the cache was filled from
+		int sceneVersion;
+
+		ClientState() : sceneVersion(-1) {}
+	};
+
+	// connected clients, their (detached) threads remove themselves
+	std::mutex clientsMutex;
+	std::condition_variable clientsDone;
+	std::vector<int> clientFds;
+
+	void serveClient(int fd);
+	// returns false when the client went away
+	bool handleRequest(int fd, const std::string& line, 
+		ClientState& client);
+	bool renderJob(int fd, const std::string& args, ClientState& client);
+	bool loadRequest(int fd, const std::string& args);
+
+public:
+	explicit RenderServer(const std::string& address);
+	~RenderServer();
+
+	// (re)builds the resident scene, built-in scenes 1-5
+	bool loadScene(int sceneNumber, accelType type, double* buildMs);
+
+	// accepts connections until a shutdown request or stop(), 
+	// false if the socket couldn't be set up
+	bool run();
+	void stop();
+
+	static const char* accelName(accelType type);
+	// false for an unknown name
+	static bool accelFromName(const std::string& name, accelType& type);
+};
+
+#endif
\ No newline at end of file
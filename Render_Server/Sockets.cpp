@@ -0,0 +1,175 @@
+#include "Sockets.h"
+#include <cerrno>
+#include <cstring>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+bool splitHostPort(const std::string& address, std::string& host, 
+	std::string& port) {
+	size_t colon = address.rfind(':');
+	if (colon == std::string::npos) return false;
+	host = address.substr(0, colon);
+	port = address.substr(colon + 1);
+	return !port.empty();
+}
+
+bool unixAddress(const std::string& path, sockaddr_un& address, 
+	std::string& error) {
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+		error = "bad socket path " + path;
+		return false;
+	}
+	strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+	return true;
+}
+
+int tcpSocket(const std::string& address, bool listening, 
+	std::string& error) {
+	std::string host, port;
+	if (!splitHostPort(address, host, port)) {
+		error = "bad address " + address;
+		return -1;
+	}
+	addrinfo hints;
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+	// an empty host only listens on loopback (connecting to it tries 
+	// every loopback address), every interface has to be asked for 
+	// as 0.0.0.0:port
+	if (listening && host.empty()) host = "127.0.0.1";
+	addrinfo* results = nullptr;
+	int status = getaddrinfo(host.empty() ? nullptr : host.c_str(), 
+		port.c_str(), &hints, &results);
+	if (status != 0) {
+		error = address + ": " + gai_strerror(status);
+		return -1;
+	}
+	int fd = -1;
+	for (addrinfo* ai = results; ai; ai = ai->ai_next) {
+		fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+		if (fd < 0) continue;
+		if (listening) {
+			int on = 1;
+			setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+			if (bind(fd, ai->ai_addr, ai->ai_addrlen) == 0 && 
+				listen(fd, 16) == 0) break;
+		}
+		else if (connect(fd, ai->ai_addr, ai->ai_addrlen) == 0) {
+			setNoDelay(fd);
+			break;
+		}
+		error = address + ": " + strerror(errno);
+		close(fd);
+		fd = -1;
+	}
+	freeaddrinfo(results);
+	return fd;
+}
+
+}
+
+void setNoDelay(int fd) {
+	int on = 1;
+	setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+}
+
+bool isTcpAddress(const std::string& address) {
+	return address.find(':') != std::string::npos && 
+		address.find('/') == std::string::npos;
+}
+
+int listenOn(const std::string& address, std::string& error) {
+	if (isTcpAddress(address)) return tcpSocket(address, true, error);
+
+	sockaddr_un unixAddr;
+	if (!unixAddress(address, unixAddr, error)) return -1;
+	int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (fd < 0) {
+		error = strerror(errno);
+		return -1;
+	}
+	// a stale socket file from a server that didn't exit cleanly
+	unlink(address.c_str());
+	if (bind(fd, (sockaddr*)&unixAddr, sizeof(unixAddr)) < 0 ||
+		listen(fd, 16) < 0) {
+		error = address + ": " + strerror(errno);
+		close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+int connectTo(const std::string& address, std::string& error) {
+	if (isTcpAddress(address)) return tcpSocket(address, false, error);
+
+	sockaddr_un unixAddr;
+	if (!unixAddress(address, unixAddr, error)) return -1;
+	int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (fd < 0) {
+		error = strerror(errno);
+		return -1;
+	}
+	if (connect(fd, (sockaddr*)&unixAddr, sizeof(unixAddr)) < 0) {
+		error = address + ": " + strerror(errno);
+		close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+bool sendAll(int fd, const void* data, size_t size) {
+	const char* bytes = (const char*)data;
+	while (size > 0) {
+		ssize_t sent = send(fd, bytes, size, 0);
+		if (sent < 0 && errno == EINTR) continue;
+		if (sent <= 0) return false;
+		bytes += sent;
+		size -= sent;
+	}
+	return true;
+}
+
+bool sendLine(int fd, const std::string& line) {
+	std::string out = line + "\n";
+	return sendAll(fd, out.data(), out.size());
+}
+
+bool SocketReader::fill() {
+	char chunk[4096];
+	for (;;) {
+		ssize_t received = recv(fd, chunk, sizeof(chunk), 0);
+		if (received < 0 && errno == EINTR) continue;
+		if (received <= 0) return false;
+		buffer.append(chunk, received);
+		return true;
+	}
+}
+
+bool SocketReader::readLine(std::string& line) {
+	size_t end;
+	while ((end = buffer.find('\n')) == std::string::npos) {
+		if (!fill()) return false;
+	}
+	line = buffer.substr(0, end);
+	buffer.erase(0, end + 1);
+	if (!line.empty() && line.back() == '\r') line.pop_back();
+	return true;
+}
+
+bool SocketReader::read(void* data, size_t size) {
+	while (buffer.size() < size) {
+		if (!fill()) return false;
+	}
+	memcpy(data, buffer.data(), size);
+	buffer.erase(0, size);
+	return true;
+}
\ No newline at end of file
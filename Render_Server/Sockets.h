@@ -0,0 +1,47 @@
+#ifndef _SOCKETS_H_
+#define _SOCKETS_H_
+
+#include <string>
+
+// Small blocking socket helpers shared by the render server and the 
+// coordinator. An address is a unix domain socket path unless it 
+// looks like host:port (a ':' and no '/'), which is TCP. An empty 
+// host (":7000") is loopback only, 0.0.0.0:7000 listens on every 
+// interface. The render protocol has no authentication, so TCP is 
+// for trusted networks only.
+
+bool isTcpAddress(const std::string& address);
+
+// bound & listening socket, -1 (and error set) on failure. A stale 
+// unix socket file at the path is replaced.
+int listenOn(const std::string& address, std::string& error);
+
+// connected socket, -1 (and error set) on failure
+int connectTo(const std::string& address, std::string& error);
+
+// TCP_NODELAY, tiles are a header line + payload and nagle would 
+// hold the small lines back
+void setNoDelay(int fd);
+
+// false once the peer went away. SIGPIPE has to be ignored.
+bool sendAll(int fd, const void* data, size_t size);
+bool sendLine(int fd, const std::string& line);
+
+// buffered reads of '\n' terminated lines and raw payloads
+class SocketReader {
+private:
+	int fd;
+	std::string buffer;
+	// false on EOF / error
+	bool fill();
+
+public:
+	explicit SocketReader(int fd) : fd(fd) {}
+
+	// the line without its '\n' (or "\r\n"), false on EOF / error
+	bool readLine(std::string& line);
+	// exactly size bytes
+	bool read(void* data, size_t size);
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,146 @@
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "RenderCoordinator.h"
+#include "RenderServer.h"
+
+namespace {
+
+std::vector<std::string> splitList(const std::string& list) {
+	std::vector<std::string> items;
+	std::istringstream in(list);
+	std::string item;
+	while (std::getline(in, item, ',')) {
+		if (!item.empty()) items.push_back(item);
+	}
+	return items;
+}
+
+// renders the same frame in this process, the distributed one has 
+// to match it exactly
+bool matchesSingleProcess(int sceneNumber, accelType accel, 
+	const std::string& renderArgs, std::vector<Color>& frame) {
+
+	RenderRequest request;
+	std::string error;
+	request.parse(renderArgs, error);
+	Options& options = request.options;
+	options.accelStructure = accel;
+	std::vector<Color> reference(options.width * options.height, 
+		options.backgroundColor);
+	Camera cam(options.cameraPos, options.cameraForward, 
+		options.cameraReferUp);
+	Render renderer;
+	std::vector<Object*> sceneObjects;
+	std::vector<LightSources*> lights;
+	renderer.selectScene(sceneObjects, lights, sceneNumber);
+	renderer.startRender(lights, sceneObjects, reference.data(), cam, 
+		options);
+
+	int different = 0;
+	for (int i = 0; i < reference.size(); ++i) {
+		if (reference[i].getColorR() != frame[i].getColorR() ||
+			reference[i].getColorG() != frame[i].getColorG() ||
+			reference[i].getColorB() != frame[i].getColorB()) {
+			different++;
+		}
+	}
+	std::cout << "Verify: " << different << " of " << reference.size() << 
+		" pixels differ from a single process render" << std::endl;
+	return different == 0;
+}
+
+}
+
+// usage: Render_Coordinator --workers address[,address]... 
+//   [--scene N] [--accel none|bvh|kdtree|grid] [--chunk tiles] 
+//   [--output file.png] [--verify] [render key=value]...
+int main(int argc, char* argv[]) {
+	std::vector<std::string> workers;
+	int sceneNumber = Options().selectScene;
+	accelType accel = Options().accelStructure;
+	int chunkTiles = 8;
+	std::string output;
+	bool verify = false;
+	std::string renderArgs;
+
+	for (int i = 1; i < argc; ++i) {
+		if (!strcmp(argv[i], "--workers") && i + 1 < argc) {
+			std::vector<std::string> list = splitList(argv[++i]);
+			workers.insert(workers.end(), list.begin(), list.end());
+		}
+		else if (!strcmp(argv[i], "--scene") && i + 1 < argc) {
+			sceneNumber = atoi(argv[++i]);
+		}
+		else if (!strcmp(argv[i], "--accel") && i + 1 < argc) {
+			if (!RenderServer::accelFromName(argv[++i], accel)) {
+				std::cerr << "unknown accel " << argv[i] << std::endl;
+				return 1;
+			}
+		}
+		else if (!strcmp(argv[i], "--chunk") && i + 1 < argc) {
+			chunkTiles = atoi(argv[++i]);
+		}
+		else if (!strcmp(argv[i], "--output") && i + 1 < argc) {
+			output = argv[++i];
+		}
+		else if (!strcmp(argv[i], "--verify")) {
+			verify = true;
+		}
+		else if (strchr(argv[i], '=') && argv[i][0] != '-') {
+			renderArgs += std::string(renderArgs.empty() ? "" : " ") + argv[i];
+		}
+		else {
+			workers.clear();
+			break;
+		}
+	}
+	if (workers.empty()) {
+		std::cerr << "usage: " << argv[0] << " --workers address[,address]... "
+			"[--scene N] [--accel none|bvh|kdtree|grid] [--chunk tiles] "
+			"[--output file.png] [--verify] [key=value]..." << std::endl;
+		return 1;
+	}
+
+	// a worker hanging up shows up as a failed send()
+	signal(SIGPIPE, SIG_IGN);
+	std::chrono::steady_clock::time_point start = 
+		std::chrono::steady_clock::now();
+	RenderCoordinator coordinator(workers, chunkTiles);
+	std::vector<Color> frame;
+	std::string error;
+	bool ok = coordinator.render(sceneNumber, accel, renderArgs, frame, 
+		error);
+	double seconds = std::chrono::duration<double>(
+		std::chrono::steady_clock::now() - start).count();
+
+	for (const RenderCoordinator::WorkerStats& stats : 
+		coordinator.workerStats) {
+		std::cout << stats.address << ": " << stats.chunks << " chunks, " << 
+			stats.speculative << " taken from stragglers";
+		if (stats.failed) std::cout << ", failed: " << stats.error;
+		std::cout << std::endl;
+	}
+	if (!ok) {
+		std::cerr << "Render failed: " << error << std::endl;
+		return 1;
+	}
+	std::cout << "Render time: " << seconds << " seconds" << std::endl;
+
+	RenderRequest request;
+	request.parse(renderArgs, error);
+	if (!output.empty()) {
+		Render().writeImage(output, 1.0f, 2.2f, frame.data(), 
+			request.options.width, request.options.height);
+	}
+	if (verify && !matchesSingleProcess(sceneNumber, accel, renderArgs, 
+		frame)) {
+		return 1;
+	}
+	return 0;
+}
\ No newline at end of file
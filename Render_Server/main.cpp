@@ -0,0 +1,64 @@
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include "RenderServer.h"
+
+namespace {
+
+RenderServer* runningServer = nullptr;
+
+// stop() only sets a flag & shuts the listening socket
+void onSignal(int) {
+	if (runningServer) runningServer->stop();
+}
+
+}
+
+// usage: Render_Server [--socket path|host:port] [--scene N] 
+//   [--accel none|bvh|kdtree|grid]
+int main(int argc, char* argv[]) {
+	std::string socketPath = "/tmp/raytracer.sock";
+	int sceneNumber = Options().selectScene;
+	accelType accel = Options().accelStructure;
+
+	for (int i = 1; i < argc; ++i) {
+		if (!strcmp(argv[i], "--socket") && i + 1 < argc) {
+			socketPath = argv[++i];
+		}
+		else if (!strcmp(argv[i], "--scene") && i + 1 < argc) {
+			sceneNumber = atoi(argv[++i]);
+		}
+		else if (!strcmp(argv[i], "--accel") && i + 1 < argc) {
+			if (!RenderServer::accelFromName(argv[++i], accel)) {
+				std::cerr << "unknown accel " << argv[i] << std::endl;
+				return 1;
+			}
+		}
+		else {
+			std::cerr << "usage: " << argv[0] << " [--socket path|host:port] "
+				"[--scene N] [--accel none|bvh|kdtree|grid]" << std::endl;
+			return 1;
+		}
+	}
+
+	RenderServer server(socketPath);
+	double buildMs;
+	if (!server.loadScene(sceneNumber, accel, &buildMs)) {
+		std::cerr << "no built-in scene " << sceneNumber << std::endl;
+		return 1;
+	}
+	std::cout << "Scene " << sceneNumber << " " << 
+		RenderServer::accelName(accel) << " built in " << buildMs << 
+		" ms" << std::endl;
+
+	// a client hanging up mid tile is handled where send() fails
+	signal(SIGPIPE, SIG_IGN);
+	runningServer = &server;
+	signal(SIGINT, onSignal);
+	signal(SIGTERM, onSignal);
+	bool ok = server.run();
+	runningServer = nullptr;
+	return ok ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,82 @@
+#include "BatchIntersect.h"
+#include <stdlib.h>
+
+// the generic copy of the kernels
+#define BATCH_KERNEL_TABLE batchKernelsGeneric
+#include "BatchKernels.inl"
+
+static const BatchKernelTable* const kernelTables[NUM_SIMD_LEVELS] = {
+	&batchKernelsGeneric, &batchKernelsSse4, 
+	&batchKernelsAvx2, &batchKernelsAvx512
+};
+
+struct BatchDispatch {
+	simdLevel level;
+	const BatchKernelTable* kernels;
+
+	// best level the cpu has, RAYTRACER_SIMD can ask for a lower one
+	BatchDispatch() {
+		level = detectSimdLevel();
+		const char* forced = getenv("RAYTRACER_SIMD");
+		if (forced != nullptr) {
+			simdLevel wanted = simdLevelFromName(forced);
+			if (wanted < level) level = wanted;
+		}
+		kernels = kernelTables[level];
+	}
+};
+
+// picked on first use, so static init order doesn't matter
+static BatchDispatch& dispatch() {
+	static BatchDispatch d;
+	return d;
+}
+
+simdLevel batchKernelLevel() {
+	return dispatch().level;
+}
+
+simdLevel setBatchKernelLevel(simdLevel level) {
+	BatchDispatch& d = dispatch();
+	simdLevel supported = detectSimdLevel();
+	d.level = level < supported ? level : supported;
+	d.kernels = kernelTables[d.level];
+	return d.level;
+}
+
+void intersectSpheres(const float* cx, const float* cy, const float* cz,
+	const float* radius, int count,
+	const glm::vec3& orig, const glm::vec3& dir, float* t) {
+	BatchRay ray = { orig.x, orig.y, orig.z, dir.x, dir.y, dir.z };
+	dispatch().kernels->spheres(cx, cy, cz, radius, count, ray, t);
+}
+
+void intersectBoxes(const float* lowerX, const float* lowerY,
+	const float* lowerZ, const float* upperX, const float* upperY,
+	const float* upperZ, int count,
+	const glm::vec3& orig, const glm::vec3& inverseDir, float* t) {
+	BatchRay ray = { orig.x, orig.y, orig.z, 
+		inverseDir.x, inverseDir.y, inverseDir.z };
+	dispatch().kernels->boxes(lowerX, lowerY, lowerZ, 
+		upperX, upperY, upperZ, count, ray, t);
+}
+
+void intersectPlanes(const float* nx, const float* ny, const float* nz,
+	const float* px, const float* py, const float* pz, int count,
+	const glm::vec3& orig, const glm::vec3& dir, float* t) {
+	BatchRay ray = { orig.x, orig.y, orig.z, dir.x, dir.y, dir.z };
+	dispatch().kernels->planes(nx, ny, nz, px, py, pz, count, ray, t);
+}
+
+void intersectRects(const float* cx, const float* cy, const float* cz,
+	const float* nx, const float* ny, const float* nz,
+	const float* e1x, const float* e1y, const float* e1z,
+	const float* e2x, const float* e2y, const float* e2z,
+	const float* e1LenSq, const float* e2LenSq,
+	const float* e1Len, const float* e2Len, int count,
+	const glm::vec3& orig, const glm::vec3& dir, float* t) {
+	BatchRay ray = { orig.x, orig.y, orig.z, dir.x, dir.y, dir.z };
+	dispatch().kernels->rects(cx, cy, cz, nx, ny, nz, 
+		e1x, e1y, e1z, e2x, e2y, e2z, e1LenSq, e2LenSq, 
+		e1Len, e2Len, count, ray, t);
+}
\ No newline at end of file
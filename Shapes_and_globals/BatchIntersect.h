@@ -0,0 +1,61 @@
+#ifndef _BATCH_INTERSECT_H_
+#define _BATCH_INTERSECT_H_
+
+#include <glm/glm.hpp>
+#include <float.h>
+#include "CpuFeatures.h"
+
+// One ray against a batch of primitives stored as a struct of 
+// arrays (one array per component). Each kernel does the same math 
+// and the same rejections as the object's own findIntersection(), 
+// only with the branches turned into selects, so the loop over the 
+// batch vectorizes and gives bit-identical distances. 
+// (gcc/clang only vectorize all of them at -O3 with -fno-math-errno 
+// -fno-trapping-math, msvc does at /O2)
+// They're compiled for every simdLevel and the best one the cpu 
+// supports is picked on first use, see BatchKernels.h.
+// t[i] -- distance to the i-th primitive, FLT_MAX where it's missed
+
+// level the kernels run at: the highest the cpu supports, or the 
+// RAYTRACER_SIMD environment variable (generic|sse4|avx2|avx512) 
+// if that's lower
+simdLevel batchKernelLevel();
+
+// switches every kernel to "level", capped at what the cpu 
+// supports, and returns the level now in use. Not thread safe, 
+// don't call it while rendering
+simdLevel setBatchKernelLevel(simdLevel level);
+
+// Sphere::findIntersection
+// cx, cy, cz -- centers, radius -- radii
+void intersectSpheres(const float* cx, const float* cy, const float* cz,
+	const float* radius, int count, 
+	const glm::vec3& orig, const glm::vec3& dir, float* t);
+
+// Box::findIntersection & Bbox::findIntersection (entry point only, 
+// rays starting inside miss)
+// lower/upper -- plain min & max corners (see Bbox::getLower/getUpper)
+// inverseDir -- 1 / ray direction
+void intersectBoxes(const float* lowerX, const float* lowerY, 
+	const float* lowerZ, const float* upperX, const float* upperY, 
+	const float* upperZ, int count, 
+	const glm::vec3& orig, const glm::vec3& inverseDir, float* t);
+
+// Plane::findIntersection
+// nx, ny, nz -- normals, px, py, pz -- a point on each plane
+void intersectPlanes(const float* nx, const float* ny, const float* nz, 
+	const float* px, const float* py, const float* pz, int count, 
+	const glm::vec3& orig, const glm::vec3& dir, float* t);
+
+// Rect::findIntersection
+// c -- corners, n -- normals, e1/e2 -- edges, 
+// e1LenSq/e2LenSq -- dot(edge, edge), e1Len/e2Len -- length(edge)
+void intersectRects(const float* cx, const float* cy, const float* cz,
+	const float* nx, const float* ny, const float* nz,
+	const float* e1x, const float* e1y, const float* e1z,
+	const float* e2x, const float* e2y, const float* e2z,
+	const float* e1LenSq, const float* e2LenSq,
+	const float* e1Len, const float* e2Len, int count,
+	const glm::vec3& orig, const glm::vec3& dir, float* t);
+
+#endif
\ No newline at end of file
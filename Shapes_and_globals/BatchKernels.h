@@ -0,0 +1,41 @@
+#ifndef _BATCH_KERNELS_H_
+#define _BATCH_KERNELS_H_
+
+// Internal to BatchIntersect.cpp: the batch kernels are compiled once 
+// per simdLevel (BatchKernels.inl included by BatchIntersect.cpp and 
+// BatchKernels<Level>.cpp, each built with that level's flags) and 
+// the dispatcher picks one of these tables at startup.
+// They only take plain floats so no inline glm / std function ends up 
+// compiled with e.g. AVX-512 and picked by the linker for code that 
+// runs on older cpus.
+
+struct BatchRay {
+	float ox, oy, oz;
+	// the direction, or 1 / direction for the box kernel
+	float dx, dy, dz;
+};
+
+struct BatchKernelTable {
+	void (*spheres)(const float* cx, const float* cy, const float* cz,
+		const float* radius, int count, const BatchRay& ray, float* t);
+	void (*boxes)(const float* lowerX, const float* lowerY,
+		const float* lowerZ, const float* upperX, const float* upperY,
+		const float* upperZ, int count, const BatchRay& ray, float* t);
+	void (*planes)(const float* nx, const float* ny, const float* nz,
+		const float* px, const float* py, const float* pz, int count,
+		const BatchRay& ray, float* t);
+	void (*rects)(const float* cx, const float* cy, const float* cz,
+		const float* nx, const float* ny, const float* nz,
+		const float* e1x, const float* e1y, const float* e1z,
+		const float* e2x, const float* e2y, const float* e2z,
+		const float* e1LenSq, const float* e2LenSq,
+		const float* e1Len, const float* e2Len, int count,
+		const BatchRay& ray, float* t);
+};
+
+extern const BatchKernelTable batchKernelsGeneric;
+extern const BatchKernelTable batchKernelsSse4;
+extern const BatchKernelTable batchKernelsAvx2;
+extern const BatchKernelTable batchKernelsAvx512;
+
+#endif
\ No newline at end of file
@@ -0,0 +1,115 @@
+// Kernel bodies, included once per instruction set level with 
+// BATCH_KERNEL_TABLE set to the name of the table to define (see 
+// BatchKernels.h). Everything else stays in an unnamed namespace so 
+// each copy is private to its translation unit.
+#include <math.h>
+#include <float.h>
+#include "BatchKernels.h"
+
+namespace {
+
+void intersectSpheres(const float* cx, const float* cy, const float* cz,
+	const float* radius, int count, const BatchRay& ray, float* t) {
+
+	// copied out so the compiler knows the stores to t can't change them
+	float ox = ray.ox, oy = ray.oy, oz = ray.oz;
+	float dx = ray.dx, dy = ray.dy, dz = ray.dz;
+	float a = dx * dx + dy * dy + dz * dz;
+	for (int i = 0; i < count; ++i) {
+		float rx = ox - cx[i];
+		float ry = oy - cy[i];
+		float rz = oz - cz[i];
+		float b = 2 * (dx * rx + dy * ry + dz * rz);
+		float c = (rx * rx + ry * ry + rz * rz) - (radius[i] * radius[i]);
+		float discriminant = (b * b) - (4 * a * c);
+		// sqrt of a negative is NaN here, masked out below
+		float rootDiscriminant = sqrtf(discriminant);
+		float t0 = (-b - rootDiscriminant) / (2.0f * a);
+		float t1 = (-b + rootDiscriminant) / (2.0f * a);
+		float tSphere = t0 < 0.0f ? t1 : t0;
+		bool hit = (discriminant >= 0.0f) & (tSphere >= 0.0f);
+		t[i] = hit ? tSphere : FLT_MAX;
+	}
+}
+
+void intersectBoxes(const float* lowerX, const float* lowerY,
+	const float* lowerZ, const float* upperX, const float* upperY,
+	const float* upperZ, int count, const BatchRay& ray, float* t) {
+
+	// the direction signs are the same for the whole batch, so pick 
+	// the near & far slab arrays once instead of per box
+	float ix = ray.dx, iy = ray.dy, iz = ray.dz;
+	const float* nearX = ix >= .0f ? lowerX : upperX;
+	const float* farX = ix >= .0f ? upperX : lowerX;
+	const float* nearY = iy >= .0f ? lowerY : upperY;
+	const float* farY = iy >= .0f ? upperY : lowerY;
+	const float* nearZ = iz >= .0f ? lowerZ : upperZ;
+	const float* farZ = iz >= .0f ? upperZ : lowerZ;
+	float ox = ray.ox, oy = ray.oy, oz = ray.oz;
+	for (int i = 0; i < count; ++i) {
+		float tminx = (nearX[i] - ox) * ix;
+		float tmaxx = (farX[i] - ox) * ix;
+		float tminy = (nearY[i] - oy) * iy;
+		float tmaxy = (farY[i] - oy) * iy;
+		float tminz = (nearZ[i] - oz) * iz;
+		float tmaxz = (farZ[i] - oz) * iz;
+
+		bool missXY = (tminx > tmaxy) | (tminy > tmaxx);
+		float tmin = tminx < tminy ? tminy : tminx;
+		float tmax = tmaxx > tmaxy ? tmaxy : tmaxx;
+		bool missZ = (tmin > tmaxz) | (tmax < tminz);
+		tmin = tmin < tminz ? tminz : tmin;
+		bool hit = !(missXY | missZ) & (tmin > 0.0f);
+		t[i] = hit ? tmin : FLT_MAX;
+	}
+}
+
+void intersectPlanes(const float* nx, const float* ny, const float* nz,
+	const float* px, const float* py, const float* pz, int count,
+	const BatchRay& ray, float* t) {
+
+	float ox = ray.ox, oy = ray.oy, oz = ray.oz;
+	float dx = ray.dx, dy = ray.dy, dz = ray.dz;
+	for (int i = 0; i < count; ++i) {
+		float denom = dx * nx[i] + dy * ny[i] + dz * nz[i];
+		float numer = (px[i] - ox) * nx[i] + 
+			(py[i] - oy) * ny[i] + (pz[i] - oz) * nz[i];
+		float tPlane = numer / denom;
+		bool hit = (fabsf(denom) >= 0.0001f) & (tPlane >= 0.0001f);
+		t[i] = hit ? tPlane : FLT_MAX;
+	}
+}
+
+void intersectRects(const float* cx, const float* cy, const float* cz,
+	const float* nx, const float* ny, const float* nz,
+	const float* e1x, const float* e1y, const float* e1z,
+	const float* e2x, const float* e2y, const float* e2z,
+	const float* e1LenSq, const float* e2LenSq,
+	const float* e1Len, const float* e2Len, int count,
+	const BatchRay& ray, float* t) {
+
+	float ox = ray.ox, oy = ray.oy, oz = ray.oz;
+	float dx = ray.dx, dy = ray.dy, dz = ray.dz;
+	for (int i = 0; i < count; ++i) {
+		float denom = dx * nx[i] + dy * ny[i] + dz * nz[i];
+		float numer = (cx[i] - ox) * nx[i] + 
+			(cy[i] - oy) * ny[i] + (cz[i] - oz) * nz[i];
+		float tRect = numer / denom;
+		// vector from the corner to the hit point on the plane
+		float px = (ox + dx * tRect) - cx[i];
+		float py = (oy + dy * tRect) - cy[i];
+		float pz = (oz + dz * tRect) - cz[i];
+		float length1 = (px * e1x[i] + py * e1y[i] + pz * e1z[i]) / e1LenSq[i];
+		float length2 = (px * e2x[i] + py * e2y[i] + pz * e2z[i]) / e2LenSq[i];
+		bool hit = (fabsf(denom) >= 0.0001f) & (tRect >= 0.0001f) &
+			(0.0f < length1) & (length1 <= e1Len[i]) & 
+			(0.0f < length2) & (length2 <= e2Len[i]);
+		t[i] = hit ? tRect : FLT_MAX;
+	}
+}
+
+}
+
+const BatchKernelTable BATCH_KERNEL_TABLE = {
+	intersectSpheres, intersectBoxes, intersectPlanes, intersectRects
+};
\ No newline at end of file
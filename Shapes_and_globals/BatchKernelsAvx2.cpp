@@ -0,0 +1,4 @@
+// The batch kernels built for AVX2 (-mavx2 in CMakeLists.txt, 
+// /arch:AVX2 in the vcxproj files)
+#define BATCH_KERNEL_TABLE batchKernelsAvx2
+#include "BatchKernels.inl"
\ No newline at end of file
@@ -0,0 +1,4 @@
+// The batch kernels built for AVX-512 F/DQ/BW/VL with 512 bit 
+// vectors (see CMakeLists.txt, /arch:AVX512 in the vcxproj files)
+#define BATCH_KERNEL_TABLE batchKernelsAvx512
+#include "BatchKernels.inl"
\ No newline at end of file
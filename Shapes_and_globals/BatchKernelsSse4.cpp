@@ -0,0 +1,4 @@
+// The batch kernels built for SSE4.2 (-msse4.2, set in CMakeLists.txt). 
+// msvc has no SSE4 switch, there this is the generic code again
+#define BATCH_KERNEL_TABLE batchKernelsSse4
+#include "BatchKernels.inl"
\ No newline at end of file
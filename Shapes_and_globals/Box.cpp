@@ -205,3 +205,22 @@ materialType Box::getMaterialType()
 {
     return material;
 }
+
+// the centroid member isn't set by every constructor, 
+// the bounds are what the intersection uses
+bool Box::getPosition(glm::vec3& pos)
+{
+    pos = (bounds[0] + bounds[1]) * 0.5f;
+    return true;
+}
+
+bool Box::setPosition(glm::vec3 pos)
+{
+    glm::vec3 offset = pos - (bounds[0] + bounds[1]) * 0.5f;
+    bounds[0] += offset;
+    bounds[1] += offset;
+    centroid = pos;
+    bbox.minBounds = bounds[0];
+    bbox.maxBounds = bounds[1];
+    return true;
+}
@@ -33,5 +33,8 @@ public:
 		glm::vec2& st);
 
 	materialType getMaterialType();
+
+	bool getPosition(glm::vec3& pos);
+	bool setPosition(glm::vec3 pos);
 };
 #endif
\ No newline at end of file
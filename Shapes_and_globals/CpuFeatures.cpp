@@ -0,0 +1,84 @@
+#include "CpuFeatures.h"
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || \
+	defined(_M_IX86)
+#define CPU_FEATURES_X86 1
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+static const char* simdLevelNames[NUM_SIMD_LEVELS] = {
+	"generic", "sse4", "avx2", "avx512"
+};
+
+#ifdef CPU_FEATURES_X86
+// eax, ebx, ecx, edx of cpuid(leaf, subleaf)
+static void cpuid(unsigned leaf, unsigned subleaf, unsigned regs[4]) {
+#ifdef _MSC_VER
+	int r[4];
+	__cpuidex(r, (int)leaf, (int)subleaf);
+	for (int i = 0; i < 4; ++i) regs[i] = (unsigned)r[i];
+#else
+	__cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+// which register states the OS saves on a context switch (XCR0)
+static unsigned long long xgetbv0() {
+#ifdef _MSC_VER
+	return _xgetbv(0);
+#else
+	unsigned lo, hi;
+	__asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+	return ((unsigned long long)hi << 32) | lo;
+#endif
+}
+#endif
+
+simdLevel detectSimdLevel() {
+#ifdef CPU_FEATURES_X86
+	unsigned regs[4];
+	cpuid(0, 0, regs);
+	unsigned maxLeaf = regs[0];
+	if (maxLeaf < 1) return SIMD_GENERIC;
+
+	cpuid(1, 0, regs);
+	bool sse4 = (regs[2] & (1u << 19)) && (regs[2] & (1u << 20));
+	bool osxsave = (regs[2] & (1u << 27)) != 0;
+	bool avx = (regs[2] & (1u << 28)) != 0;
+	if (!sse4) return SIMD_GENERIC;
+	if (!osxsave || !avx || maxLeaf < 7) return SIMD_SSE4;
+
+	unsigned long long xcr0 = xgetbv0();
+	// xmm & ymm state
+	if ((xcr0 & 0x6) != 0x6) return SIMD_SSE4;
+	cpuid(7, 0, regs);
+	bool avx2 = (regs[1] & (1u << 5)) != 0;
+	if (!avx2) return SIMD_SSE4;
+
+	// F, DQ, BW & VL (skylake-x and later) plus opmask & zmm state
+	unsigned avx512Bits = (1u << 16) | (1u << 17) | (1u << 30) | (1u << 31);
+	if ((regs[1] & avx512Bits) == avx512Bits && (xcr0 & 0xE0) == 0xE0) {
+		return SIMD_AVX512;
+	}
+	return SIMD_AVX2;
+#else
+	return SIMD_GENERIC;
+#endif
+}
+
+const char* simdLevelName(simdLevel level) {
+	if (level < 0 || level >= NUM_SIMD_LEVELS) return "unknown";
+	return simdLevelNames[level];
+}
+
+simdLevel simdLevelFromName(const char* name) {
+	for (int i = 0; i < NUM_SIMD_LEVELS; ++i) {
+		if (!strcmp(name, simdLevelNames[i])) return (simdLevel)i;
+	}
+	return NUM_SIMD_LEVELS;
+}
\ No newline at end of file
@@ -0,0 +1,25 @@
+#ifndef _CPU_FEATURES_H_
+#define _CPU_FEATURES_H_
+
+// Instruction set levels the batch kernels are compiled for, in 
+// increasing order. GENERIC is whatever the build targets by default 
+// (SSE2 on x86-64, or the RAYTRACER_ARCH preset), also used on 
+// non-x86 cpus.
+enum simdLevel { 
+	SIMD_GENERIC, 
+	SIMD_SSE4, 
+	SIMD_AVX2, 
+	SIMD_AVX512, 
+	NUM_SIMD_LEVELS 
+};
+
+// highest level this cpu & OS support (CPUID + XGETBV, so AVX state 
+// the OS doesn't save doesn't count)
+simdLevel detectSimdLevel();
+
+// "generic", "sse4", "avx2", "avx512"
+const char* simdLevelName(simdLevel level);
+// NUM_SIMD_LEVELS for an unknown name
+simdLevel simdLevelFromName(const char* name);
+
+#endif
\ No newline at end of file
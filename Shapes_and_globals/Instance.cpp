@@ -0,0 +1,119 @@
+#include "Instance.h"
+
+Instance::Instance(AccelerationStructure* proto, glm::mat4 transform,
+	Color c, float refractIdx, materialType mat) {
+
+	prototype = proto;
+	prototype->indexObjects();
+	color = c;
+	material = mat;
+	ior = refractIdx;
+	// Opaque objects have infinite idx of refrac
+	if (mat == REFLECTION ||
+		mat == DIFFUSE_AND_GLOSSY ||
+		mat == DIFFUSE_AND_GLOSSY_AND_REFLECTION) {
+		ior = FLT_MAX;
+	}
+	setTransform(transform);
+}
+
+void Instance::setTransform(glm::mat4 transform) {
+	objectToWorld = transform;
+	worldToObject = glm::inverse(transform);
+	normalToWorld = glm::mat3(glm::transpose(worldToObject));
+
+	// build routine for bounding box min, max: 
+	// the world space box around all 8 transformed corners
+	// of the prototype's bounds
+	Bbox protoBounds = prototype->getBounds();
+	// a prototype holding planes stays infinite (transforming
+	// FLT_MAX corners would only give inf/nan)
+	if (protoBounds.isUnbounded()) {
+		bbox = protoBounds;
+		return;
+	}
+	bbox = Bbox();
+	glm::vec3 lower = protoBounds.getLower();
+	glm::vec3 upper = protoBounds.getUpper();
+	for (int i = 0; i < 8; ++i) {
+		glm::vec3 corner(
+			(i & 1) ? upper.x : lower.x,
+			(i & 2) ? upper.y : lower.y,
+			(i & 4) ? upper.z : lower.z);
+		bbox.extendBy(glm::vec3(objectToWorld * glm::vec4(corner, 1.0f)));
+	}
+}
+
+bool Instance::findIntersection(glm::vec3 orig, glm::vec3 dir,
+	float& tNear, int& index, glm::vec2& uv) const {
+
+	glm::vec3 objOrig = glm::vec3(worldToObject * glm::vec4(orig, 1.0f));
+	glm::vec3 objDir = glm::vec3(worldToObject * glm::vec4(dir, .0f));
+	Object* hitObj = nullptr;
+	float t = FLT_MAX;
+	int partIndex = 0;
+	if (!prototype->findIntersection(objOrig, objDir, t, partIndex, uv, &hitObj)) {
+		return false;
+	}
+	tNear = t;
+	// which prototype object was hit, so getSurfaceProperties() doesn't 
+	// have to find it again. Only instances report an index worth 
+	// keeping, a nested one's goes above the slot
+	int slot = prototype->objectSlot(hitObj);
+	index = slot;
+	if (prototype->isInstanceAt(slot)) {
+		index += partIndex * prototype->objectCount();
+	}
+	return true;
+}
+
+Color Instance::getColor() {
+	return color;
+}
+
+void Instance::setColor(float r, float g, float b) {
+	color.setColorR(r);
+	color.setColorG(g);
+	color.setColorB(b);
+}
+
+// the normal depends on which prototype object is hit, which 
+// needs the ray -- see getSurfaceProperties()
+glm::vec3 Instance::getNormal(glm::vec3 point) {
+	return glm::vec3(.0f);
+}
+
+glm::mat4 Instance::getTransform() {
+	return objectToWorld;
+}
+
+void Instance::getSurfaceProperties(const glm::vec3& P, 
+	const glm::vec3 orig, const glm::vec3& I, const int& index, 
+	const glm::vec2& uv, glm::vec3& N, glm::vec2& st) {
+
+	int count = prototype->objectCount();
+	Object* part = prototype->objectAt(index % count);
+	glm::vec3 objP = glm::vec3(worldToObject * glm::vec4(P, 1.0f));
+	glm::vec3 objOrig = glm::vec3(worldToObject * glm::vec4(orig, 1.0f));
+	glm::vec3 objDir = glm::vec3(worldToObject * glm::vec4(I, .0f));
+	glm::vec3 objN;
+	part->getSurfaceProperties(objP, objOrig, objDir, index / count, uv, 
+		objN, st);
+	N = normalize(normalToWorld * objN);
+}
+
+materialType Instance::getMaterialType() {
+	return material;
+}
+
+bool Instance::getPosition(glm::vec3& pos) {
+	pos = glm::vec3(objectToWorld[3]);
+	return true;
+}
+
+bool Instance::setPosition(glm::vec3 pos) {
+	glm::mat4 transform = objectToWorld;
+	transform[3] = glm::vec4(pos, 1.0f);
+	setTransform(transform);
+	return true;
+}
\ No newline at end of file
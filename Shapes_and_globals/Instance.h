@@ -0,0 +1,60 @@
+#ifndef _INSTANCE_H_
+#define _INSTANCE_H_
+
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include "../Lights_Color/Color.h"
+#include "../Grid_Acceleration_Structure/AccelerationStructure.h"
+#include "Object.h"
+
+// A transformed copy of some shared geometry. The geometry lives
+// (once) in the prototype acceleration structure in its own object 
+// space; rays are carried into that space at the instance boundary,
+// so thousands of instances cost a matrix each, not a copy of the
+// geometry. Color & material belong to the instance.
+class Instance : public Object {
+private:
+	AccelerationStructure* prototype;
+	glm::mat4 objectToWorld;
+	glm::mat4 worldToObject;
+	// inverse transpose, carries normals back into world space
+	glm::mat3 normalToWorld;
+	Color color;
+
+public:
+	Instance(AccelerationStructure* proto, glm::mat4 transform,
+		Color c, float refractIdx, materialType mat);
+
+	// transforms the ray into object space and intersects the 
+	// prototype. The direction is not re-normalized, so the 
+	// parametric distance tNear is the same in both spaces. index 
+	// is the hit prototype object's slot (see 
+	// AccelerationStructure::indexObjects()), plus the slots * the 
+	// index it reported when that object is an instance too; uv is 
+	// the object's
+	bool findIntersection(glm::vec3 orig, glm::vec3 dir,
+		float& tNear, int& index, glm::vec2& uv) const;
+
+	Color getColor();
+	void setColor(float r, float g, float b);
+	glm::vec3 getNormal(glm::vec3 point);
+	glm::mat4 getTransform();
+	// replaces the transform, refitting bbox around the prototype
+	void setTransform(glm::mat4 transform);
+
+	// Shades the prototype object findIntersection() put in index 
+	// and takes its normal back into world space
+	void getSurfaceProperties(const glm::vec3& P, const glm::vec3 orig,
+		const glm::vec3& I, const int& index,
+		const glm::vec2& uv, glm::vec3& N,
+		glm::vec2& st);
+
+	materialType getMaterialType();
+
+	// the translation part of the transform
+	bool getPosition(glm::vec3& pos);
+	bool setPosition(glm::vec3 pos);
+};
+
+#endif
\ No newline at end of file
@@ -34,3 +34,15 @@ materialType Object::getMaterialType() {
 	// empty body
 	return DIFFUSE;
 }
+
+bool Object::getPlane(glm::vec3& normal, glm::vec3& point) const {
+	return false;
+}
+
+bool Object::getPosition(glm::vec3& pos) {
+	return false;
+}
+
+bool Object::setPosition(glm::vec3 pos) {
+	return false;
+}
@@ -44,6 +44,17 @@ public:
 
 	virtual materialType getMaterialType();
 
+	// Infinite planes return true with their normal and a point on
+	// the plane so the acceleration structures can batch them 
+	// (see UnboundedSet). false for everything else
+	virtual bool getPlane(glm::vec3& normal, glm::vec3& point) const;
+
+	// Where an animation moves the object from/to (sphere & box 
+	// centers, rect corner, instance translation), the bbox follows. 
+	// false for objects that can't be moved (planes)
+	virtual bool getPosition(glm::vec3& pos);
+	virtual bool setPosition(glm::vec3 pos);
+
 };
 
 #endif
\ No newline at end of file
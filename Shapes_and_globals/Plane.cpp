@@ -5,12 +5,12 @@ Plane::Plane() {
 	this->color = Color(.5f, .5f, .5f, 0);
 	this->center = glm::vec3(.0f);
 	// build routine for bounding box min, max 
-	// Infinite Planes are a special case with x-z directions that stretch
-	// to infinity. We treat them separately by catching for any of the 
-	// X or Z components that are infinite in value, and ignore that object 
-	// during sizing of the Grid (scene bounding box)
-	bbox.minBounds = this->center + glm::vec3(-FLT_MAX, this->center.y, FLT_MAX);
-	bbox.maxBounds = this->center + glm::vec3(FLT_MAX, this->center.y, -FLT_MAX);
+	// Infinite Planes are a special case that stretch to infinity. 
+	// The box is infinite along every axis (planes needn't be 
+	// horizontal), the acceleration structures keep such objects 
+	// out of their bounded part (see UnboundedSet)
+	bbox.minBounds = glm::vec3(-FLT_MAX, -FLT_MAX, FLT_MAX);
+	bbox.maxBounds = glm::vec3(FLT_MAX, FLT_MAX, -FLT_MAX);
 }
 
 Plane::Plane(glm::vec3 normal, glm::vec3 planeCenter, Color pColor, materialType mat) {
@@ -20,12 +20,12 @@ Plane::Plane(glm::vec3 normal, glm::vec3 planeCenter, Color pColor, materialType
 	this->material = mat;
 
 	// build routine for bounding box min, max 
-	// Infinite Planes are a special case with x-z directions that stretch
-	// to infinity. We treat them separately by catching for any of the 
-	// X or Z components that are infinite in value, and ignore that object 
-	// during sizing of the Grid (scene bounding box)
-	bbox.minBounds = this->center + glm::vec3(-FLT_MAX, this->center.y, FLT_MAX);
-	bbox.maxBounds = this->center + glm::vec3(FLT_MAX, this->center.y, -FLT_MAX);
+	// Infinite Planes are a special case that stretch to infinity. 
+	// The box is infinite along every axis (planes needn't be 
+	// horizontal), the acceleration structures keep such objects 
+	// out of their bounded part (see UnboundedSet)
+	bbox.minBounds = glm::vec3(-FLT_MAX, -FLT_MAX, FLT_MAX);
+	bbox.maxBounds = glm::vec3(FLT_MAX, FLT_MAX, -FLT_MAX);
 }
 
 bool Plane::findIntersection(glm::vec3 orig, glm::vec3 dir, float& tNear, int& index, glm::vec2& uv) const {
@@ -75,4 +75,10 @@ void Plane::setColor(float r, float g, float b) {
 	this->color.setColorR(r);
 	this->color.setColorG(g);
 	this->color.setColorB(b);
+}
+
+bool Plane::getPlane(glm::vec3& planeNormal, glm::vec3& point) const {
+	planeNormal = normal;
+	point = center;
+	return true;
 }
\ No newline at end of file
@@ -33,6 +33,8 @@ public:
 		glm::vec2& st);
 
 	materialType getMaterialType();
+
+	bool getPlane(glm::vec3& planeNormal, glm::vec3& point) const;
 };
 
 #endif
\ No newline at end of file
@@ -8,10 +8,11 @@ Rect::Rect()
     color = Color(.5f, .5f, .5f, .0f);
     normal = normalize(cross(edge_1, edge_2));
     // build routine for bounding box min, max 
-    // rects have x and z directions that stretch
-    // are finite in value
-    bbox.minBounds = this->corner + glm::vec3(edge_1.x, this->corner.y, this->corner.z);
-    bbox.maxBounds = this->corner + glm::vec3(this->corner.x, this->corner.y, edge_2.z);
+    // the box around the 4 corners of the rectangle
+    bbox.extendBy(corner);
+    bbox.extendBy(corner + edge_1);
+    bbox.extendBy(corner + edge_2);
+    bbox.extendBy(corner + edge_1 + edge_2);
 }
 
 Rect::Rect(glm::vec3 c, glm::vec3 e_a, glm::vec3 e_b, Color col, materialType mat)
@@ -24,10 +25,11 @@ Rect::Rect(glm::vec3 c, glm::vec3 e_a, glm::vec3 e_b, Color col, materialType ma
     material = mat;
 
     // build routine for bounding box min, max 
-    // rects have x and z directions that stretch
-    // are finite in value
-    bbox.minBounds = this->corner + glm::vec3(edge_1.x, this->corner.y, this->corner.z);
-    bbox.maxBounds = this->corner + glm::vec3(this->corner.x, this->corner.y, edge_2.z);
+    // the box around the 4 corners of the rectangle
+    bbox.extendBy(corner);
+    bbox.extendBy(corner + edge_1);
+    bbox.extendBy(corner + edge_2);
+    bbox.extendBy(corner + edge_1 + edge_2);
 }
 
 bool Rect::findIntersection(glm::vec3 orig,  glm::vec3 dir, float& tNear, int& index, glm::vec2& uv) const
@@ -38,13 +40,9 @@ bool Rect::findIntersection(glm::vec3 orig,  glm::vec3 dir, float& tNear, int& i
     if (fabsf(denom) < 0.0001f) {
         return false;
     }
-    // means ray intersects the back face of the plane
-    // so flip the normal
-    if (dot(dir, N) > 0.0f) {
-        N = -N;
-    }
-    // this->center is the "center" of the plane, 
-    // i.e. an Abitrary pt A on the plane
+    // the back face needs no flip here: flipping N would negate the
+    // numerator but not denom and turn rects behind the ray into hits
+    // this->corner is an Abitrary pt A on the plane
     float numer = dot(this->corner - orig, N);
     tNear = numer / denom;
     if (tNear < 0.0001f) {
@@ -94,3 +92,20 @@ materialType Rect::getMaterialType()
 {
     return material;
 }
+
+bool Rect::getPosition(glm::vec3& pos)
+{
+    pos = corner;
+    return true;
+}
+
+bool Rect::setPosition(glm::vec3 pos)
+{
+    corner = pos;
+    bbox = Bbox();
+    bbox.extendBy(corner);
+    bbox.extendBy(corner + edge_1);
+    bbox.extendBy(corner + edge_2);
+    bbox.extendBy(corner + edge_1 + edge_2);
+    return true;
+}
@@ -32,6 +32,10 @@ public:
 
 	materialType getMaterialType();
 
+	// the corner moves, the edges stay
+	bool getPosition(glm::vec3& pos);
+	bool setPosition(glm::vec3 pos);
+
 };
 
 #endif
\ No newline at end of file
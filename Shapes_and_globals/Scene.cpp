@@ -212,4 +212,23 @@ Light scene4_areaLight(scene4_corner, whiteLight, AREA_LIGHT, scene4_corner,
 Light scene4_theLight(
 	glm::vec3(-7.0f, 5.0f, 3.0f),
 	whiteLight, POINT_LIGHT,
-	glm::vec3(.0f), glm::vec3(.0f), glm::vec3(.0f));
\ No newline at end of file
+	glm::vec3(.0f), glm::vec3(.0f), glm::vec3(.0f));
+
+// SCENE 5 -------------------------------------------------------
+// spiral of instanced spheres sharing one unit sphere
+Sphere scene5_unitSphere(glm::vec3(.0f), 1.0f, white, 1.0f, DIFFUSE);
+std::vector<Object*> scene5_prototypeObjects = { &scene5_unitSphere };
+BVH scene5_prototype(scene5_prototypeObjects);
+std::vector<Instance> scene5_instances;
+
+// Bottom
+Plane scene5_plane1(glm::vec3(.0f, 1.0f, .0f),
+	glm::vec3(1.0f, -1.0f, .0f), floor_white, DIFFUSE);
+
+glm::vec3 scene5_edge_a(-.5f, .0f, .0f);
+glm::vec3 scene5_edge_b(0.f, .0f, -.5f);
+glm::vec3 scene5_corner(.1f, 1.9f, -2.0f);
+
+// area light
+Light scene5_areaLight(scene5_corner, whiteLight, AREA_LIGHT, scene5_corner,
+	scene5_edge_a, scene5_edge_b);
\ No newline at end of file
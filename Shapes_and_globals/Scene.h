@@ -9,6 +9,8 @@
 #include "Plane.h"
 #include "Rect.h"
 #include "Box.h"
+#include "Instance.h"
+#include "../Grid_Acceleration_Structure/BVH.h"
 #include "../Lights_Color/Light.h"
 #include <vector>
 
@@ -171,4 +173,21 @@ extern Light scene4_theLight;
 // area light
 extern Light scene4_areaLight;
 
+// SCENE 5 -------------------------------------------------------
+// spiral of spheres which are all instances of one unit sphere: 
+// the geometry is stored once (in scene5_prototype), each instance 
+// only holds its transform, color & material
+#define SCENE5_NUM_INSTANCES 48
+extern Sphere scene5_unitSphere;
+extern std::vector<Object*> scene5_prototypeObjects;
+extern BVH scene5_prototype;
+// filled in by selectScene()
+extern std::vector<Instance> scene5_instances;
+
+// Bottom
+extern  Plane scene5_plane1;
+
+// area light
+extern Light scene5_areaLight;
+
 #endif
\ No newline at end of file
@@ -121,3 +121,14 @@ materialType Sphere::getMaterialType() {
 	return material;
 }
 
+bool Sphere::getPosition(glm::vec3& pos) {
+	pos = sphereOrig;
+	return true;
+}
+
+bool Sphere::setPosition(glm::vec3 pos) {
+	sphereOrig = pos;
+	bbox.minBounds = pos + glm::vec3(-radius, -radius, radius);
+	bbox.maxBounds = pos + glm::vec3(radius, radius, -radius);
+	return true;
+}
\ No newline at end of file
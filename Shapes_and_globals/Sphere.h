@@ -42,6 +42,9 @@ public:
 
 
 	materialType getMaterialType();
+
+	bool getPosition(glm::vec3& pos);
+	bool setPosition(glm::vec3 pos);
 };
 
 #endif
\ No newline at end of file
@@ -1,8 +1,13 @@
-#include "time.h"
+#include <chrono>
+#include <fstream>
 
+// leak checking uses the msvc debug heap, other compilers skip it
+#ifdef _MSC_VER
 #define _CRTDBG_MAP_ALLOC //to get more details
 #include <stdlib.h>  
 #include <crtdbg.h>   //for malloc and free
+#include <windows.h>
+#endif
 #include "Render/Render.h"
 #include "Shapes_and_globals/Scene.h"
 
@@ -10,19 +15,26 @@
 //	float gamma, Color* pixelData, int width, int height);
 
 int main(int argc, char* argv[]) {
+#ifdef _MSC_VER
 	// checking for memory leaks
 	_CrtMemState sOld;
 	_CrtMemState sNew;
 	_CrtMemState sDiff;
 	_CrtMemCheckpoint(&sOld); //take a snapshot
+#endif
 
 	std::cout << "Rendering... " << std::endl;
 	// Rendering image options (fov, width, height etc.)
 	Options options; 
+	if (!options.traceFile.empty()) {
+		Trace::enable();
+		Trace::setThreadName("main");
+	}
 
-	// Record rendering time elapsed
-	clock_t t1, t2; 
-	t1 = clock();
+	// Record rendering time elapsed -- wall clock, clock() only 
+	// counts CPU time on linux (summed over all render threads)
+	std::chrono::steady_clock::time_point t1, t2;
+	t1 = std::chrono::steady_clock::now();
 
 	// initializing all pixels in frame buffer to default value 
 	Color* colorBuffer = new Color[options.width*options.height];
@@ -37,12 +49,6 @@ int main(int argc, char* argv[]) {
 		options.cameraForward, 
 		options.cameraReferUp);
 
-	// generate 2 size n^2 arrays holding randomized values in range [0, 1)
-	// r -- cam ray x-y jitter values
-	// s -- shadow ray x-y jitter values
-	glm::vec2* r = new glm::vec2[options.sampleNum * options.sampleNum];
-	glm::vec2* s = new glm::vec2[options.sampleNum * options.sampleNum];
-
 	// Populate scene objects & Lights ------------------------------------------
 	Render renderer;
 	
@@ -53,28 +59,83 @@ int main(int argc, char* argv[]) {
 	renderer.selectScene(sceneObjects, lights, options.selectScene);
 	// BEGIN RENDERING ---------------------------------------------------------
 
-	renderer.startRender(lights, 
-		sceneObjects, colorBuffer, cam, options, r, s);
-	
 	std::string outFileName = "rendered_images/testFile.jpg";
-	renderer.writeImage(outFileName, 
-		1.0f, 2.2f, colorBuffer, options.width, options.height);
+	if (options.turntableViews > 1) {
+		// one scene & structure for every view, each written as it's done
+		renderer.buildAccelStructure(sceneObjects, options.accelStructure);
+		std::vector<Camera> cameras = Camera::turntable(options.cameraPos,
+			options.cameraForward, options.cameraReferUp, 
+			options.turntableCenter, options.turntableViews);
+		std::vector<std::vector<Color> > viewBuffers(cameras.size(),
+			std::vector<Color>(options.width * options.height, 
+				options.backgroundColor));
+		std::vector<RenderView> views(cameras.size());
+		for (int i = 0; i < cameras.size(); ++i) {
+			views[i].cam = cameras[i];
+			views[i].colorBuffer = viewBuffers[i].data();
+			views[i].outFileName = "rendered_images/testFile_view" + 
+				std::to_string(i) + ".jpg";
+		}
+		renderer.renderViews(lights, sceneObjects, views, options);
+	}
+	else if (options.animationFrames > 0) {
+		// testFile_0000.jpg, testFile_0001.jpg ...
+		Animation animation;
+		if (options.animationFile.empty()) {
+			animation = Animation::builtIn(options.selectScene, 
+				sceneObjects, lights);
+		}
+		else {
+			std::ifstream description(options.animationFile);
+			std::string error = "can't open it";
+			if (!description || 
+				!animation.parse(description, sceneObjects, lights, error)) {
+				std::cout << options.animationFile << ": " << error << std::endl;
+				delete[] colorBuffer;
+				return 1;
+			}
+		}
+		renderer.renderAnimation(lights, sceneObjects, animation, cam, 
+			options, outFileName);
+	}
+	else {
+		renderer.startRender(lights, 
+			sceneObjects, colorBuffer, cam, options);
+		
+		renderer.writeImage(outFileName, 
+			1.0f, 2.2f, colorBuffer, options.width, options.height);
+		// testFile_depth.pfm etc.
+		if (options.aovs != AOV_NONE) {
+			renderer.writeAOVs(outFileName);
+		}
+	}
+	// the frame is safe on disk, a rerun shouldn't resume it
+	if (!options.checkpointFile.empty()) {
+		remove(options.checkpointFile.c_str());
+	}
+	// set options.heatmap to see where the frame time went
+	if (options.heatmap != HEATMAP_OFF) {
+		renderer.writeHeatmap("rendered_images/testFile_heatmap.jpg");
+	}
 
 	// Stop recording time ------------------------------------------------------
-	t2 = clock();
+	t2 = std::chrono::steady_clock::now();
 	std::cout << "Render time: " << 
-		(float)(t2 - t1) / 1000.0f << " seconds" << std::endl;
+		std::chrono::duration<float>(t2 - t1).count() << " seconds" << std::endl;
+	std::cout << "Stats: " << renderer.stats.toJSON() << std::endl;
+	if (!options.traceFile.empty() && !Trace::write(options.traceFile)) {
+		std::cout << "Couldn't write " << options.traceFile << std::endl;
+	}
 
 	// Free memory --------------------------------------------------------------
 	delete[] colorBuffer;
-	delete[] r; 
-	delete[] s;
 
 	while (!sceneObjects.empty()) {
 		sceneObjects.pop_back();
 	}
 	sceneObjects.clear();
 
+#ifdef _MSC_VER
 	// Memory Leak Summary
 	_CrtMemCheckpoint(&sNew); //take a snapchot 
 	if (_CrtMemDifference(&sDiff, &sOld, &sNew)) // if there is a difference
@@ -86,6 +147,7 @@ int main(int argc, char* argv[]) {
 		OutputDebugString(L"-----------_CrtDumpMemoryLeaks ---------");
 		_CrtDumpMemoryLeaks();
 	}
+#endif
 
 	return 0;
 }
\ No newline at end of file
@@ -0,0 +1,48 @@
+#!/bin/sh
+# Builds the renderer three ways -- plain release, release + LTO, and 
+# release + LTO + PGO trained on the built-in scenes -- then runs the 
+# render benchmark on each and prints the gains over the plain build 
+# as JSON lines (Benchmarks compare).
+#
+# usage: scripts/build_variants.sh [build root] [extra cmake args...]
+# e.g.   scripts/build_variants.sh build -DRAYTRACER_ARCH=x86-64-v3
+set -e
+
+src=$(cd "$(dirname "$0")/.." && pwd)
+root=${1:-build}
+[ $# -gt 0 ] && shift
+jobs=$(nproc 2>/dev/null || echo 4)
+# small frames, every backend, one thread so the numbers are stable
+bench="render --builtin --threads 1 --samples 3"
+
+configure() {
+	dir=$1
+	shift
+	cmake -S "$src" -B "$root/$dir" -DCMAKE_BUILD_TYPE=Release "$@" >/dev/null
+}
+
+run_bench() {
+	# best of 3 runs is kept by compare
+	for i in 1 2 3; do
+		"$root/$1/Benchmarks" $bench
+	done > "$root/$1.jsonl"
+}
+
+configure release -DRAYTRACER_LTO=OFF -DRAYTRACER_PGO=OFF "$@"
+cmake --build "$root/release" -j"$jobs" --target Benchmarks
+run_bench release
+
+configure lto -DRAYTRACER_LTO=ON -DRAYTRACER_PGO=OFF "$@"
+cmake --build "$root/lto" -j"$jobs" --target Benchmarks
+run_bench lto
+
+# instrument, train, then rebuild the same dir with the profiles
+rm -rf "$root/pgo/pgo"
+configure pgo -DRAYTRACER_LTO=ON -DRAYTRACER_PGO=GENERATE "$@"
+cmake --build "$root/pgo" -j"$jobs" --target pgo-train
+configure pgo -DRAYTRACER_LTO=ON -DRAYTRACER_PGO=USE "$@"
+cmake --build "$root/pgo" -j"$jobs" --target Benchmarks
+run_bench pgo
+
+"$root/release/Benchmarks" compare "$root/release.jsonl" "$root/lto.jsonl" --label lto
+"$root/release/Benchmarks" compare "$root/release.jsonl" "$root/pgo.jsonl" --label lto+pgo
\ No newline at end of file
@@ -0,0 +1,50 @@
+#!/bin/sh
+# Renders a frame with Render_Coordinator over several local 
+# Render_Server processes and checks it's identical to a single 
+# process render (--verify). One listed worker doesn't exist and one 
+# is killed partway through, so giving chunks back and reassigning 
+# them gets exercised too.
+#
+# usage: scripts/distributed_render_test.sh <build dir> [workers] 
+#   [render key=value...]
+set -e
+
+build=${1:?usage: $0 <build dir> [workers] [key=value...]}
+workers=${2:-3}
+[ $# -gt 0 ] && shift
+[ $# -gt 0 ] && shift
+args=${*:-width=320 height=240 samples=4 threads=2}
+
+dir=$(mktemp -d)
+pids=""
+cleanup() {
+	for pid in $pids; do
+		kill "$pid" 2>/dev/null || true
+	done
+	wait 2>/dev/null || true
+	rm -rf "$dir"
+}
+trap cleanup EXIT
+
+list="$dir/missing.sock"
+for i in $(seq 1 "$workers"); do
+	"$build/Render_Server" --socket "$dir/worker$i.sock" \
+		> "$dir/worker$i.log" 2>&1 &
+	pids="$pids $!"
+	list="$list,$dir/worker$i.sock"
+done
+for i in $(seq 1 "$workers"); do
+	tries=0
+	while [ ! -S "$dir/worker$i.sock" ]; do
+		tries=$((tries + 1))
+		[ $tries -gt 100 ] && { echo "worker $i didn't start"; exit 1; }
+		sleep 0.05
+	done
+done
+
+# the last worker goes away mid frame (when there's more than one)
+if [ "$workers" -gt 1 ]; then
+	(sleep 0.2; kill $(echo $pids | awk '{print $NF}') 2>/dev/null) &
+fi
+
+"$build/Render_Coordinator" --workers "$list" --chunk 4 --verify $args
\ No newline at end of file